@@ -0,0 +1,274 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT bosch_bme280
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "sensor_replay.h"
+
+#define BME280_REG_CALIB_T1   0x88
+#define BME280_REG_CALIB_H1   0xA1
+#define BME280_REG_ID	      0xD0
+#define BME280_REG_RESET      0xE0
+#define BME280_REG_CALIB_H2   0xE1
+#define BME280_REG_PRESS_MSB  0xF7
+#define BME280_REG_COUNT      0x100
+#define BME280_CHIP_ID	      0x60
+#define BME280_CMD_SOFT_RESET 0xB6
+
+#define BME280_ADC_MAX	   0xFFFFF
+#define BME280_ADC_HUM_MAX 0xFFFF
+
+/* Temperature (°C), pressure (kPa) and humidity (%RH) */
+#define BME280_EMUL_NUM_VALUES 3
+
+/* Trimming parameters of a typical part */
+struct bme280_emul_calib {
+	uint16_t t1;
+	int16_t t2, t3;
+	uint16_t p1;
+	int16_t p2, p3, p4, p5, p6, p7, p8, p9;
+	uint8_t h1, h3;
+	int16_t h2, h4, h5;
+	int8_t h6;
+};
+
+static const struct bme280_emul_calib calib = {
+	.t1 = 27504, .t2 = 26435, .t3 = -1000,
+	.p1 = 36477, .p2 = -10685, .p3 = 3024, .p4 = 2855, .p5 = 140,
+	.p6 = -7, .p7 = 15500, .p8 = -14600, .p9 = 6000,
+	.h1 = 75, .h2 = 362, .h3 = 0, .h4 = 324, .h5 = 0, .h6 = 30,
+};
+
+struct bme280_emul_data {
+	struct sensor_replay_cursor cursor;
+	uint8_t regs[BME280_REG_COUNT];
+	uint8_t reg;
+};
+
+/* Compensation from the datasheet, as done by the driver. Temperature is in 0.01 °C. */
+static int64_t bme280_emul_temp(int32_t adc, int32_t *t_fine)
+{
+	int32_t var1 = (((adc >> 3) - ((int32_t)calib.t1 << 1)) * calib.t2) >> 11;
+	int32_t var2 = (((((adc >> 4) - calib.t1) * ((adc >> 4) - calib.t1)) >> 12) * calib.t3) >>
+		       14;
+
+	*t_fine = var1 + var2;
+
+	return (*t_fine * 5 + 128) >> 8;
+}
+
+/* Pressure in Pa, Q24.8 */
+static int64_t bme280_emul_press(int32_t adc, int32_t t_fine)
+{
+	int64_t var1 = (int64_t)t_fine - 128000;
+	int64_t var2 = var1 * var1 * calib.p6;
+	int64_t p;
+
+	var2 = var2 + ((var1 * calib.p5) << 17);
+	var2 = var2 + ((int64_t)calib.p4 << 35);
+	var1 = ((var1 * var1 * calib.p3) >> 8) + ((var1 * calib.p2) << 12);
+	var1 = ((((int64_t)1) << 47) + var1) * calib.p1 >> 33;
+	if (var1 == 0) {
+		return 0;
+	}
+
+	p = 1048576 - adc;
+	p = (((p << 31) - var2) * 3125) / var1;
+	var1 = ((int64_t)calib.p9 * (p >> 13) * (p >> 13)) >> 25;
+	var2 = ((int64_t)calib.p8 * p) >> 19;
+
+	return ((p + var1 + var2) >> 8) + ((int64_t)calib.p7 << 4);
+}
+
+/* Humidity in %RH, Q22.10 */
+static int64_t bme280_emul_hum(int32_t adc, int32_t t_fine)
+{
+	int32_t h = t_fine - 76800;
+
+	h = ((((adc << 14) - ((int32_t)calib.h4 << 20) - (calib.h5 * h)) + 16384) >> 15) *
+	    (((((((h * calib.h6) >> 10) * (((h * calib.h3) >> 11) + 32768)) >> 10) + 2097152) *
+		      calib.h2 +
+	      8192) >>
+	     14);
+	h = h - (((((h >> 15) * (h >> 15)) >> 7) * calib.h1) >> 4);
+	h = CLAMP(h, 0, 419430400);
+
+	return h >> 12;
+}
+
+/* Find the raw reading that the compensation `fn` brings closest to `target` */
+static int32_t bme280_emul_raw(int64_t (*fn)(int32_t adc, int32_t t_fine), int32_t t_fine,
+			       int64_t target, int32_t max)
+{
+	bool rising = fn(max, t_fine) > fn(0, t_fine);
+	int32_t lo = 0;
+	int32_t hi = max;
+
+	while (lo < hi) {
+		int32_t mid = lo + (hi - lo) / 2;
+
+		if ((fn(mid, t_fine) < target) == rising) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+static int64_t bme280_emul_temp_fn(int32_t adc, int32_t t_fine)
+{
+	return bme280_emul_temp(adc, &t_fine);
+}
+
+/* Load the next sample into the data registers */
+static int bme280_emul_sample(struct bme280_emul_data *data)
+{
+	int64_t values[BME280_EMUL_NUM_VALUES];
+	uint8_t *out = &data->regs[BME280_REG_PRESS_MSB];
+	int32_t adc_t, adc_p, adc_h;
+	int32_t t_fine;
+	int err;
+
+	err = sensor_replay_get(&data->cursor, values, ARRAY_SIZE(values));
+	if (err) {
+		return -EIO;
+	}
+
+	adc_t = bme280_emul_raw(bme280_emul_temp_fn, 0, values[0] / 10000, BME280_ADC_MAX);
+	bme280_emul_temp(adc_t, &t_fine);
+	adc_p = bme280_emul_raw(bme280_emul_press, t_fine, values[1] * 256 / 1000,
+				BME280_ADC_MAX);
+	adc_h = bme280_emul_raw(bme280_emul_hum, t_fine, values[2] * 1024 / 1000000,
+				BME280_ADC_HUM_MAX);
+
+	/* 20-bit pressure and temperature, 16-bit humidity, most significant byte first */
+	out[0] = adc_p >> 12;
+	out[1] = adc_p >> 4;
+	out[2] = (adc_p & 0x0F) << 4;
+	out[3] = adc_t >> 12;
+	out[4] = adc_t >> 4;
+	out[5] = (adc_t & 0x0F) << 4;
+	sys_put_be16(adc_h, &out[6]);
+
+	return 0;
+}
+
+static void bme280_emul_reset(struct bme280_emul_data *data)
+{
+	/* Temperature and pressure parameters are consecutive little-endian words */
+	const uint16_t tp[] = {calib.t1, calib.t2, calib.t3, calib.p1, calib.p2, calib.p3,
+			       calib.p4, calib.p5, calib.p6, calib.p7, calib.p8, calib.p9};
+	uint8_t *regs = data->regs;
+
+	memset(regs, 0, sizeof(data->regs));
+
+	regs[BME280_REG_ID] = BME280_CHIP_ID;
+
+	for (size_t i = 0; i < ARRAY_SIZE(tp); i++) {
+		sys_put_le16(tp[i], &regs[BME280_REG_CALIB_T1 + 2 * i]);
+	}
+
+	regs[BME280_REG_CALIB_H1] = calib.h1;
+	sys_put_le16(calib.h2, &regs[BME280_REG_CALIB_H2]);
+	regs[0xE3] = calib.h3;
+	/* H4 and H5 are 12-bit values sharing the nibbles of 0xE5 */
+	regs[0xE4] = calib.h4 >> 4;
+	regs[0xE5] = (calib.h4 & 0x0F) | ((calib.h5 & 0x0F) << 4);
+	regs[0xE6] = calib.h5 >> 4;
+	regs[0xE7] = calib.h6;
+}
+
+static int bme280_emul_write(struct bme280_emul_data *data, const uint8_t *buf, size_t len)
+{
+	if (len == 0) {
+		return -EIO;
+	}
+
+	data->reg = buf[0];
+
+	for (size_t i = 1; i < len; i++) {
+		if ((data->reg == BME280_REG_RESET) && (buf[i] == BME280_CMD_SOFT_RESET)) {
+			bme280_emul_reset(data);
+		} else {
+			data->regs[data->reg] = buf[i];
+		}
+
+		data->reg++;
+	}
+
+	return 0;
+}
+
+static int bme280_emul_read(struct bme280_emul_data *data, uint8_t *buf, size_t len)
+{
+	int err;
+
+	if (data->reg + len > BME280_REG_COUNT) {
+		return -EIO;
+	}
+
+	/* Conversions complete instantly, so every read of the data registers is fresh */
+	if ((data->reg <= BME280_REG_PRESS_MSB) && (data->reg + len > BME280_REG_PRESS_MSB)) {
+		err = bme280_emul_sample(data);
+		if (err) {
+			return err;
+		}
+	}
+
+	memcpy(buf, &data->regs[data->reg], len);
+	data->reg += len;
+
+	return 0;
+}
+
+static int bme280_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+				int addr)
+{
+	struct bme280_emul_data *data = target->data;
+	int err = 0;
+
+	for (int i = 0; (i < num_msgs) && !err; i++) {
+		if (msgs[i].flags & I2C_MSG_READ) {
+			err = bme280_emul_read(data, msgs[i].buf, msgs[i].len);
+		} else {
+			err = bme280_emul_write(data, msgs[i].buf, msgs[i].len);
+		}
+	}
+
+	return err;
+}
+
+static const struct i2c_emul_api bme280_emul_api = {
+	.transfer = bme280_emul_transfer,
+};
+
+static int bme280_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct bme280_emul_data *data = target->data;
+
+	data->cursor.sensor = "BME280";
+	bme280_emul_reset(data);
+
+	return 0;
+}
+
+#define BME280_EMUL_DEFINE(inst)                                                                   \
+	static struct bme280_emul_data bme280_emul_data_##inst;                                    \
+                                                                                                   \
+	EMUL_DT_INST_DEFINE(inst, bme280_emul_init, &bme280_emul_data_##inst, NULL,                \
+			    &bme280_emul_api, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(BME280_EMUL_DEFINE)
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT sensirion_scd4x
+
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
+
+#include "sensirion_emul.h"
+#include "sensor_replay.h"
+
+#define SCD4X_CMD_WAKE_UP		0x36F6
+#define SCD4X_CMD_GET_SERIAL_NUMBER	0x3682
+#define SCD4X_CMD_MEASURE_SINGLE_SHOT	0x219D
+#define SCD4X_CMD_GET_DATA_READY_STATUS 0xE4B8
+#define SCD4X_CMD_READ_MEASUREMENT	0xEC05
+
+#define SCD4X_EMUL_MEASURE_MS	  5000
+#define SCD4X_EMUL_DATA_READY	  0x8006
+#define SCD4X_EMUL_DATA_NOT_READY 0x8000
+
+/* CO2 (ppm), temperature (°C) and humidity (%RH) */
+#define SCD4X_EMUL_NUM_VALUES 3
+
+struct scd4x_emul_data {
+	struct sensor_replay_cursor cursor;
+	uint16_t cmd;
+	/* Uptime at which the single-shot measurement started, or -1 */
+	int64_t measure_start_ms;
+};
+
+static uint16_t scd4x_emul_raw(int64_t micro, int64_t offset, int64_t span)
+{
+	int64_t raw = ((micro + offset) * 65536) / span;
+
+	return CLAMP(raw, 0, UINT16_MAX);
+}
+
+static int scd4x_emul_measurement(struct scd4x_emul_data *data, uint16_t *words)
+{
+	int64_t values[SCD4X_EMUL_NUM_VALUES];
+	int err;
+
+	err = sensor_replay_get(&data->cursor, values, ARRAY_SIZE(values));
+	if (err) {
+		return -EIO;
+	}
+
+	/* Inverse of the conversions in the driver; 0 ppm would mark the sample invalid */
+	words[0] = CLAMP((values[0] + 500000) / 1000000, 1, UINT16_MAX);
+	words[1] = scd4x_emul_raw(values[1], 45000000, 175000000);
+	words[2] = scd4x_emul_raw(values[2], 0, 100000000);
+
+	return 0;
+}
+
+static int scd4x_emul_write(struct scd4x_emul_data *data, const uint8_t *buf, size_t len)
+{
+	uint16_t args[1];
+	int ret;
+
+	ret = sensirion_emul_cmd_parse(buf, len, &data->cmd, args, ARRAY_SIZE(args));
+	if (ret < 0) {
+		return ret;
+	}
+
+	switch (data->cmd) {
+	case SCD4X_CMD_WAKE_UP:
+		/* Like the sensor, do not acknowledge the wake-up */
+		return -EIO;
+	case SCD4X_CMD_MEASURE_SINGLE_SHOT:
+		data->measure_start_ms = k_uptime_get();
+		return 0;
+	default:
+		/* Configuration commands have no effect on the replayed values */
+		return 0;
+	}
+}
+
+static int scd4x_emul_read(struct scd4x_emul_data *data, uint8_t *buf, size_t len)
+{
+	static const uint16_t serial[] = {0x5245, 0x504C, 0x4159};
+	uint16_t words[SCD4X_EMUL_NUM_VALUES];
+	bool ready;
+	int err;
+
+	switch (data->cmd) {
+	case SCD4X_CMD_GET_SERIAL_NUMBER:
+		return sensirion_emul_words_put(buf, len, serial, ARRAY_SIZE(serial));
+	case SCD4X_CMD_GET_DATA_READY_STATUS:
+		ready = !sensor_replay_fault_stuck_ready(&data->cursor) &&
+			(data->measure_start_ms >= 0) &&
+			(k_uptime_get() - data->measure_start_ms >= SCD4X_EMUL_MEASURE_MS);
+		words[0] = ready ? SCD4X_EMUL_DATA_READY : SCD4X_EMUL_DATA_NOT_READY;
+		return sensirion_emul_words_put(buf, len, words, 1);
+	case SCD4X_CMD_READ_MEASUREMENT:
+		err = scd4x_emul_measurement(data, words);
+		if (err) {
+			return err;
+		}
+
+		data->measure_start_ms = -1;
+		return sensirion_emul_words_put(buf, len, words, ARRAY_SIZE(words));
+	default:
+		return -EIO;
+	}
+}
+
+static int scd4x_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+			       int addr)
+{
+	struct scd4x_emul_data *data = target->data;
+	int err = 0;
+
+	for (int i = 0; (i < num_msgs) && !err; i++) {
+		err = sensor_replay_fault_transfer(&data->cursor);
+		if (err) {
+			break;
+		}
+
+		if (msgs[i].flags & I2C_MSG_READ) {
+			err = scd4x_emul_read(data, msgs[i].buf, msgs[i].len);
+			if (!err) {
+				sensirion_emul_read_faults(&data->cursor, msgs[i].buf,
+							   data->cmd == SCD4X_CMD_READ_MEASUREMENT);
+			}
+		} else {
+			err = scd4x_emul_write(data, msgs[i].buf, msgs[i].len);
+		}
+	}
+
+	return err;
+}
+
+static const struct i2c_emul_api scd4x_emul_api = {
+	.transfer = scd4x_emul_transfer,
+};
+
+static int scd4x_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct scd4x_emul_data *data = target->data;
+
+	data->cursor.sensor = "SCD4x";
+	data->measure_start_ms = -1;
+
+	return 0;
+}
+
+#define SCD4X_EMUL_DEFINE(inst)                                                                    \
+	static struct scd4x_emul_data scd4x_emul_data_##inst;                                      \
+                                                                                                   \
+	EMUL_DT_INST_DEFINE(inst, scd4x_emul_init, &scd4x_emul_data_##inst, NULL,                  \
+			    &scd4x_emul_api, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(SCD4X_EMUL_DEFINE)
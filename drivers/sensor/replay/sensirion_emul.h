@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Target side of the Sensirion I2C framing (see sensirion_common.h), shared by
+ * the SCD4x and SPS30 emulators.
+ */
+
+#ifndef __SENSIRION_EMUL_H__
+#define __SENSIRION_EMUL_H__
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+#include "sensor_replay.h"
+
+#define SENSIRION_EMUL_WORD_LEN 3
+
+static inline uint8_t sensirion_emul_crc(const uint8_t *word)
+{
+	return crc8(word, sizeof(uint16_t), 0x31, 0xFF, false);
+}
+
+/**
+ * Split a write into its command and argument words.
+ *
+ * @return Number of arguments, or -EIO if the framing or a CRC is wrong
+ */
+static inline int sensirion_emul_cmd_parse(const uint8_t *buf, size_t len, uint16_t *cmd,
+					   uint16_t *args, size_t max_args)
+{
+	size_t num_args;
+
+	if ((len < sizeof(uint16_t)) || ((len - sizeof(uint16_t)) % SENSIRION_EMUL_WORD_LEN)) {
+		return -EIO;
+	}
+
+	num_args = (len - sizeof(uint16_t)) / SENSIRION_EMUL_WORD_LEN;
+	if (num_args > max_args) {
+		return -EIO;
+	}
+
+	*cmd = sys_get_be16(buf);
+
+	for (size_t i = 0; i < num_args; i++) {
+		const uint8_t *word = &buf[sizeof(uint16_t) + i * SENSIRION_EMUL_WORD_LEN];
+
+		if (sensirion_emul_crc(word) != word[2]) {
+			return -EIO;
+		}
+
+		args[i] = sys_get_be16(word);
+	}
+
+	return num_args;
+}
+
+/* Fill a read with response words, or fail it like a NACK if the lengths differ */
+static inline int sensirion_emul_words_put(uint8_t *buf, size_t len, const uint16_t *words,
+					   size_t num_words)
+{
+	if (len != num_words * SENSIRION_EMUL_WORD_LEN) {
+		return -EIO;
+	}
+
+	for (size_t i = 0; i < num_words; i++) {
+		uint8_t *word = &buf[i * SENSIRION_EMUL_WORD_LEN];
+
+		sys_put_be16(words[i], word);
+		word[2] = sensirion_emul_crc(word);
+	}
+
+	return 0;
+}
+
+/* Break the CRC of a response as set by the crc_pct fault, or record a good reading */
+static inline void sensirion_emul_read_faults(struct sensor_replay_cursor *cursor, uint8_t *buf,
+					      bool reading)
+{
+	if (sensor_replay_fault_crc(cursor)) {
+		buf[2] ^= 0xFF;
+	} else if (reading) {
+		sensor_replay_fault_reading(cursor);
+	}
+}
+
+#endif /* __SENSIRION_EMUL_H__ */
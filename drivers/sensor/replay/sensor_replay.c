@@ -0,0 +1,413 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(sensor_replay, CONFIG_SENSOR_LOG_LEVEL);
+
+#include <ctype.h>
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+#include <zephyr/kernel.h>
+
+#include "sensor_replay.h"
+
+/* Seed of the NACKs and CRC errors, so that runs repeat */
+#define FAULT_RNG_SEED 0x2545F491
+
+/* Embedded from CONFIG_SENSOR_REPLAY_TRACE at build time */
+static const char trace[] = {
+#include "sensor_replay_trace.inc"
+};
+
+struct replay_line {
+	int64_t t_ms;
+	const char *sensor;
+	size_t sensor_len;
+	int64_t values[SENSOR_REPLAY_MAX_VALUES];
+	/* A fault line instead of a sample */
+	bool fault;
+	struct sensor_replay_faults faults;
+};
+
+K_MUTEX_DEFINE(replay_mutex);
+
+/* Uptime at which the first sample of the trace was played, or -1 before that */
+static int64_t origin_ms = -1;
+static int64_t trace_start_ms;
+
+/* Parse a decimal number into micro-units, returning the end of the number or NULL */
+static const char *parse_micro(const char *p, const char *end, int64_t *micro)
+{
+	bool negative = false;
+	bool digits = false;
+	int64_t scale = 1000000;
+	int64_t value = 0;
+
+	if ((p < end) && ((*p == '-') || (*p == '+'))) {
+		negative = (*p == '-');
+		p++;
+	}
+
+	while ((p < end) && isdigit((unsigned char)*p)) {
+		value = value * 10 + 1000000 * (*p - '0');
+		digits = true;
+		p++;
+	}
+
+	if ((p < end) && (*p == '.')) {
+		p++;
+
+		/* Digits beyond a micro-unit are dropped */
+		while ((p < end) && isdigit((unsigned char)*p)) {
+			scale /= 10;
+			value += scale * (*p - '0');
+			digits = true;
+			p++;
+		}
+	}
+
+	if (!digits) {
+		return NULL;
+	}
+
+	*micro = negative ? -value : value;
+
+	return p;
+}
+
+static bool is_comment(const char *p, const char *end)
+{
+	return (p == end) || (*p == '#') || (*p == '\r');
+}
+
+static bool field_is(const char *p, const char *end, const char *name)
+{
+	size_t len = strlen(name);
+
+	return ((size_t)(end - p) >= len) && (strncasecmp(p, name, len) == 0) &&
+	       ((p + len == end) || (p[len] == ',') || (p[len] == '=') || (p[len] == '\r'));
+}
+
+/* Parse the `,<name>=<value>` settings of a fault line */
+static bool parse_faults(const char *p, const char *end, struct sensor_replay_faults *faults)
+{
+	while ((p < end) && (*p == ',')) {
+		const char *name = p + 1;
+		const char *eq = memchr(name, '=', end - name);
+		int64_t value;
+
+		if (!eq) {
+			return false;
+		}
+
+		p = parse_micro(eq + 1, end, &value);
+		if (!p || (value < 0)) {
+			return false;
+		}
+
+		value /= 1000000;
+
+		if (field_is(name, eq, "nack_pct")) {
+			faults->nack_pct = MIN(value, 100);
+		} else if (field_is(name, eq, "crc_pct")) {
+			faults->crc_pct = MIN(value, 100);
+		} else if (field_is(name, eq, "stuck_ready")) {
+			faults->stuck_ready = (value != 0);
+		} else if (field_is(name, eq, "lockup")) {
+			faults->lockup = (value != 0);
+		} else if (field_is(name, eq, "stretch_ms")) {
+			faults->stretch_ms = MIN(value, UINT16_MAX);
+		} else {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Parse one sample or fault line of the trace, returning false if it is malformed */
+static bool parse_line(const char *p, const char *end, struct replay_line *line)
+{
+	int64_t t_us;
+	size_t i;
+
+	memset(line, 0, sizeof(*line));
+
+	p = parse_micro(p, end, &t_us);
+	if (!p || (p == end) || (*p != ',')) {
+		return false;
+	}
+
+	/* Timestamps are whole milliseconds, parsed as micro-units of a millisecond */
+	line->t_ms = t_us / 1000000;
+	line->sensor = ++p;
+
+	while ((p < end) && (*p != ',')) {
+		p++;
+	}
+
+	line->sensor_len = p - line->sensor;
+
+	if ((p < end) && field_is(p + 1, end, "fault")) {
+		line->fault = true;
+		return (line->sensor_len > 0) && parse_faults(p + 1 + strlen("fault"), end,
+							      &line->faults);
+	}
+
+	for (i = 0; (p < end) && (*p == ',') && (i < SENSOR_REPLAY_MAX_VALUES); i++) {
+		p = parse_micro(p + 1, end, &line->values[i]);
+		if (!p) {
+			return false;
+		}
+	}
+
+	return (line->sensor_len > 0) && (i > 0);
+}
+
+/* Find the next sample at or after `*pos`, moving `*pos` past it */
+static bool next_line(size_t *pos, struct replay_line *line)
+{
+	const char *end = &trace[sizeof(trace)];
+
+	while (*pos < sizeof(trace)) {
+		const char *start = &trace[*pos];
+		const char *eol = memchr(start, '\n', end - start);
+
+		if (!eol) {
+			eol = end;
+		}
+
+		*pos = (eol - trace) + 1;
+
+		if (is_comment(start, eol)) {
+			continue;
+		}
+
+		if (parse_line(start, eol, line)) {
+			return true;
+		}
+
+		LOG_WRN("Skipping malformed trace line at offset %u",
+			(unsigned int)(start - trace));
+	}
+
+	return false;
+}
+
+/* Find the next sample, or fault line, of a sensor at or after `*pos`, moving `*pos` past it */
+static bool next_of(const char *sensor, bool fault, size_t *pos, struct replay_line *line)
+{
+	while (next_line(pos, line)) {
+		if ((line->fault == fault) && (strlen(sensor) == line->sensor_len) &&
+		    (strncasecmp(sensor, line->sensor, line->sensor_len) == 0)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void take(struct sensor_replay_cursor *cursor, size_t pos, const struct replay_line *line)
+{
+	cursor->pos = pos;
+	memcpy(cursor->values, line->values, sizeof(cursor->values));
+}
+
+int sensor_replay_get(struct sensor_replay_cursor *cursor, int64_t *values, size_t num_values)
+{
+	struct replay_line line;
+	int64_t trace_ms;
+	size_t pos = 0;
+	bool more;
+
+	k_mutex_lock(&replay_mutex, K_FOREVER);
+
+	if (origin_ms < 0) {
+		if (!next_line(&pos, &line)) {
+			LOG_ERR("Sensor trace has no samples");
+			k_mutex_unlock(&replay_mutex);
+			return -ENODATA;
+		}
+
+		origin_ms = k_uptime_get();
+		trace_start_ms = line.t_ms;
+	}
+
+	/* A sensor read ahead of its first sample gets that sample */
+	if (!cursor->started) {
+		pos = cursor->pos;
+		if (!next_of(cursor->sensor, false, &pos, &line)) {
+			LOG_ERR("Sensor trace has no %s samples", cursor->sensor);
+			k_mutex_unlock(&replay_mutex);
+			return -ENODATA;
+		}
+
+		take(cursor, pos, &line);
+		cursor->started = true;
+	}
+
+	trace_ms = trace_start_ms + (k_uptime_get() - origin_ms);
+	pos = cursor->pos;
+
+	while ((more = next_of(cursor->sensor, false, &pos, &line)) && (line.t_ms <= trace_ms)) {
+		take(cursor, pos, &line);
+	}
+
+	if (!more && !cursor->finished) {
+		LOG_INF("Replayed all %s samples, holding the last one", cursor->sensor);
+		cursor->finished = true;
+	}
+
+	num_values = MIN(num_values, SENSOR_REPLAY_MAX_VALUES);
+	memcpy(values, cursor->values, num_values * sizeof(values[0]));
+
+	k_mutex_unlock(&replay_mutex);
+
+	return 0;
+}
+
+static bool faults_set(const struct sensor_replay_faults *faults)
+{
+	return faults->nack_pct || faults->crc_pct || faults->stuck_ready || faults->lockup ||
+	       faults->stretch_ms;
+}
+
+/* Percentage chance from a fixed-seed xorshift, with replay_mutex held */
+static bool chance(struct sensor_replay_cursor *cursor, uint8_t pct)
+{
+	uint32_t x = cursor->fault_rng ? cursor->fault_rng : FAULT_RNG_SEED;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	cursor->fault_rng = x;
+
+	return (x % 100) < pct;
+}
+
+static void set_faults(struct sensor_replay_cursor *cursor,
+		       const struct sensor_replay_faults *faults)
+{
+	int64_t now = k_uptime_get();
+
+	cursor->faults = *faults;
+
+	if (faults_set(faults)) {
+		LOG_WRN("Injecting %s faults: nack %u%%, crc %u%%, stuck ready %d, lockup %d, "
+			"stretch %u ms",
+			cursor->sensor, faults->nack_pct, faults->crc_pct, faults->stuck_ready,
+			faults->lockup, faults->stretch_ms);
+
+		if (!cursor->fault_episode) {
+			cursor->fault_episode = true;
+			cursor->fault_start_ms = now;
+			cursor->fault_failures = 0;
+		}
+
+		cursor->fault_end_ms = -1;
+	} else if (cursor->fault_episode && (cursor->fault_end_ms < 0)) {
+		cursor->fault_end_ms = now;
+
+		LOG_INF("Cleared %s faults after %u ms, %u transfer(s) failed", cursor->sensor,
+			(uint32_t)(now - cursor->fault_start_ms), cursor->fault_failures);
+	}
+}
+
+/* Find the next fault line of the sensor, with replay_mutex held */
+static void scan_faults(struct sensor_replay_cursor *cursor)
+{
+	struct replay_line line = {0};
+
+	cursor->fault_pending = next_of(cursor->sensor, true, &cursor->fault_pos, &line);
+	cursor->next_fault_ms = line.t_ms;
+	cursor->next_faults = line.faults;
+}
+
+/* Apply the fault lines that are due, with replay_mutex held */
+static void apply_faults(struct sensor_replay_cursor *cursor)
+{
+	/* Faults follow the time of the replay, which starts at the first reading */
+	if (origin_ms < 0) {
+		return;
+	}
+
+	if (!cursor->fault_scanned) {
+		scan_faults(cursor);
+		cursor->fault_scanned = true;
+	}
+
+	while (cursor->fault_pending &&
+	       (cursor->next_fault_ms <= trace_start_ms + (k_uptime_get() - origin_ms))) {
+		set_faults(cursor, &cursor->next_faults);
+		scan_faults(cursor);
+	}
+}
+
+int sensor_replay_fault_transfer(struct sensor_replay_cursor *cursor)
+{
+	struct sensor_replay_faults faults;
+	bool nack;
+
+	k_mutex_lock(&replay_mutex, K_FOREVER);
+
+	apply_faults(cursor);
+
+	faults = cursor->faults;
+	nack = faults.lockup || chance(cursor, faults.nack_pct);
+	if (nack) {
+		cursor->fault_failures++;
+	}
+
+	k_mutex_unlock(&replay_mutex);
+
+	/* The clock is held even when the transfer then fails */
+	if (faults.stretch_ms) {
+		k_msleep(faults.stretch_ms);
+	}
+
+	return nack ? -EIO : 0;
+}
+
+bool sensor_replay_fault_crc(struct sensor_replay_cursor *cursor)
+{
+	bool corrupt;
+
+	k_mutex_lock(&replay_mutex, K_FOREVER);
+
+	corrupt = chance(cursor, cursor->faults.crc_pct);
+	if (corrupt) {
+		cursor->fault_failures++;
+	}
+
+	k_mutex_unlock(&replay_mutex);
+
+	return corrupt;
+}
+
+bool sensor_replay_fault_stuck_ready(struct sensor_replay_cursor *cursor)
+{
+	bool stuck;
+
+	k_mutex_lock(&replay_mutex, K_FOREVER);
+	stuck = cursor->faults.stuck_ready;
+	k_mutex_unlock(&replay_mutex);
+
+	return stuck;
+}
+
+void sensor_replay_fault_reading(struct sensor_replay_cursor *cursor)
+{
+	k_mutex_lock(&replay_mutex, K_FOREVER);
+
+	if (cursor->fault_episode && (cursor->fault_end_ms >= 0)) {
+		LOG_INF("%s reading again %u ms after its faults were cleared",
+			cursor->sensor, (uint32_t)(k_uptime_get() - cursor->fault_end_ms));
+		cursor->fault_episode = false;
+	}
+
+	k_mutex_unlock(&replay_mutex);
+}
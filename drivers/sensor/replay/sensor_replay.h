@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Recorded sensor traces, replayed by the emulated sensors on native_sim.
+ *
+ * A trace is a text file with one sample per line:
+ *
+ *   <t_ms>,<sensor>,<value>[,<value>...]
+ *
+ * `t_ms` is the time of the sample in milliseconds, in any time base that
+ * increases through the trace. `sensor` is BME280, SCD4x or SPS30 (case does
+ * not matter). Values are decimal numbers in the units of the application
+ * channels, in the order of src/sensor_channels.h:
+ *
+ *   BME280 - temperature (°C), pressure (kPa), humidity (%RH)
+ *   SCD4x  - CO2 (ppm), temperature (°C), humidity (%RH)
+ *   SPS30  - PM1.0, PM2.5, PM4.0, PM10 (ug/m^3), NC0.5, NC1.0, NC2.5, NC4.0,
+ *            NC10 (#/cm^3), typical particle size (um)
+ *
+ * Missing trailing values read as 0. Blank lines and lines starting with `#`
+ * are ignored. This is the format written by CONFIG_APP_SENSOR_CAPTURE.
+ *
+ * A trace can also inject I2C faults into an emulated sensor from a point
+ * of the replay on:
+ *
+ *   <t_ms>,<sensor>,fault[,<name>=<value>...]
+ *
+ * Each fault line replaces the faults of the sensor, so a line without
+ * settings clears them. The settings are those of struct
+ * sensor_replay_faults: nack_pct, crc_pct, stuck_ready, lockup and
+ * stretch_ms. NACKs and CRC errors are drawn from a fixed seed, so a run
+ * repeats. The emulator logs when the faults of a sensor start, when they
+ * are cleared, and how long after that the sensor handed out its next good
+ * reading.
+ *
+ * The first sample of the trace is played back at the first read of any
+ * sensor. From then on, each read returns the latest sample of its sensor at
+ * the same offset into the trace, so gaps and the sample rate of the capture
+ * are kept. Every sensor holds its last sample once its part of the trace
+ * has been played.
+ */
+
+#ifndef __SENSOR_REPLAY_H__
+#define __SENSOR_REPLAY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* The SPS30 has the most values per sample */
+#define SENSOR_REPLAY_MAX_VALUES 10
+
+/* Faults injected into the I2C transfers of an emulated sensor */
+struct sensor_replay_faults {
+	/* Percentage of transfers that are not acknowledged */
+	uint8_t nack_pct;
+	/* Percentage of responses with a wrong CRC */
+	uint8_t crc_pct;
+	/* Data ready is never reported */
+	bool stuck_ready;
+	/* No transfer is acknowledged, as with SDA held low by the sensor */
+	bool lockup;
+	/* Time the sensor holds SCL low in every transfer */
+	uint16_t stretch_ms;
+};
+
+struct sensor_replay_cursor {
+	/* Sensor name in the trace */
+	const char *sensor;
+	/* Offset of the first line after the current sample */
+	size_t pos;
+	bool started;
+	bool finished;
+	/* Current sample, in micro-units */
+	int64_t values[SENSOR_REPLAY_MAX_VALUES];
+
+	/* Faults in effect, and the next fault line of the sensor if `fault_pending` */
+	struct sensor_replay_faults faults;
+	struct sensor_replay_faults next_faults;
+	int64_t next_fault_ms;
+	size_t fault_pos;
+	bool fault_pending;
+	bool fault_scanned;
+	/* Faults injected since the last good reading, and when they started and ended */
+	bool fault_episode;
+	int64_t fault_start_ms;
+	int64_t fault_end_ms;
+	uint32_t fault_failures;
+	uint32_t fault_rng;
+};
+
+/**
+ * Get the sample of a sensor at the current point of the replay, in
+ * micro-units.
+ *
+ * @return 0 on success, -ENODATA if the trace has no sample of the sensor
+ */
+int sensor_replay_get(struct sensor_replay_cursor *cursor, int64_t *values, size_t num_values);
+
+/**
+ * Apply the fault lines of the trace that are due, then run the faults of
+ * a transfer: clock stretching, lockup and NACKs. Emulators call this at the
+ * start of every I2C message.
+ *
+ * @return 0 if the transfer goes ahead, -EIO if it is not acknowledged
+ */
+int sensor_replay_fault_transfer(struct sensor_replay_cursor *cursor);
+
+/* Whether to corrupt the CRC of the response being read */
+bool sensor_replay_fault_crc(struct sensor_replay_cursor *cursor);
+
+/* Whether data ready is stuck off */
+bool sensor_replay_fault_stuck_ready(struct sensor_replay_cursor *cursor);
+
+/* Record that the sensor handed out a good reading, ending a cleared fault episode */
+void sensor_replay_fault_reading(struct sensor_replay_cursor *cursor);
+
+#endif /* __SENSOR_REPLAY_H__ */
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT sensirion_sps30
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+#include <zephyr/kernel.h>
+
+#include "sensirion_emul.h"
+#include "sensor_replay.h"
+
+#define SPS30_CMD_START_MEASUREMENT	0x0010
+#define SPS30_CMD_STOP_MEASUREMENT	0x0104
+#define SPS30_CMD_READ_DATA_READY	0x0202
+#define SPS30_CMD_READ_MEASURED_VALUES	0x0300
+#define SPS30_CMD_SLEEP			0x1001
+#define SPS30_CMD_WAKE_UP		0x1103
+#define SPS30_CMD_READ_FIRMWARE_VERSION 0xD100
+#define SPS30_CMD_READ_SERIAL_NUMBER	0xD033
+#define SPS30_CMD_RESET			0xD304
+
+#define SPS30_OUTPUT_FORMAT_UINT16 0x0500
+
+#define SPS30_EMUL_FIRMWARE_VERSION 0x0202
+#define SPS30_EMUL_SAMPLE_MS	    1000
+
+/* Mass concentrations, number concentrations and typical particle size, in sensor order */
+#define SPS30_EMUL_NUM_VALUES 10
+#define SPS30_EMUL_TPS_INDEX  9
+
+struct sps30_emul_data {
+	struct sensor_replay_cursor cursor;
+	uint16_t cmd;
+	bool uint16_format;
+	bool measuring;
+	bool sleeping;
+	/* Uptime of the last reading handed out, or of the measurement start */
+	int64_t sample_ms;
+};
+
+static int sps30_emul_measurement(struct sps30_emul_data *data, uint8_t *buf, size_t len)
+{
+	int64_t values[SPS30_EMUL_NUM_VALUES];
+	uint16_t words[2 * SPS30_EMUL_NUM_VALUES];
+	int err;
+
+	err = sensor_replay_get(&data->cursor, values, ARRAY_SIZE(values));
+	if (err) {
+		return -EIO;
+	}
+
+	for (int i = 0; i < SPS30_EMUL_NUM_VALUES; i++) {
+		if (data->uint16_format) {
+			/* Whole units, particle size in nm */
+			int64_t scale = (i == SPS30_EMUL_TPS_INDEX) ? 1000 : 1000000;
+
+			words[i] = CLAMP((values[i] + scale / 2) / scale, 0, UINT16_MAX);
+		} else {
+			float value = (float)values[i] / 1000000.0f;
+			uint32_t bits;
+
+			memcpy(&bits, &value, sizeof(bits));
+			words[2 * i] = bits >> 16;
+			words[2 * i + 1] = bits & 0xFFFF;
+		}
+	}
+
+	data->sample_ms = k_uptime_get();
+
+	return sensirion_emul_words_put(buf, len, words,
+					data->uint16_format ? SPS30_EMUL_NUM_VALUES
+							    : 2 * SPS30_EMUL_NUM_VALUES);
+}
+
+static int sps30_emul_write(struct sps30_emul_data *data, const uint8_t *buf, size_t len)
+{
+	uint16_t args[1];
+	int ret;
+
+	ret = sensirion_emul_cmd_parse(buf, len, &data->cmd, args, ARRAY_SIZE(args));
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* In sleep mode the sensor only responds to wake-up */
+	if (data->sleeping && (data->cmd != SPS30_CMD_WAKE_UP)) {
+		return -EIO;
+	}
+
+	switch (data->cmd) {
+	case SPS30_CMD_START_MEASUREMENT:
+		if (ret != 1) {
+			return -EIO;
+		}
+
+		data->uint16_format = (args[0] == SPS30_OUTPUT_FORMAT_UINT16);
+		data->measuring = true;
+		data->sample_ms = k_uptime_get();
+		return 0;
+	case SPS30_CMD_STOP_MEASUREMENT:
+	case SPS30_CMD_RESET:
+		data->measuring = false;
+		return 0;
+	case SPS30_CMD_SLEEP:
+		if (data->measuring) {
+			return -EIO;
+		}
+
+		data->sleeping = true;
+		return 0;
+	case SPS30_CMD_WAKE_UP:
+		data->sleeping = false;
+		return 0;
+	default:
+		/* Fan cleaning and its interval have no effect on the replayed values */
+		return 0;
+	}
+}
+
+static int sps30_emul_read(struct sps30_emul_data *data, uint8_t *buf, size_t len)
+{
+	static const uint16_t version = SPS30_EMUL_FIRMWARE_VERSION;
+	uint16_t serial[16] = {0};
+	uint16_t ready;
+
+	if (data->sleeping) {
+		return -EIO;
+	}
+
+	switch (data->cmd) {
+	case SPS30_CMD_READ_FIRMWARE_VERSION:
+		return sensirion_emul_words_put(buf, len, &version, 1);
+	case SPS30_CMD_READ_SERIAL_NUMBER:
+		/* Two ASCII characters per word */
+		serial[0] = ('R' << 8) | 'E';
+		serial[1] = ('P' << 8) | 'L';
+		serial[2] = ('A' << 8) | 'Y';
+		return sensirion_emul_words_put(buf, len, serial, ARRAY_SIZE(serial));
+	case SPS30_CMD_READ_DATA_READY:
+		/* A new reading every second while measuring */
+		ready = data->measuring && !sensor_replay_fault_stuck_ready(&data->cursor) &&
+			(k_uptime_get() - data->sample_ms >= SPS30_EMUL_SAMPLE_MS);
+		return sensirion_emul_words_put(buf, len, &ready, 1);
+	case SPS30_CMD_READ_MEASURED_VALUES:
+		if (!data->measuring) {
+			return -EIO;
+		}
+
+		return sps30_emul_measurement(data, buf, len);
+	default:
+		return -EIO;
+	}
+}
+
+static int sps30_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs,
+			       int addr)
+{
+	struct sps30_emul_data *data = target->data;
+	int err = 0;
+
+	for (int i = 0; (i < num_msgs) && !err; i++) {
+		err = sensor_replay_fault_transfer(&data->cursor);
+		if (err) {
+			break;
+		}
+
+		if (msgs[i].flags & I2C_MSG_READ) {
+			err = sps30_emul_read(data, msgs[i].buf, msgs[i].len);
+			if (!err) {
+				sensirion_emul_read_faults(
+					&data->cursor, msgs[i].buf,
+					data->cmd == SPS30_CMD_READ_MEASURED_VALUES);
+			}
+		} else {
+			err = sps30_emul_write(data, msgs[i].buf, msgs[i].len);
+		}
+	}
+
+	return err;
+}
+
+static const struct i2c_emul_api sps30_emul_api = {
+	.transfer = sps30_emul_transfer,
+};
+
+static int sps30_emul_init(const struct emul *target, const struct device *parent)
+{
+	struct sps30_emul_data *data = target->data;
+
+	data->cursor.sensor = "SPS30";
+
+	return 0;
+}
+
+#define SPS30_EMUL_DEFINE(inst)                                                                    \
+	static struct sps30_emul_data sps30_emul_data_##inst;                                      \
+                                                                                                   \
+	EMUL_DT_INST_DEFINE(inst, sps30_emul_init, &sps30_emul_data_##inst, NULL,                  \
+			    &sps30_emul_api, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(SPS30_EMUL_DEFINE)
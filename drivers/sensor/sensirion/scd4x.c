@@ -0,0 +1,505 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(scd4x, CONFIG_SENSOR_LOG_LEVEL);
+
+#define DT_DRV_COMPAT sensirion_scd4x
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/rtio/rtio.h>
+
+#include <drivers/sensor/scd4x.h>
+
+#include "sensirion_common.h"
+
+#define SCD4X_CMD_WAKE_UP			  0x36F6
+#define SCD4X_CMD_STOP_PERIODIC_MEASUREMENT	  0x3F86
+#define SCD4X_CMD_REINIT			  0x3646
+#define SCD4X_CMD_GET_SERIAL_NUMBER		  0x3682
+#define SCD4X_CMD_MEASURE_SINGLE_SHOT		  0x219D
+#define SCD4X_CMD_GET_DATA_READY_STATUS		  0xE4B8
+#define SCD4X_CMD_READ_MEASUREMENT		  0xEC05
+#define SCD4X_CMD_SET_TEMPERATURE_OFFSET	  0x241D
+#define SCD4X_CMD_SET_SENSOR_ALTITUDE		  0x2427
+#define SCD4X_CMD_SET_AUTOMATIC_SELF_CALIBRATION 0x2416
+
+#define SCD4X_POWER_UP_TIME		 K_MSEC(1000)
+#define SCD4X_WAKE_UP_TIME		 K_MSEC(30)
+#define SCD4X_STOP_PERIODIC_TIME	 K_MSEC(500)
+#define SCD4X_REINIT_TIME		 K_MSEC(20)
+#define SCD4X_CMD_TIME			 K_MSEC(1)
+#define SCD4X_MEASURE_SINGLE_SHOT_TIME	 K_MSEC(5000)
+#define SCD4X_DATA_READY_POLL_INTERVAL	 K_MSEC(100)
+#define SCD4X_DATA_READY_POLLS		 50
+#define SCD4X_DATA_READY_MASK		 0x07FF
+#define SCD4X_FETCH_TIMEOUT		 K_MSEC(SCD4X_MEASURE_MAX_MS + 1000)
+
+struct scd4x_config {
+	struct i2c_dt_spec i2c;
+};
+
+/* Raw sensor words, also used as the encoded format of sensor_read_async() */
+struct scd4x_encoded_data {
+	uint64_t timestamp_ns;
+	uint16_t co2;
+	uint16_t temperature;
+	uint16_t humidity;
+};
+
+struct scd4x_data {
+	const struct device *dev;
+	/* Serializes bus access and protects the fields below */
+	struct k_mutex lock;
+	struct k_work_delayable work;
+	struct k_sem done;
+	/* Async request being measured, or NULL for a blocking fetch */
+	struct rtio_iodev_sqe *iodev_sqe;
+	bool busy;
+	uint8_t polls;
+	int result;
+	struct scd4x_encoded_data sample;
+};
+
+/* Wake up and reinitialize to the default state. Must be called with the lock held, if any. */
+static int scd4x_reinit(const struct scd4x_config *cfg)
+{
+	int err;
+
+	/* Wake-up is not acknowledged */
+	(void)sensirion_cmd_write(&cfg->i2c, SCD4X_CMD_WAKE_UP, NULL, 0);
+	k_sleep(SCD4X_WAKE_UP_TIME);
+
+	err = sensirion_cmd_write(&cfg->i2c, SCD4X_CMD_STOP_PERIODIC_MEASUREMENT, NULL, 0);
+	if (err) {
+		LOG_ERR("Error stopping SCD4x periodic measurement: %d", err);
+		return err;
+	}
+	k_sleep(SCD4X_STOP_PERIODIC_TIME);
+
+	err = sensirion_cmd_write(&cfg->i2c, SCD4X_CMD_REINIT, NULL, 0);
+	if (err) {
+		LOG_ERR("Error reinitializing SCD4x: %d", err);
+		return err;
+	}
+	k_sleep(SCD4X_REINIT_TIME);
+
+	return 0;
+}
+
+static int scd4x_value_micro(const struct scd4x_encoded_data *sample, enum sensor_channel chan,
+			     int64_t *micro)
+{
+	switch (chan) {
+	case SENSOR_CHAN_CO2:
+		*micro = (int64_t)sample->co2 * 1000000;
+		return 0;
+	case SENSOR_CHAN_AMBIENT_TEMP:
+		*micro = -45000000 + ((int64_t)sample->temperature * 175000000) / 65536;
+		return 0;
+	case SENSOR_CHAN_HUMIDITY:
+		*micro = ((int64_t)sample->humidity * 100000000) / 65536;
+		return 0;
+	default:
+		return -ENOTSUP;
+	}
+}
+
+static void scd4x_measure_complete(struct scd4x_data *data, struct rtio_iodev_sqe *iodev_sqe,
+				   const struct scd4x_encoded_data *sample, int result)
+{
+	uint8_t *buf;
+	uint32_t buf_len;
+
+	if (!iodev_sqe) {
+		data->result = result;
+		k_sem_give(&data->done);
+		return;
+	}
+
+	if (result == 0) {
+		result = rtio_sqe_rx_buf(iodev_sqe, sizeof(*sample), sizeof(*sample), &buf,
+					 &buf_len);
+	}
+
+	if (result) {
+		rtio_iodev_sqe_err(iodev_sqe, result);
+		return;
+	}
+
+	memcpy(buf, sample, sizeof(*sample));
+	rtio_iodev_sqe_ok(iodev_sqe, 0);
+}
+
+/* Polls for the end of a single-shot measurement without blocking the caller */
+static void scd4x_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct scd4x_data *data = CONTAINER_OF(dwork, struct scd4x_data, work);
+	const struct scd4x_config *cfg = data->dev->config;
+	struct rtio_iodev_sqe *iodev_sqe;
+	struct scd4x_encoded_data sample;
+	uint16_t words[3];
+	int err;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	/* The measurement was aborted while this work item waited for the lock */
+	if (!data->busy) {
+		k_mutex_unlock(&data->lock);
+		return;
+	}
+
+	err = sensirion_cmd_read(&cfg->i2c, SCD4X_CMD_GET_DATA_READY_STATUS, SCD4X_CMD_TIME, words,
+				 1);
+	if (!err && !(words[0] & SCD4X_DATA_READY_MASK)) {
+		if (++data->polls < SCD4X_DATA_READY_POLLS) {
+			k_work_schedule_for_queue(&sensirion_work_q, &data->work,
+						  SCD4X_DATA_READY_POLL_INTERVAL);
+			k_mutex_unlock(&data->lock);
+			return;
+		}
+
+		err = -ETIMEDOUT;
+	}
+
+	sensirion_trace("scd4x_integrate", SENSIRION_TRACE_END, data->polls);
+
+	if (!err) {
+		err = sensirion_cmd_read(&cfg->i2c, SCD4X_CMD_READ_MEASUREMENT, SCD4X_CMD_TIME,
+					 words, ARRAY_SIZE(words));
+	}
+
+	if (!err && (words[0] == 0)) {
+		/* A CO2 concentration of 0 ppm marks an invalid sample */
+		err = -EIO;
+	}
+
+	if (err) {
+		LOG_ERR("Error reading SCD4x measurement: %d", err);
+	} else {
+		data->sample.timestamp_ns = k_ticks_to_ns_floor64(k_uptime_ticks());
+		data->sample.co2 = words[0];
+		data->sample.temperature = words[1];
+		data->sample.humidity = words[2];
+	}
+
+	sample = data->sample;
+	iodev_sqe = data->iodev_sqe;
+	data->iodev_sqe = NULL;
+	data->busy = false;
+
+	k_mutex_unlock(&data->lock);
+
+	scd4x_measure_complete(data, iodev_sqe, &sample, err);
+}
+
+static int scd4x_measure_start(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct scd4x_config *cfg = dev->config;
+	struct scd4x_data *data = dev->data;
+	int err;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	if (data->busy) {
+		k_mutex_unlock(&data->lock);
+		return -EBUSY;
+	}
+
+	err = sensirion_cmd_write(&cfg->i2c, SCD4X_CMD_MEASURE_SINGLE_SHOT, NULL, 0);
+	if (err) {
+		LOG_ERR("Error starting SCD4x single-shot measurement: %d", err);
+	} else {
+		data->busy = true;
+		data->polls = 0;
+		data->iodev_sqe = iodev_sqe;
+		k_work_schedule_for_queue(&sensirion_work_q, &data->work,
+					  SCD4X_MEASURE_SINGLE_SHOT_TIME);
+		sensirion_trace("scd4x_integrate", SENSIRION_TRACE_BEGIN, 0);
+	}
+
+	k_mutex_unlock(&data->lock);
+
+	return err;
+}
+
+static int scd4x_sample_fetch(const struct device *dev, enum sensor_channel chan)
+{
+	struct scd4x_data *data = dev->data;
+	int err;
+
+	if ((chan != SENSOR_CHAN_ALL) && (chan != SENSOR_CHAN_CO2) &&
+	    (chan != SENSOR_CHAN_AMBIENT_TEMP) && (chan != SENSOR_CHAN_HUMIDITY)) {
+		return -ENOTSUP;
+	}
+
+	/* Drop the completion of an earlier fetch that timed out */
+	k_sem_reset(&data->done);
+
+	err = scd4x_measure_start(dev, NULL);
+	if (err) {
+		return err;
+	}
+
+	err = k_sem_take(&data->done, SCD4X_FETCH_TIMEOUT);
+	if (err) {
+		LOG_ERR("SCD4x measurement timed out");
+		return -ETIMEDOUT;
+	}
+
+	return data->result;
+}
+
+static int scd4x_channel_get(const struct device *dev, enum sensor_channel chan,
+			     struct sensor_value *val)
+{
+	struct scd4x_data *data = dev->data;
+	int64_t micro;
+	int err;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	err = scd4x_value_micro(&data->sample, chan, &micro);
+	k_mutex_unlock(&data->lock);
+
+	if (err) {
+		return err;
+	}
+
+	return sensor_value_from_micro(val, micro);
+}
+
+/* Abort a measurement in progress, which completes with -ECANCELED, and reinitialize */
+static int scd4x_abort_and_reinit(const struct device *dev)
+{
+	const struct scd4x_config *cfg = dev->config;
+	struct scd4x_data *data = dev->data;
+	struct rtio_iodev_sqe *iodev_sqe;
+	struct scd4x_encoded_data sample;
+	bool aborted;
+	int err;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	aborted = data->busy;
+	iodev_sqe = data->iodev_sqe;
+	sample = data->sample;
+
+	if (aborted) {
+		k_work_cancel_delayable(&data->work);
+		data->iodev_sqe = NULL;
+		data->busy = false;
+		sensirion_trace("scd4x_integrate", SENSIRION_TRACE_END, data->polls);
+	}
+
+	err = scd4x_reinit(cfg);
+
+	k_mutex_unlock(&data->lock);
+
+	if (aborted) {
+		scd4x_measure_complete(data, iodev_sqe, &sample, -ECANCELED);
+	}
+
+	return err;
+}
+
+static int scd4x_attr_set(const struct device *dev, enum sensor_channel chan,
+			  enum sensor_attribute attr, const struct sensor_value *val)
+{
+	const struct scd4x_config *cfg = dev->config;
+	struct scd4x_data *data = dev->data;
+	int64_t offset_milli;
+	uint16_t cmd;
+	uint16_t arg;
+	int err;
+
+	switch ((int)attr) {
+	case SENSOR_ATTR_SCD4X_TEMPERATURE_OFFSET:
+		offset_milli = sensor_value_to_milli(val);
+		if ((offset_milli < 0) || (offset_milli > SCD4X_TEMPERATURE_OFFSET_MAX_MILLI)) {
+			return -EINVAL;
+		}
+		cmd = SCD4X_CMD_SET_TEMPERATURE_OFFSET;
+		arg = (uint16_t)((offset_milli * 65536 + 87500) / 175000);
+		break;
+	case SENSOR_ATTR_SCD4X_ALTITUDE:
+		if ((val->val1 < 0) || (val->val1 > UINT16_MAX)) {
+			return -EINVAL;
+		}
+		cmd = SCD4X_CMD_SET_SENSOR_ALTITUDE;
+		arg = (uint16_t)val->val1;
+		break;
+	case SENSOR_ATTR_SCD4X_AUTOMATIC_SELF_CALIBRATION:
+		cmd = SCD4X_CMD_SET_AUTOMATIC_SELF_CALIBRATION;
+		arg = val->val1 ? 1 : 0;
+		break;
+	case SENSOR_ATTR_SCD4X_REINIT:
+		return scd4x_abort_and_reinit(dev);
+	default:
+		return -ENOTSUP;
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	/* Settings can only be changed while the sensor is idle */
+	if (data->busy) {
+		k_mutex_unlock(&data->lock);
+		return -EBUSY;
+	}
+
+	err = sensirion_cmd_write(&cfg->i2c, cmd, &arg, 1);
+	k_sleep(SCD4X_CMD_TIME);
+
+	k_mutex_unlock(&data->lock);
+
+	return err;
+}
+
+#ifdef CONFIG_SENSOR_ASYNC_API
+
+static void scd4x_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe)
+{
+	int err = scd4x_measure_start(dev, iodev_sqe);
+
+	if (err) {
+		rtio_iodev_sqe_err(iodev_sqe, err);
+	}
+}
+
+static int scd4x_decoder_get_frame_count(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+					 uint16_t *frame_count)
+{
+	int64_t micro;
+
+	if ((chan_spec.chan_idx != 0) ||
+	    scd4x_value_micro((const struct scd4x_encoded_data *)buffer, chan_spec.chan_type,
+			      &micro)) {
+		return -ENOTSUP;
+	}
+
+	*frame_count = 1;
+
+	return 0;
+}
+
+static int scd4x_decoder_get_size_info(struct sensor_chan_spec chan_spec, size_t *base_size,
+				       size_t *frame_size)
+{
+	switch (chan_spec.chan_type) {
+	case SENSOR_CHAN_CO2:
+	case SENSOR_CHAN_AMBIENT_TEMP:
+	case SENSOR_CHAN_HUMIDITY:
+		*base_size = sizeof(struct sensor_q31_data);
+		*frame_size = sizeof(struct sensor_q31_sample_data);
+		return 0;
+	default:
+		return -ENOTSUP;
+	}
+}
+
+static int scd4x_decoder_decode(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+				uint32_t *fit, uint16_t max_count, void *data_out)
+{
+	const struct scd4x_encoded_data *edata = (const struct scd4x_encoded_data *)buffer;
+	int64_t micro;
+	int err;
+
+	if ((*fit != 0) || (max_count == 0)) {
+		return 0;
+	}
+
+	if (chan_spec.chan_idx != 0) {
+		return -ENOTSUP;
+	}
+
+	err = scd4x_value_micro(edata, chan_spec.chan_type, &micro);
+	if (err) {
+		return err;
+	}
+
+	sensirion_q31_from_micro(data_out, edata->timestamp_ns, micro);
+	*fit = 1;
+
+	return 1;
+}
+
+SENSOR_DECODER_API_DT_DEFINE() = {
+	.get_frame_count = scd4x_decoder_get_frame_count,
+	.get_size_info = scd4x_decoder_get_size_info,
+	.decode = scd4x_decoder_decode,
+};
+
+static int scd4x_get_decoder(const struct device *dev, const struct sensor_decoder_api **decoder)
+{
+	*decoder = &SENSOR_DECODER_NAME();
+
+	return 0;
+}
+
+#endif /* CONFIG_SENSOR_ASYNC_API */
+
+static const struct sensor_driver_api scd4x_api = {
+	.sample_fetch = scd4x_sample_fetch,
+	.channel_get = scd4x_channel_get,
+	.attr_set = scd4x_attr_set,
+#ifdef CONFIG_SENSOR_ASYNC_API
+	.submit = scd4x_submit,
+	.get_decoder = scd4x_get_decoder,
+#endif
+};
+
+static int scd4x_init(const struct device *dev)
+{
+	const struct scd4x_config *cfg = dev->config;
+	struct scd4x_data *data = dev->data;
+	uint16_t serial[3];
+	int err;
+
+	if (!i2c_is_ready_dt(&cfg->i2c)) {
+		LOG_ERR("Bus %s is not ready", cfg->i2c.bus->name);
+		return -ENODEV;
+	}
+
+	data->dev = dev;
+	k_mutex_init(&data->lock);
+	k_sem_init(&data->done, 0, 1);
+	k_work_init_delayable(&data->work, scd4x_work_handler);
+
+	/* After VDD reaches 2.25 V, the SCD4x needs 1000 ms to enter the idle state */
+	k_sleep(SCD4X_POWER_UP_TIME);
+
+	err = scd4x_reinit(cfg);
+	if (err) {
+		return err;
+	}
+
+	err = sensirion_cmd_read(&cfg->i2c, SCD4X_CMD_GET_SERIAL_NUMBER, SCD4X_CMD_TIME, serial,
+				 ARRAY_SIZE(serial));
+	if (err) {
+		LOG_ERR("Cannot read SCD4x serial number: %d", err);
+		return err;
+	}
+
+	LOG_DBG("SCD4x serial number: 0x%04x%04x%04x", serial[0], serial[1], serial[2]);
+
+	return 0;
+}
+
+#define SCD4X_DEFINE(inst)                                                                         \
+	static struct scd4x_data scd4x_data_##inst;                                                \
+                                                                                                   \
+	static const struct scd4x_config scd4x_config_##inst = {                                   \
+		.i2c = I2C_DT_SPEC_INST_GET(inst),                                                 \
+	};                                                                                         \
+                                                                                                   \
+	SENSOR_DEVICE_DT_INST_DEFINE(inst, scd4x_init, NULL, &scd4x_data_##inst,                  \
+				     &scd4x_config_##inst, POST_KERNEL,                            \
+				     CONFIG_SENSOR_INIT_PRIORITY, &scd4x_api);
+
+DT_INST_FOREACH_STATUS_OKAY(SCD4X_DEFINE)
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+
+#include "sensirion_common.h"
+
+#define SENSIRION_CRC8_POLYNOMIAL 0x31
+#define SENSIRION_CRC8_INIT	  0xFF
+/* Each word is followed by its CRC */
+#define SENSIRION_WORD_LEN	  3
+
+K_THREAD_STACK_DEFINE(sensirion_work_q_stack, CONFIG_SENSIRION_WORKQ_STACK_SIZE);
+struct k_work_q sensirion_work_q;
+
+static uint8_t sensirion_crc(const uint8_t *word)
+{
+	return crc8(word, sizeof(uint16_t), SENSIRION_CRC8_POLYNOMIAL, SENSIRION_CRC8_INIT, false);
+}
+
+int sensirion_cmd_write(const struct i2c_dt_spec *i2c, uint16_t cmd, const uint16_t *args,
+			size_t num_args)
+{
+	uint8_t buf[sizeof(uint16_t) + 2 * SENSIRION_WORD_LEN];
+	size_t len = sizeof(uint16_t);
+
+	if (num_args > 2) {
+		return -EINVAL;
+	}
+
+	sys_put_be16(cmd, buf);
+
+	for (size_t i = 0; i < num_args; i++) {
+		sys_put_be16(args[i], &buf[len]);
+		buf[len + 2] = sensirion_crc(&buf[len]);
+		len += SENSIRION_WORD_LEN;
+	}
+
+	return i2c_write_dt(i2c, buf, len);
+}
+
+int sensirion_words_read(const struct i2c_dt_spec *i2c, uint16_t *words, size_t num_words)
+{
+	uint8_t buf[SENSIRION_MAX_WORDS * SENSIRION_WORD_LEN];
+	int err;
+
+	if (num_words > SENSIRION_MAX_WORDS) {
+		return -EINVAL;
+	}
+
+	err = i2c_read_dt(i2c, buf, num_words * SENSIRION_WORD_LEN);
+	if (err) {
+		return err;
+	}
+
+	for (size_t i = 0; i < num_words; i++) {
+		const uint8_t *word = &buf[i * SENSIRION_WORD_LEN];
+
+		if (sensirion_crc(word) != word[2]) {
+			return -EIO;
+		}
+
+		words[i] = sys_get_be16(word);
+	}
+
+	return 0;
+}
+
+int sensirion_cmd_read(const struct i2c_dt_spec *i2c, uint16_t cmd, k_timeout_t exec_time,
+		       uint16_t *words, size_t num_words)
+{
+	int err;
+
+	err = sensirion_cmd_write(i2c, cmd, NULL, 0);
+	if (err) {
+		return err;
+	}
+
+	if (!K_TIMEOUT_EQ(exec_time, K_NO_WAIT)) {
+		k_sleep(exec_time);
+	}
+
+	return sensirion_words_read(i2c, words, num_words);
+}
+
+void sensirion_q31_from_micro(struct sensor_q31_data *out, uint64_t timestamp_ns, int64_t micro)
+{
+	int64_t magnitude = (micro < 0) ? -micro : micro;
+	int8_t shift = 0;
+
+	/* Smallest shift that holds the integer part */
+	while ((shift < 31) && (magnitude >= ((int64_t)1000000 << shift))) {
+		shift++;
+	}
+
+	out->header.base_timestamp_ns = timestamp_ns;
+	out->header.reading_count = 1;
+	out->shift = shift;
+	out->readings[0].timestamp_delta = 0;
+	out->readings[0].value = (q31_t)((micro * ((int64_t)1 << (31 - shift))) / 1000000);
+}
+
+static int sensirion_work_q_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "sensirion_workq",
+	};
+
+	k_work_queue_start(&sensirion_work_q, sensirion_work_q_stack,
+			   K_THREAD_STACK_SIZEOF(sensirion_work_q_stack),
+			   CONFIG_SENSIRION_WORKQ_PRIORITY, &cfg);
+
+	return 0;
+}
+
+/* Started ahead of the sensor drivers, which only schedule work once initialized */
+SYS_INIT(sensirion_work_q_init, POST_KERNEL, 0);
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * I2C framing shared by Sensirion sensors: 16-bit big-endian commands followed
+ * by 16-bit words, each protected by a CRC-8.
+ */
+
+#ifndef __SENSIRION_COMMON_H__
+#define __SENSIRION_COMMON_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/drivers/sensor_data_types.h>
+#ifdef CONFIG_TRACING_CTF
+#include <zephyr/tracing/tracing.h>
+#endif
+
+/* Work queue on which the drivers poll sensors while a measurement is in progress */
+extern struct k_work_q sensirion_work_q;
+
+/* Largest transfer: the SPS30 float measurement, ten 32-bit values */
+#define SENSIRION_MAX_WORDS 20
+
+int sensirion_cmd_write(const struct i2c_dt_spec *i2c, uint16_t cmd, const uint16_t *args,
+			size_t num_args);
+int sensirion_words_read(const struct i2c_dt_spec *i2c, uint16_t *words, size_t num_words);
+
+/* Write a command, wait for it to execute and read its response */
+int sensirion_cmd_read(const struct i2c_dt_spec *i2c, uint16_t cmd, k_timeout_t exec_time,
+		       uint16_t *words, size_t num_words);
+
+/* Fill a single q31 reading from a value in micro-units */
+void sensirion_q31_from_micro(struct sensor_q31_data *out, uint64_t timestamp_ns, int64_t micro);
+
+/* Phases of the named CTF events marking driver spans, e.g. an SCD4x integration */
+#define SENSIRION_TRACE_BEGIN 0
+#define SENSIRION_TRACE_END   1
+
+static inline void sensirion_trace(const char *name, uint32_t phase, uint32_t arg)
+{
+#ifdef CONFIG_TRACING_CTF
+	sys_trace_named_event(name, phase, arg);
+#else
+	ARG_UNUSED(name);
+	ARG_UNUSED(phase);
+	ARG_UNUSED(arg);
+#endif
+}
+
+#endif /* __SENSIRION_COMMON_H__ */
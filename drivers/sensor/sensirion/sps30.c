@@ -0,0 +1,704 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(sps30, CONFIG_SENSOR_LOG_LEVEL);
+
+#define DT_DRV_COMPAT sensirion_sps30
+
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/rtio/rtio.h>
+
+#include <drivers/sensor/sps30.h>
+
+#include "sensirion_common.h"
+
+#define SPS30_CMD_START_MEASUREMENT	  0x0010
+#define SPS30_CMD_STOP_MEASUREMENT	  0x0104
+#define SPS30_CMD_READ_DATA_READY	  0x0202
+#define SPS30_CMD_READ_MEASURED_VALUES	  0x0300
+#define SPS30_CMD_SLEEP			  0x1001
+#define SPS30_CMD_WAKE_UP		  0x1103
+#define SPS30_CMD_START_FAN_CLEANING	  0x5607
+#define SPS30_CMD_AUTO_CLEANING_INTERVAL  0x8004
+#define SPS30_CMD_READ_FIRMWARE_VERSION	  0xD100
+#define SPS30_CMD_READ_SERIAL_NUMBER	  0xD033
+#define SPS30_CMD_RESET			  0xD304
+
+#define SPS30_OUTPUT_FORMAT_FLOAT  0x0300
+#define SPS30_OUTPUT_FORMAT_UINT16 0x0500
+
+#define SPS30_CMD_TIME			K_MSEC(20)
+#define SPS30_SLEEP_TIME		K_MSEC(5)
+#define SPS30_RESET_TIME		K_MSEC(100)
+#define SPS30_PROBE_INTERVAL		K_SECONDS(1)
+#define SPS30_PROBE_TRIES		10
+#define SPS30_SAMPLE_INTERVAL		K_SECONDS(1)
+#define SPS30_DATA_READY_POLL_INTERVAL	K_MSEC(100)
+#define SPS30_DATA_READY_POLLS		100
+#define SPS30_SERIAL_WORDS		16
+/* Allow every data-ready poll on top of the one-second readings */
+#define SPS30_FETCH_MARGIN_MS		(SPS30_DATA_READY_POLLS * 100 + 1000)
+
+/* Mass concentrations, number concentrations and typical particle size, in sensor order */
+#define SPS30_NUM_VALUES 10
+#define SPS30_TPS_INDEX	 9
+
+enum sps30_state {
+	SPS30_IDLE,
+	SPS30_MEASURING,
+	SPS30_SLEEPING,
+};
+
+struct sps30_config {
+	struct i2c_dt_spec i2c;
+	bool uint16_format;
+};
+
+/* Averaged values in micro-units, also used as the encoded format of sensor_read_async() */
+struct sps30_encoded_data {
+	uint64_t window_start_ns;
+	uint64_t window_end_ns;
+	int64_t values[SPS30_NUM_VALUES];
+};
+
+struct sps30_data {
+	const struct device *dev;
+	/* Serializes bus access and protects the fields below */
+	struct k_mutex lock;
+	struct k_work_delayable work;
+	struct k_sem done;
+	/* Async request being averaged, or NULL for a blocking fetch */
+	struct rtio_iodev_sqe *iodev_sqe;
+	enum sps30_state state;
+	bool busy;
+	uint32_t samples;
+	uint32_t count;
+	uint8_t polls;
+	int result;
+	float sum_float[SPS30_NUM_VALUES];
+	/* 32 bits hold more than 65k readings of each channel */
+	uint32_t sum_uint16[SPS30_NUM_VALUES];
+	uint32_t bus_cycles_total;
+	uint32_t bus_cycles_max;
+	struct sps30_encoded_data sample;
+};
+
+static int sps30_channel_index(enum sensor_channel chan)
+{
+	switch ((int)chan) {
+	case SENSOR_CHAN_PM_1_0:
+		return 0;
+	case SENSOR_CHAN_PM_2_5:
+		return 1;
+	case SENSOR_CHAN_SPS30_MC_4P0:
+		return 2;
+	case SENSOR_CHAN_PM_10:
+		return 3;
+	case SENSOR_CHAN_SPS30_NC_0P5:
+		return 4;
+	case SENSOR_CHAN_SPS30_NC_1P0:
+		return 5;
+	case SENSOR_CHAN_SPS30_NC_2P5:
+		return 6;
+	case SENSOR_CHAN_SPS30_NC_4P0:
+		return 7;
+	case SENSOR_CHAN_SPS30_NC_10P0:
+		return 8;
+	case SENSOR_CHAN_SPS30_TYPICAL_PARTICLE_SIZE:
+		return SPS30_TPS_INDEX;
+	default:
+		return -ENOTSUP;
+	}
+}
+
+/* Must be called with the lock held */
+static int sps30_start(const struct device *dev)
+{
+	const struct sps30_config *cfg = dev->config;
+	struct sps30_data *data = dev->data;
+	uint16_t format;
+	int err;
+
+	format = cfg->uint16_format ? SPS30_OUTPUT_FORMAT_UINT16 : SPS30_OUTPUT_FORMAT_FLOAT;
+
+	err = sensirion_cmd_write(&cfg->i2c, SPS30_CMD_START_MEASUREMENT, &format, 1);
+	if (err) {
+		LOG_ERR("Error entering SPS30 measurement mode: %d", err);
+		return err;
+	}
+
+	k_sleep(SPS30_CMD_TIME);
+	data->state = SPS30_MEASURING;
+
+	return 0;
+}
+
+/* Must be called with the lock held */
+static void sps30_wake_up(const struct device *dev)
+{
+	const struct sps30_config *cfg = dev->config;
+
+	/* The first wake-up command only activates the interface and is not acknowledged */
+	(void)sensirion_cmd_write(&cfg->i2c, SPS30_CMD_WAKE_UP, NULL, 0);
+	(void)sensirion_cmd_write(&cfg->i2c, SPS30_CMD_WAKE_UP, NULL, 0);
+	k_sleep(SPS30_SLEEP_TIME);
+}
+
+/* Must be called with the lock held */
+static int sps30_wake(const struct device *dev)
+{
+	struct sps30_data *data = dev->data;
+
+	if (data->state == SPS30_MEASURING) {
+		return 0;
+	}
+
+	if (data->state == SPS30_SLEEPING) {
+		sps30_wake_up(dev);
+		data->state = SPS30_IDLE;
+	}
+
+	return sps30_start(dev);
+}
+
+/* Must be called with the lock held */
+static int sps30_sleep(const struct device *dev)
+{
+	const struct sps30_config *cfg = dev->config;
+	struct sps30_data *data = dev->data;
+	int err;
+
+	if (data->state == SPS30_SLEEPING) {
+		return 0;
+	}
+
+	if (data->state == SPS30_MEASURING) {
+		err = sensirion_cmd_write(&cfg->i2c, SPS30_CMD_STOP_MEASUREMENT, NULL, 0);
+		if (err) {
+			LOG_ERR("Error stopping SPS30 measurement: %d", err);
+			return err;
+		}
+
+		k_sleep(SPS30_CMD_TIME);
+		data->state = SPS30_IDLE;
+	}
+
+	/* Sleep mode requires SPS30 firmware >= 2.0; the fan is already off */
+	err = sensirion_cmd_write(&cfg->i2c, SPS30_CMD_SLEEP, NULL, 0);
+	if (err) {
+		LOG_WRN("Error entering SPS30 sleep mode: %d", err);
+		return 0;
+	}
+
+	k_sleep(SPS30_SLEEP_TIME);
+	data->state = SPS30_SLEEPING;
+
+	return 0;
+}
+
+/* Must be called with the lock held */
+static int sps30_reset(const struct device *dev)
+{
+	const struct sps30_config *cfg = dev->config;
+	struct sps30_data *data = dev->data;
+	int err;
+
+	/* The sensor may have been left in sleep mode, where it only responds to wake-up */
+	sps30_wake_up(dev);
+
+	err = sensirion_cmd_write(&cfg->i2c, SPS30_CMD_RESET, NULL, 0);
+	if (err) {
+		LOG_ERR("SPS30 sensor reset failed: %d", err);
+		return err;
+	}
+
+	k_sleep(SPS30_RESET_TIME);
+
+	/* A reset leaves the sensor idle with the fan off */
+	data->state = SPS30_IDLE;
+
+	return 0;
+}
+
+/* Must be called with the lock held */
+static int sps30_read_and_accumulate(const struct device *dev)
+{
+	const struct sps30_config *cfg = dev->config;
+	struct sps30_data *data = dev->data;
+	uint16_t words[2 * SPS30_NUM_VALUES];
+	size_t num_words = cfg->uint16_format ? SPS30_NUM_VALUES : 2 * SPS30_NUM_VALUES;
+	uint32_t start = k_cycle_get_32();
+	uint32_t bus_cycles;
+	int err;
+
+	err = sensirion_cmd_read(&cfg->i2c, SPS30_CMD_READ_MEASURED_VALUES, K_NO_WAIT, words,
+				 num_words);
+
+	bus_cycles = k_cycle_get_32() - start;
+	data->bus_cycles_total += bus_cycles;
+	data->bus_cycles_max = MAX(data->bus_cycles_max, bus_cycles);
+
+	if (err) {
+		return err;
+	}
+
+	for (int i = 0; i < SPS30_NUM_VALUES; i++) {
+		if (cfg->uint16_format) {
+			data->sum_uint16[i] += words[i];
+		} else {
+			uint32_t bits = ((uint32_t)words[2 * i] << 16) | words[2 * i + 1];
+			float value;
+
+			memcpy(&value, &bits, sizeof(value));
+			data->sum_float[i] += value;
+		}
+	}
+
+	return 0;
+}
+
+/* Must be called with the lock held */
+static void sps30_average(const struct device *dev)
+{
+	const struct sps30_config *cfg = dev->config;
+	struct sps30_data *data = dev->data;
+
+	for (int i = 0; i < SPS30_NUM_VALUES; i++) {
+		if (cfg->uint16_format) {
+			/* Concentrations are read in whole units, particle size in nm */
+			uint64_t scale = (i == SPS30_TPS_INDEX) ? 1000 : 1000000;
+
+			data->sample.values[i] =
+				((uint64_t)data->sum_uint16[i] * scale + data->count / 2) /
+				data->count;
+		} else {
+			data->sample.values[i] =
+				(int64_t)((double)data->sum_float[i] / data->count * 1000000.0);
+		}
+	}
+}
+
+static void sps30_measure_complete(struct sps30_data *data, struct rtio_iodev_sqe *iodev_sqe,
+				   const struct sps30_encoded_data *sample, int result)
+{
+	uint8_t *buf;
+	uint32_t buf_len;
+
+	if (!iodev_sqe) {
+		data->result = result;
+		k_sem_give(&data->done);
+		return;
+	}
+
+	if (result == 0) {
+		result = rtio_sqe_rx_buf(iodev_sqe, sizeof(*sample), sizeof(*sample), &buf,
+					 &buf_len);
+	}
+
+	if (result) {
+		rtio_iodev_sqe_err(iodev_sqe, result);
+		return;
+	}
+
+	memcpy(buf, sample, sizeof(*sample));
+	rtio_iodev_sqe_ok(iodev_sqe, 0);
+}
+
+/* Collects one reading per second until the averaging window is complete */
+static void sps30_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct sps30_data *data = CONTAINER_OF(dwork, struct sps30_data, work);
+	const struct device *dev = data->dev;
+	const struct sps30_config *cfg = dev->config;
+	struct rtio_iodev_sqe *iodev_sqe;
+	struct sps30_encoded_data sample;
+	uint16_t data_ready;
+	int err;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	/* The measurement was aborted while this work item waited for the lock */
+	if (!data->busy) {
+		k_mutex_unlock(&data->lock);
+		return;
+	}
+
+	err = sensirion_cmd_read(&cfg->i2c, SPS30_CMD_READ_DATA_READY, K_NO_WAIT, &data_ready, 1);
+	if (!err && !(data_ready & 0x1)) {
+		if (++data->polls < SPS30_DATA_READY_POLLS) {
+			k_work_schedule_for_queue(&sensirion_work_q, &data->work,
+						  SPS30_DATA_READY_POLL_INTERVAL);
+			k_mutex_unlock(&data->lock);
+			return;
+		}
+
+		err = -ETIMEDOUT;
+	}
+
+	if (!err) {
+		err = sps30_read_and_accumulate(dev);
+	}
+
+	sensirion_trace("sps30_sample_wait", SENSIRION_TRACE_END, data->count);
+
+	if (!err && (++data->count < data->samples)) {
+		/* A new reading is available every second */
+		data->polls = 0;
+		k_work_schedule_for_queue(&sensirion_work_q, &data->work, SPS30_SAMPLE_INTERVAL);
+		sensirion_trace("sps30_sample_wait", SENSIRION_TRACE_BEGIN, data->count);
+		k_mutex_unlock(&data->lock);
+		return;
+	}
+
+	if (err) {
+		LOG_ERR("Error reading SPS30 measurement: %d", err);
+	} else {
+		data->sample.window_end_ns = k_ticks_to_ns_floor64(k_uptime_ticks());
+		sps30_average(dev);
+
+		LOG_DBG("SPS30 %s read bus time: avg %u us, max %u us",
+			cfg->uint16_format ? "uint16" : "float",
+			k_cyc_to_us_floor32(data->bus_cycles_total / data->count),
+			k_cyc_to_us_floor32(data->bus_cycles_max));
+	}
+
+	sample = data->sample;
+	iodev_sqe = data->iodev_sqe;
+	data->iodev_sqe = NULL;
+	data->busy = false;
+
+	k_mutex_unlock(&data->lock);
+
+	sps30_measure_complete(data, iodev_sqe, &sample, err);
+}
+
+static int sps30_measure_start(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe)
+{
+	struct sps30_data *data = dev->data;
+	int err = 0;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	if (data->busy) {
+		err = -EBUSY;
+	} else if (data->state != SPS30_MEASURING) {
+		/* Wake the sensor with SENSOR_ATTR_SPS30_SLEEP first */
+		err = -EAGAIN;
+	} else {
+		data->busy = true;
+		data->count = 0;
+		data->polls = 0;
+		data->bus_cycles_total = 0;
+		data->bus_cycles_max = 0;
+		memset(data->sum_float, 0, sizeof(data->sum_float));
+		memset(data->sum_uint16, 0, sizeof(data->sum_uint16));
+		data->sample.window_start_ns = k_ticks_to_ns_floor64(k_uptime_ticks());
+		data->iodev_sqe = iodev_sqe;
+		k_work_schedule_for_queue(&sensirion_work_q, &data->work, K_NO_WAIT);
+		sensirion_trace("sps30_sample_wait", SENSIRION_TRACE_BEGIN, 0);
+	}
+
+	k_mutex_unlock(&data->lock);
+
+	return err;
+}
+
+static int sps30_sample_fetch(const struct device *dev, enum sensor_channel chan)
+{
+	struct sps30_data *data = dev->data;
+	int err;
+
+	if ((chan != SENSOR_CHAN_ALL) && (sps30_channel_index(chan) < 0)) {
+		return -ENOTSUP;
+	}
+
+	/* Drop the completion of an earlier fetch that timed out */
+	k_sem_reset(&data->done);
+
+	err = sps30_measure_start(dev, NULL);
+	if (err) {
+		return err;
+	}
+
+	err = k_sem_take(&data->done, K_MSEC(data->samples * 1000 + SPS30_FETCH_MARGIN_MS));
+	if (err) {
+		LOG_ERR("SPS30 measurement timed out");
+		return -ETIMEDOUT;
+	}
+
+	return data->result;
+}
+
+static int sps30_channel_get(const struct device *dev, enum sensor_channel chan,
+			     struct sensor_value *val)
+{
+	struct sps30_data *data = dev->data;
+	int index = sps30_channel_index(chan);
+	int64_t micro;
+
+	if (index < 0) {
+		return index;
+	}
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+	micro = data->sample.values[index];
+	k_mutex_unlock(&data->lock);
+
+	return sensor_value_from_micro(val, micro);
+}
+
+static int sps30_attr_set(const struct device *dev, enum sensor_channel chan,
+			  enum sensor_attribute attr, const struct sensor_value *val)
+{
+	const struct sps30_config *cfg = dev->config;
+	struct sps30_data *data = dev->data;
+	struct rtio_iodev_sqe *iodev_sqe = NULL;
+	struct sps30_encoded_data sample;
+	bool aborted = false;
+	uint16_t interval[2];
+	int err;
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	if (data->busy && ((int)attr == SENSOR_ATTR_SPS30_RESET)) {
+		/* Abort the measurement in progress, which completes with -ECANCELED */
+		k_work_cancel_delayable(&data->work);
+		aborted = true;
+		iodev_sqe = data->iodev_sqe;
+		sample = data->sample;
+		data->iodev_sqe = NULL;
+		data->busy = false;
+		sensirion_trace("sps30_sample_wait", SENSIRION_TRACE_END, data->count);
+	} else if (data->busy) {
+		k_mutex_unlock(&data->lock);
+		return -EBUSY;
+	}
+
+	switch ((int)attr) {
+	case SENSOR_ATTR_SPS30_SAMPLES:
+		if (val->val1 < 1) {
+			err = -EINVAL;
+			break;
+		}
+		data->samples = val->val1;
+		err = 0;
+		break;
+	case SENSOR_ATTR_SPS30_SLEEP:
+		err = val->val1 ? sps30_sleep(dev) : sps30_wake(dev);
+		break;
+	case SENSOR_ATTR_SPS30_FAN_CLEAN:
+		/* Fan cleaning is only possible in measurement mode */
+		if (data->state != SPS30_MEASURING) {
+			err = -EAGAIN;
+			break;
+		}
+		err = sensirion_cmd_write(&cfg->i2c, SPS30_CMD_START_FAN_CLEANING, NULL, 0);
+		break;
+	case SENSOR_ATTR_SPS30_AUTO_CLEANING_INTERVAL:
+		/* The sensor does not accept commands other than wake-up while sleeping */
+		if (data->state == SPS30_SLEEPING) {
+			err = -EAGAIN;
+			break;
+		}
+		interval[0] = (uint16_t)((uint32_t)val->val1 >> 16);
+		interval[1] = (uint16_t)((uint32_t)val->val1 & 0xFFFF);
+		err = sensirion_cmd_write(&cfg->i2c, SPS30_CMD_AUTO_CLEANING_INTERVAL, interval,
+					  ARRAY_SIZE(interval));
+		k_sleep(SPS30_CMD_TIME);
+		break;
+	case SENSOR_ATTR_SPS30_RESET:
+		err = sps30_reset(dev);
+		break;
+	default:
+		err = -ENOTSUP;
+		break;
+	}
+
+	k_mutex_unlock(&data->lock);
+
+	if (aborted) {
+		sps30_measure_complete(data, iodev_sqe, &sample, -ECANCELED);
+	}
+
+	return err;
+}
+
+uint64_t sps30_encoded_window_start_ns(const uint8_t *buf)
+{
+	return ((const struct sps30_encoded_data *)buf)->window_start_ns;
+}
+
+#ifdef CONFIG_SENSOR_ASYNC_API
+
+static void sps30_submit(const struct device *dev, struct rtio_iodev_sqe *iodev_sqe)
+{
+	int err = sps30_measure_start(dev, iodev_sqe);
+
+	if (err) {
+		rtio_iodev_sqe_err(iodev_sqe, err);
+	}
+}
+
+static int sps30_decoder_get_frame_count(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+					 uint16_t *frame_count)
+{
+	if ((chan_spec.chan_idx != 0) || (sps30_channel_index(chan_spec.chan_type) < 0)) {
+		return -ENOTSUP;
+	}
+
+	*frame_count = 1;
+
+	return 0;
+}
+
+static int sps30_decoder_get_size_info(struct sensor_chan_spec chan_spec, size_t *base_size,
+				       size_t *frame_size)
+{
+	if (sps30_channel_index(chan_spec.chan_type) < 0) {
+		return -ENOTSUP;
+	}
+
+	*base_size = sizeof(struct sensor_q31_data);
+	*frame_size = sizeof(struct sensor_q31_sample_data);
+
+	return 0;
+}
+
+static int sps30_decoder_decode(const uint8_t *buffer, struct sensor_chan_spec chan_spec,
+				uint32_t *fit, uint16_t max_count, void *data_out)
+{
+	const struct sps30_encoded_data *edata = (const struct sps30_encoded_data *)buffer;
+	int index = sps30_channel_index(chan_spec.chan_type);
+
+	if ((*fit != 0) || (max_count == 0)) {
+		return 0;
+	}
+
+	if ((index < 0) || (chan_spec.chan_idx != 0)) {
+		return -ENOTSUP;
+	}
+
+	/* Readings are timestamped at the end of the averaging window */
+	sensirion_q31_from_micro(data_out, edata->window_end_ns, edata->values[index]);
+	*fit = 1;
+
+	return 1;
+}
+
+SENSOR_DECODER_API_DT_DEFINE() = {
+	.get_frame_count = sps30_decoder_get_frame_count,
+	.get_size_info = sps30_decoder_get_size_info,
+	.decode = sps30_decoder_decode,
+};
+
+static int sps30_get_decoder(const struct device *dev, const struct sensor_decoder_api **decoder)
+{
+	*decoder = &SENSOR_DECODER_NAME();
+
+	return 0;
+}
+
+#endif /* CONFIG_SENSOR_ASYNC_API */
+
+static const struct sensor_driver_api sps30_api = {
+	.sample_fetch = sps30_sample_fetch,
+	.channel_get = sps30_channel_get,
+	.attr_set = sps30_attr_set,
+#ifdef CONFIG_SENSOR_ASYNC_API
+	.submit = sps30_submit,
+	.get_decoder = sps30_get_decoder,
+#endif
+};
+
+static int sps30_init(const struct device *dev)
+{
+	const struct sps30_config *cfg = dev->config;
+	struct sps30_data *data = dev->data;
+	uint16_t version;
+	uint16_t serial[SPS30_SERIAL_WORDS];
+	char serial_number[2 * SPS30_SERIAL_WORDS + 1];
+	int err;
+
+	if (!i2c_is_ready_dt(&cfg->i2c)) {
+		LOG_ERR("Bus %s is not ready", cfg->i2c.bus->name);
+		return -ENODEV;
+	}
+
+	data->dev = dev;
+	data->samples = 1;
+	k_mutex_init(&data->lock);
+	k_sem_init(&data->done, 0, 1);
+	k_work_init_delayable(&data->work, sps30_work_handler);
+
+	k_mutex_lock(&data->lock, K_FOREVER);
+
+	err = sps30_reset(dev);
+	if (err) {
+		k_mutex_unlock(&data->lock);
+		return err;
+	}
+
+	for (int tries = 0; tries < SPS30_PROBE_TRIES; tries++) {
+		err = sensirion_cmd_read(&cfg->i2c, SPS30_CMD_READ_FIRMWARE_VERSION, K_NO_WAIT,
+					 &version, 1);
+		if (err == 0) {
+			break;
+		}
+
+		k_sleep(SPS30_PROBE_INTERVAL);
+	}
+
+	if (err) {
+		LOG_ERR("SPS30 sensor probing failed: %d", err);
+		k_mutex_unlock(&data->lock);
+		return err;
+	}
+
+	LOG_DBG("SPS30 firmware version: %u.%u", version >> 8, version & 0xFF);
+
+	if (cfg->uint16_format && ((version >> 8) < 2)) {
+		LOG_WRN("SPS30 uint16 output format requires firmware 2.0 or later");
+	}
+
+	err = sensirion_cmd_read(&cfg->i2c, SPS30_CMD_READ_SERIAL_NUMBER, K_NO_WAIT, serial,
+				 ARRAY_SIZE(serial));
+	if (err) {
+		LOG_ERR("Error reading SPS30 serial number: %d", err);
+		k_mutex_unlock(&data->lock);
+		return err;
+	}
+
+	for (int i = 0; i < SPS30_SERIAL_WORDS; i++) {
+		serial_number[2 * i] = serial[i] >> 8;
+		serial_number[2 * i + 1] = serial[i] & 0xFF;
+	}
+	serial_number[sizeof(serial_number) - 1] = '\0';
+
+	LOG_DBG("SPS30 serial number: %s", serial_number);
+
+	k_mutex_unlock(&data->lock);
+
+	return 0;
+}
+
+#define SPS30_DEFINE(inst)                                                                         \
+	static struct sps30_data sps30_data_##inst;                                                \
+                                                                                                   \
+	static const struct sps30_config sps30_config_##inst = {                                   \
+		.i2c = I2C_DT_SPEC_INST_GET(inst),                                                 \
+		.uint16_format = DT_INST_ENUM_IDX(inst, output_format) == 1,                       \
+	};                                                                                         \
+                                                                                                   \
+	SENSOR_DEVICE_DT_INST_DEFINE(inst, sps30_init, NULL, &sps30_data_##inst,                  \
+				     &sps30_config_##inst, POST_KERNEL,                            \
+				     CONFIG_SENSOR_INIT_PRIORITY, &sps30_api);
+
+DT_INST_FOREACH_STATUS_OKAY(SPS30_DEFINE)
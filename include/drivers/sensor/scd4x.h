@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Extended attributes of the Sensirion SCD4x CO2 sensor driver.
+ *
+ * The driver provides SENSOR_CHAN_CO2, SENSOR_CHAN_AMBIENT_TEMP and
+ * SENSOR_CHAN_HUMIDITY through both sensor_sample_fetch() and
+ * sensor_read_async().
+ */
+
+#ifndef __DRIVERS_SENSOR_SCD4X_H__
+#define __DRIVERS_SENSOR_SCD4X_H__
+
+#include <zephyr/drivers/sensor.h>
+
+/* Longest a measurement takes before the driver gives up: the single shot plus data-ready polls */
+#define SCD4X_MEASURE_MAX_MS 10000
+
+/* Largest temperature offset the sensor takes, in m°C. Negative offsets are rejected. */
+#define SCD4X_TEMPERATURE_OFFSET_MAX_MILLI 174999
+
+enum sensor_attribute_scd4x {
+	/* Temperature offset in °C */
+	SENSOR_ATTR_SCD4X_TEMPERATURE_OFFSET = SENSOR_ATTR_PRIV_START,
+	/* Sensor altitude above sea level in meters */
+	SENSOR_ATTR_SCD4X_ALTITUDE,
+	/* Automatic self-calibration, 0 to disable or 1 to enable */
+	SENSOR_ATTR_SCD4X_AUTOMATIC_SELF_CALIBRATION,
+	/* Abort a measurement in progress and reinitialize the sensor to its default state */
+	SENSOR_ATTR_SCD4X_REINIT,
+};
+
+#endif /* __DRIVERS_SENSOR_SCD4X_H__ */
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Extended channels and attributes of the Sensirion SPS30 particulate matter
+ * sensor driver.
+ *
+ * Every fetch averages SENSOR_ATTR_SPS30_SAMPLES readings taken one second
+ * apart. Mass concentrations are in µg/m³, number concentrations in #/cm³ and
+ * the typical particle size in µm. Readings decoded from sensor_read_async()
+ * are timestamped at the end of the averaging window; the start of the window
+ * is available from sps30_encoded_window_start_ns().
+ */
+
+#ifndef __DRIVERS_SENSOR_SPS30_H__
+#define __DRIVERS_SENSOR_SPS30_H__
+
+#include <stdint.h>
+#include <zephyr/drivers/sensor.h>
+
+/* PM1.0, PM2.5 and PM10 mass concentrations use the standard SENSOR_CHAN_PM_* channels */
+enum sensor_channel_sps30 {
+	SENSOR_CHAN_SPS30_MC_4P0 = SENSOR_CHAN_PRIV_START,
+	SENSOR_CHAN_SPS30_NC_0P5,
+	SENSOR_CHAN_SPS30_NC_1P0,
+	SENSOR_CHAN_SPS30_NC_2P5,
+	SENSOR_CHAN_SPS30_NC_4P0,
+	SENSOR_CHAN_SPS30_NC_10P0,
+	SENSOR_CHAN_SPS30_TYPICAL_PARTICLE_SIZE,
+};
+
+enum sensor_attribute_sps30 {
+	/* Number of one-second readings averaged by each fetch */
+	SENSOR_ATTR_SPS30_SAMPLES = SENSOR_ATTR_PRIV_START,
+	/* 1 to stop measuring and sleep with the fan off, 0 to wake up and start measuring */
+	SENSOR_ATTR_SPS30_SLEEP,
+	/* Start a manual fan cleaning, which takes about 10 seconds */
+	SENSOR_ATTR_SPS30_FAN_CLEAN,
+	/* Automatic fan cleaning interval in seconds */
+	SENSOR_ATTR_SPS30_AUTO_CLEANING_INTERVAL,
+	/* Reset the sensor, leaving it idle. A fetch in progress completes with -ECANCELED. */
+	SENSOR_ATTR_SPS30_RESET,
+};
+
+/* Uptime in ns at the start of the averaging window of an encoded reading */
+uint64_t sps30_encoded_window_start_ns(const uint8_t *buf);
+
+#endif /* __DRIVERS_SENSOR_SPS30_H__ */
@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 Golioth, Inc.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Local CoAP/DTLS stand-in for the Golioth cloud, for uplink benchmarks.
+
+Usage:
+    coap_standin.py [--bind ADDR] [--port PORT] [--psk-id ID] [--psk PSK]
+                    [--no-dtls] [--settings FILE] [--interval S]
+
+Every request is acknowledged as soon as it arrives, so the numbers reflect
+the device and the link rather than a backend:
+
+    .s/<path>     LightDB Stream, counted per record ("sensor_batch" payloads
+                  count every record of the batch)
+    .d/<path>     LightDB State, kept in memory and observable
+    .c            Settings, served from FILE (a JSON object of key/value pairs)
+    .rpc          Remote procedure calls, observable but never called
+    anything else (settings and RPC status, logs, OTA) is accepted and counted
+
+Request, record and byte rates per service are printed every interval and as
+a summary on exit. Needs aiocoap with its tinydtls transport
+(pip install "aiocoap[tinydtls]") and cbor2.
+"""
+
+import argparse
+import asyncio
+import collections
+import json
+import time
+
+import aiocoap
+import aiocoap.interfaces as interfaces
+import aiocoap.resource as resource
+import cbor2
+
+CONTENT_FORMAT_JSON = 50
+CONTENT_FORMAT_CBOR = 60
+BATCH_PATH = "sensor_batch"
+
+
+class Counters:
+    def __init__(self):
+        self.requests = collections.Counter()
+        self.bytes = collections.Counter()
+        self.records = 0
+
+    def copy(self):
+        other = Counters()
+        other.requests = self.requests.copy()
+        other.bytes = self.bytes.copy()
+        other.records = self.records
+        return other
+
+
+def _records(path, request):
+    """Number of records carried by one stream payload."""
+    if path[-1:] == [BATCH_PATH] and request.opt.content_format == CONTENT_FORMAT_CBOR:
+        try:
+            return cbor2.loads(request.payload).get("n", 1)
+        except (ValueError, AttributeError, cbor2.CBORDecodeError):
+            return 1
+    return 1
+
+
+def _encode(value, accept):
+    if accept == CONTENT_FORMAT_JSON:
+        return json.dumps(value).encode(), CONTENT_FORMAT_JSON
+    return cbor2.dumps(value), CONTENT_FORMAT_CBOR
+
+
+class StandIn(resource.Resource, interfaces.ObservableResource):
+    """Serves every path itself, so it is used as the whole site."""
+
+    def __init__(self, settings, counters):
+        super().__init__()
+        self.settings = settings
+        self.settings_version = int(time.time())
+        self.state = {}
+        self.observers = collections.defaultdict(set)
+        self.counters = counters
+
+    async def needs_blockwise_assembly(self, request):
+        return True
+
+    async def add_observation(self, request, serverobservation):
+        key = "/".join(request.opt.uri_path)
+        self.observers[key].add(serverobservation)
+        serverobservation.accept(lambda: self.observers[key].discard(serverobservation))
+
+    async def render(self, request):
+        path = list(request.opt.uri_path)
+        service = path[0] if path else ""
+
+        self.counters.requests[service] += 1
+        self.counters.bytes[service] += len(request.payload)
+
+        if service == ".s":
+            self.counters.records += _records(path, request)
+        elif service == ".d":
+            return self._state("/".join(path[1:]), request)
+        elif (service == ".c") and (len(path) == 1) and (request.code == aiocoap.GET):
+            payload, content_format = _encode(
+                {"version": self.settings_version, "settings": self.settings}, request.opt.accept
+            )
+            return aiocoap.Message(
+                code=aiocoap.CONTENT, payload=payload, content_format=content_format
+            )
+        elif request.code == aiocoap.GET:
+            return aiocoap.Message(code=aiocoap.CONTENT, payload=b"")
+
+        return aiocoap.Message(code=aiocoap.CHANGED)
+
+    def _state_response(self, key, accept):
+        if key in self.state:
+            content_format, payload = self.state[key]
+            return aiocoap.Message(
+                code=aiocoap.CONTENT, payload=payload, content_format=content_format
+            )
+
+        payload, content_format = _encode(None, accept)
+        return aiocoap.Message(code=aiocoap.CONTENT, payload=payload, content_format=content_format)
+
+    def _state(self, key, request):
+        if request.code == aiocoap.GET:
+            return self._state_response(key, request.opt.accept)
+
+        if request.code == aiocoap.DELETE:
+            self.state.pop(key, None)
+            code = aiocoap.DELETED
+        else:
+            self.state[key] = (request.opt.content_format, request.payload)
+            code = aiocoap.CHANGED
+
+        for observation in list(self.observers.get(".d/" + key, ())):
+            observation.trigger(self._state_response(key, request.opt.content_format))
+
+        return aiocoap.Message(code=code)
+
+
+def _print_rates(label, now, last, seconds):
+    services = sorted(set(now.requests) | set(last.requests))
+    parts = []
+    for service in services:
+        requests = now.requests[service] - last.requests[service]
+        if requests:
+            data = now.bytes[service] - last.bytes[service]
+            parts.append(f"{service or '/'} {requests / seconds:.1f} req/s "
+                         f"{data / seconds:.0f} B/s")
+    records = now.records - last.records
+    print(f"{label}: {records / seconds:.1f} records/s; " + ("; ".join(parts) or "idle"),
+          flush=True)
+
+
+async def _report(counters, interval):
+    last = counters.copy()
+    while True:
+        await asyncio.sleep(interval)
+        now = counters.copy()
+        _print_rates(f"last {interval} s", now, last, interval)
+        last = now
+
+
+async def serve(args, counters):
+    settings = {}
+    if args.settings:
+        with open(args.settings) as f:
+            settings = json.load(f)
+
+    site = StandIn(settings, counters)
+
+    if args.no_dtls:
+        transports = ["udp6"]
+        port = args.port or aiocoap.COAP_PORT
+    else:
+        transports = ["tinydtls_server"]
+        port = args.port or aiocoap.COAPS_PORT
+
+    context = await aiocoap.Context.create_server_context(
+        site, bind=(args.bind, port), transports=transports
+    )
+
+    if not args.no_dtls:
+        context.server_credentials.load_from_dict({
+            ":standin": {"dtls": {"client-identity": {"ascii": args.psk_id},
+                                  "psk": {"ascii": args.psk}}},
+        })
+
+    print(f"Listening on {args.bind} port {port} "
+          f"({'CoAP' if args.no_dtls else 'CoAP over DTLS, PSK ID ' + args.psk_id})",
+          flush=True)
+
+    try:
+        await _report(counters, args.interval)
+    finally:
+        await context.shutdown()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--bind", default="::", help="address to listen on")
+    parser.add_argument("--port", type=int, help="port (5684 with DTLS, 5683 without)")
+    parser.add_argument("--psk-id", default="standin@benchmark")
+    parser.add_argument("--psk", default="standin-psk")
+    parser.add_argument("--no-dtls", action="store_true", help="serve plain CoAP")
+    parser.add_argument("--settings", help="JSON file with the device settings to serve")
+    parser.add_argument("--interval", type=int, default=10, help="report interval in seconds")
+    args = parser.parse_args()
+
+    counters = Counters()
+    start = time.monotonic()
+
+    try:
+        asyncio.run(serve(args, counters))
+    except KeyboardInterrupt:
+        pass
+
+    _print_rates("total", counters, Counters(), max(time.monotonic() - start, 1))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025 Golioth, Inc.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Expand a columnar sensor batch (see src/batch_encoder.h) into records.
+
+Usage:
+    decode_batch.py [FILE ...]
+
+Each FILE (or stdin) holds one raw CBOR batch as sent to the "sensor_batch"
+stream path. The decoded records are printed as a JSON array. The decode()
+function can be imported by a backend that receives batches from a pipeline
+webhook.
+"""
+
+import argparse
+import json
+import sys
+from datetime import datetime, timezone
+
+import cbor2
+
+SUPPORTED_VERSIONS = (1, 2)
+TIME_COLUMNS = ("time", "win_start", "win_end")
+RESERVED_KEYS = ("v", "n") + TIME_COLUMNS
+
+
+def _varints(data):
+    value = 0
+    shift = 0
+    for byte in data:
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            yield value
+            value = 0
+            shift = 0
+    if shift:
+        raise ValueError("truncated varint")
+
+
+def _zigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def _expand(column, count):
+    values = [column["b"]]
+    for delta in _varints(column["d"]):
+        values.append(values[-1] + _zigzag(delta))
+    if len(values) != count:
+        raise ValueError(f"expected {count} values, got {len(values)}")
+    return values
+
+
+def _present(column, count):
+    """Indices of the records holding a value of a channel column."""
+    if "p" not in column:
+        return list(range(count))
+    bitmap = column["p"]
+    return [i for i in range(count) if bitmap[i // 8] & (1 << (i % 8))]
+
+
+def _scale(value, exponent):
+    if exponent >= 0:
+        return value * 10**exponent
+    return round(value * 10**exponent, -exponent)
+
+
+def _rfc3339(unix_ms):
+    stamp = datetime.fromtimestamp(unix_ms / 1000, tz=timezone.utc)
+    return stamp.isoformat(timespec="milliseconds").replace("+00:00", "Z")
+
+
+def decode(payload):
+    """Decode one CBOR batch into a list of record dicts."""
+    batch = cbor2.loads(payload)
+
+    if batch.get("v") not in SUPPORTED_VERSIONS:
+        raise ValueError(f"unsupported batch version: {batch.get('v')}")
+
+    count = batch["n"]
+    records = [{} for _ in range(count)]
+
+    for name in TIME_COLUMNS:
+        if name not in batch:
+            continue
+        for record, unix_ms in zip(records, _expand(batch[name], count)):
+            record[name] = _rfc3339(unix_ms) if name == "time" else unix_ms
+
+    for name, column in batch.items():
+        if name in RESERVED_KEYS:
+            continue
+        exponent = column.get("e", 0)
+        present = _present(column, count)
+        for index, value in zip(present, _expand(column, len(present))):
+            records[index][name] = _scale(value, exponent)
+
+    return records
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("files", nargs="*", type=argparse.FileType("rb"),
+                        default=[sys.stdin.buffer])
+    args = parser.parse_args()
+
+    records = []
+    for f in args.files:
+        records.extend(decode(f.read()))
+
+    json.dump(records, sys.stdout, indent=2)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()
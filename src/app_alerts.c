@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_alerts, LOG_LEVEL_DBG);
+
+#include <golioth/client.h>
+#include <golioth/lightdb_state.h>
+#include <zephyr/kernel.h>
+
+#include "app_alerts.h"
+#include "app_settings.h"
+#include "app_time.h"
+#include "payload_pool.h"
+#include "stream_queue.h"
+
+/* Longest value of a channel formatted as a decimal string */
+#define VALUE_BUF_SIZE 16
+
+/* Every channel flag, e.g. {"co2":true,"mc_2p5":false} */
+#define STATE_BUF_SIZE 64
+
+struct alert_rule {
+	enum sensor_record_channel channel;
+	/* Offsets in struct app_settings of the threshold and hysteresis, in whole units */
+	size_t threshold;
+	size_t hysteresis;
+	bool active;
+};
+
+#define ALERT_RULE(_channel, _threshold, _hysteresis)                                              \
+	{                                                                                          \
+		.channel = _channel,                                                               \
+		.threshold = offsetof(struct app_settings, _threshold),                            \
+		.hysteresis = offsetof(struct app_settings, _hysteresis),                          \
+	}
+
+static struct alert_rule rules[] = {
+#ifdef CONFIG_APP_SENSOR_SCD4X
+	ALERT_RULE(SENSOR_CH_CO2, alert_co2_ppm, alert_co2_hysteresis_ppm),
+#endif
+#ifdef CONFIG_APP_SENSOR_SPS30
+	ALERT_RULE(SENSOR_CH_MC_2P5, alert_pm2p5_ugm3, alert_pm2p5_hysteresis_ugm3),
+#endif
+};
+
+static struct golioth_client *client;
+
+/* Set while the LightDB State flags may not match the rules */
+static atomic_t state_dirty = ATOMIC_INIT(1);
+
+static struct {
+	uint32_t raised;
+	uint32_t cleared;
+	uint32_t latency_last_ms;
+	uint32_t latency_max_ms;
+	uint64_t latency_sum_ms;
+} stats;
+K_MUTEX_DEFINE(stats_mutex);
+
+/* Convert whole units to the fixed-point representation of a channel */
+static int32_t whole_to_fixed(int32_t whole, int8_t exponent)
+{
+	for (int i = exponent; i < 0; i++) {
+		whole *= 10;
+	}
+
+	return whole;
+}
+
+static void state_async_handler(struct golioth_client *client, enum golioth_status status,
+				const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
+				void *arg)
+{
+	if (status != GOLIOTH_OK) {
+		LOG_WRN("Failed to set alert state: %d", status);
+		atomic_set(&state_dirty, 1);
+		return;
+	}
+
+	LOG_DBG("Alert state successfully set");
+}
+
+static void state_update(void)
+{
+	char sbuf[STATE_BUF_SIZE];
+	size_t pos = 0;
+	int err;
+
+	if (!client || !golioth_client_is_connected(client)) {
+		/* Still dirty, sent with the first check after connecting */
+		return;
+	}
+
+	/* Cleared first so that a failure reported meanwhile is not lost */
+	atomic_set(&state_dirty, 0);
+
+	for (size_t i = 0; i < ARRAY_SIZE(rules); i++) {
+		pos += snprintk(&sbuf[pos], sizeof(sbuf) - pos, "%s\"%s\":%s", (i > 0) ? "," : "{",
+				sensor_record_channels[rules[i].channel].name,
+				rules[i].active ? "true" : "false");
+	}
+	snprintk(&sbuf[pos], sizeof(sbuf) - pos, "}");
+
+	err = golioth_lightdb_set_async(client,
+					APP_ALERTS_STATE_ENDP,
+					GOLIOTH_CONTENT_TYPE_JSON,
+					sbuf,
+					strlen(sbuf),
+					state_async_handler,
+					NULL);
+	if (err) {
+		LOG_ERR("Unable to write alert state to LightDB State: %d", err);
+		atomic_set(&state_dirty, 1);
+	}
+}
+
+static void latency_record(uint32_t latency_ms, bool raised)
+{
+	k_mutex_lock(&stats_mutex, K_FOREVER);
+
+	if (raised) {
+		stats.raised++;
+	} else {
+		stats.cleared++;
+	}
+
+	stats.latency_last_ms = latency_ms;
+	stats.latency_max_ms = MAX(stats.latency_max_ms, latency_ms);
+	stats.latency_sum_ms += latency_ms;
+
+	k_mutex_unlock(&stats_mutex);
+}
+
+static void alert_send(const struct alert_rule *rule, const struct sensor_record *record,
+		       const struct app_settings *settings)
+{
+	const struct sensor_record_channel_info *ch = &sensor_record_channels[rule->channel];
+	char rfc3339[APP_TIME_RFC3339_LEN] = "";
+	char value[VALUE_BUF_SIZE];
+	struct payload_buf *buf;
+	int64_t sample_unix_ms;
+	uint32_t latency_ms;
+
+	/* Alerts take a queued reading's buffer rather than being dropped */
+	buf = payload_pool_alloc();
+	if (!buf) {
+		buf = stream_queue_reclaim_oldest();
+	}
+
+	if (!buf) {
+		LOG_ERR("No free payload buffer. Alert will not be sent.");
+		return;
+	}
+
+	sensor_record_format_value(value, sizeof(value), record->values[rule->channel],
+				   ch->exponent);
+
+	if (app_time_uptime_to_unix_ms(record->sample_ms, &sample_unix_ms) == 0) {
+		app_time_format_rfc3339(sample_unix_ms, rfc3339, sizeof(rfc3339));
+	}
+
+	snprintk((char *)buf->data, sizeof(buf->data),
+		 "{%s%s%s\"channel\":\"%s\",\"alert\":%s,\"value\":%s,\"threshold\":%d,"
+		 "\"latency_ms\":%u}",
+		 rfc3339[0] ? "\"time\":\"" : "", rfc3339, rfc3339[0] ? "\"," : "", ch->name,
+		 rule->active ? "true" : "false", value,
+		 app_settings_s32(settings, rule->threshold),
+		 (uint32_t)(k_uptime_get() - record->sample_ms));
+
+	buf->path = "alert";
+	buf->content_type = GOLIOTH_CONTENT_TYPE_JSON;
+	buf->sample_ms = record->sample_ms;
+	buf->urgent = true;
+	buf->len = strlen((char *)buf->data);
+
+	stream_queue_send(buf);
+
+	latency_ms = (uint32_t)(k_uptime_get() - record->sample_ms);
+	latency_record(latency_ms, rule->active);
+
+	LOG_WRN("%s alert %s at %s %s (%u ms after acquisition)", ch->label,
+		rule->active ? "raised" : "cleared", value, ch->unit, latency_ms);
+}
+
+void app_alerts_check(const struct sensor_record *record)
+{
+	struct app_settings settings;
+	bool changed = false;
+
+	/* One copy, so that a threshold is always paired with its own hysteresis */
+	app_settings_get(&settings);
+
+	for (size_t i = 0; i < ARRAY_SIZE(rules); i++) {
+		struct alert_rule *rule = &rules[i];
+		int8_t exponent = sensor_record_channels[rule->channel].exponent;
+		int32_t value = record->values[rule->channel];
+		int32_t threshold = app_settings_s32(&settings, rule->threshold);
+		int32_t clear;
+
+		if (threshold == 0) {
+			/* Disabled; clear silently so the next enable starts fresh */
+			changed |= rule->active;
+			rule->active = false;
+			continue;
+		}
+
+		clear = whole_to_fixed(threshold - app_settings_s32(&settings, rule->hysteresis),
+				       exponent);
+		threshold = whole_to_fixed(threshold, exponent);
+
+		if (!rule->active && (value >= threshold)) {
+			rule->active = true;
+		} else if (rule->active && (value < clear)) {
+			rule->active = false;
+		} else {
+			continue;
+		}
+
+		alert_send(rule, record, &settings);
+		changed = true;
+	}
+
+	if (changed) {
+		atomic_set(&state_dirty, 1);
+	}
+
+	if (atomic_get(&state_dirty)) {
+		state_update();
+	}
+}
+
+void app_alerts_set_client(struct golioth_client *alerts_client)
+{
+	client = alerts_client;
+}
+
+void app_alerts_connected(void)
+{
+	/* The write may have been lost with the previous connection */
+	atomic_set(&state_dirty, 1);
+}
+
+void app_alerts_stats_get(struct app_alerts_stats *out)
+{
+	uint32_t sent;
+
+	k_mutex_lock(&stats_mutex, K_FOREVER);
+	sent = stats.raised + stats.cleared;
+	out->raised = stats.raised;
+	out->cleared = stats.cleared;
+	out->latency_last_ms = stats.latency_last_ms;
+	out->latency_max_ms = stats.latency_max_ms;
+	out->latency_avg_ms = sent ? (uint32_t)(stats.latency_sum_ms / sent) : 0;
+	k_mutex_unlock(&stats_mutex);
+}
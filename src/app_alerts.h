@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Threshold alerts on CO₂ and PM2.5.
+ *
+ * Every record is checked as soon as it has been acquired, before it is
+ * batched or streamed. An alert is raised when a channel reaches its threshold
+ * and cleared when it falls below the threshold minus the hysteresis; both
+ * thresholds are Golioth settings. Each change is sent right away as an
+ * urgent payload to the "alert" stream path, and the "alert" LightDB State
+ * endpoint holds one flag per channel. The flags are written again with the
+ * next check after a failed write or a reconnect.
+ *
+ * The latency from acquisition to enqueueing the alert is measured.
+ */
+
+#ifndef __APP_ALERTS_H__
+#define __APP_ALERTS_H__
+
+#include <stdint.h>
+#include <golioth/client.h>
+
+#include "sensor_record.h"
+
+#define APP_ALERTS_STATE_ENDP "alert"
+
+struct app_alerts_stats {
+	uint32_t raised;
+	uint32_t cleared;
+	/* Acquisition to enqueue */
+	uint32_t latency_last_ms;
+	uint32_t latency_max_ms;
+	uint32_t latency_avg_ms;
+};
+
+void app_alerts_set_client(struct golioth_client *alerts_client);
+void app_alerts_check(const struct sensor_record *record);
+/* Rewrite the LightDB State flags with the next check */
+void app_alerts_connected(void);
+void app_alerts_stats_get(struct app_alerts_stats *stats);
+
+#endif /* __APP_ALERTS_H__ */
@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_dfu, LOG_LEVEL_DBG);
+
+#include <errno.h>
+#include <string.h>
+#include <golioth/client.h>
+#include <golioth/fw_update.h>
+#include <golioth/lightdb_state.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log_backend.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/sys/atomic.h>
+
+#ifdef CONFIG_MCUBOOT_IMG_MANAGER
+#include <zephyr/dfu/mcuboot.h>
+#include <zephyr/storage/flash_map.h>
+#if USE_PARTITION_MANAGER
+#include <pm_config.h>
+#define SECONDARY_AREA_ID PM_MCUBOOT_SECONDARY_ID
+#else
+#define SECONDARY_AREA_ID FIXED_PARTITION_ID(slot1_partition)
+#endif
+#endif /* CONFIG_MCUBOOT_IMG_MANAGER */
+
+#include "app_dfu.h"
+#include "log_backend_remote.h"
+#include "stream_queue.h"
+
+/*
+ * e.g. {"bytes":412345,"duration_ms":812345,"bps":507,"priority":true,
+ *       "baseline_bps":463,"priority_bps":507}
+ */
+#define STATE_BUF_SIZE 160
+
+/* Subtree of the Zephyr settings holding the download rates */
+#define RATES_SETTINGS_KEY "app_dfu"
+
+/* Name given to the Golioth SDK's log backend by LOG_BACKEND_DEFINE() */
+#define GOLIOTH_LOG_BACKEND_NAME "log_backend_golioth"
+
+static struct golioth_client *client;
+static atomic_t priority;
+
+/* Only touched by the firmware update thread */
+static int64_t download_start_ms = -1;
+
+enum download_rate {
+	RATE_BASELINE,
+	RATE_PRIORITY,
+	RATE_COUNT,
+};
+
+static const char *const rate_names[RATE_COUNT] = {
+	[RATE_BASELINE] = "baseline_bps",
+	[RATE_PRIORITY] = "priority_bps",
+};
+
+/*
+ * B/s of the last download with telemetry running and paused, or 0 if none
+ * completed yet. Kept in the settings subsystem so that a download by a
+ * build without APP_DFU_PRIORITY is the baseline of the next image.
+ */
+static uint32_t rates[RATE_COUNT];
+
+static int rates_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	const char *next;
+	ssize_t ret;
+
+	for (size_t i = 0; i < RATE_COUNT; i++) {
+		if (!settings_name_steq(name, rate_names[i], &next) || next) {
+			continue;
+		}
+
+		if (len != sizeof(rates[i])) {
+			return -EINVAL;
+		}
+
+		ret = read_cb(cb_arg, &rates[i], sizeof(rates[i]));
+		return (ret < 0) ? ret : 0;
+	}
+
+	return -ENOENT;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(app_dfu, RATES_SETTINGS_KEY, NULL, rates_set, NULL, NULL);
+
+static void rate_save(enum download_rate rate, uint32_t bps)
+{
+	char key[SETTINGS_MAX_NAME_LEN + 1];
+	int err;
+
+	rates[rate] = bps;
+
+	snprintk(key, sizeof(key), RATES_SETTINGS_KEY "/%s", rate_names[rate]);
+	err = settings_save_one(key, &bps, sizeof(bps));
+	if (err) {
+		LOG_WRN("Unable to save the download rate: %d", err);
+	}
+}
+
+static void state_async_handler(struct golioth_client *client, enum golioth_status status,
+				const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
+				void *arg)
+{
+	if (status != GOLIOTH_OK) {
+		LOG_WRN("Failed to set DFU state: %d", status);
+		return;
+	}
+
+	LOG_DBG("DFU state successfully set");
+}
+
+#ifdef CONFIG_LOG_BACKEND_GOLIOTH
+static bool golioth_log_was_active;
+
+/* Messages logged while the backend is inactive are not sent later */
+static void golioth_log_pause(bool pause)
+{
+	const struct log_backend *backend = log_backend_get_by_name(GOLIOTH_LOG_BACKEND_NAME);
+
+	if (!backend) {
+		LOG_WRN("Golioth log backend not found");
+		return;
+	}
+
+	if (pause) {
+		golioth_log_was_active = log_backend_is_active(backend);
+		if (golioth_log_was_active) {
+			log_backend_deactivate(backend);
+		}
+	} else if (golioth_log_was_active) {
+		log_backend_activate(backend, backend->cb->ctx);
+	}
+}
+#endif /* CONFIG_LOG_BACKEND_GOLIOTH */
+
+static void priority_set(bool on)
+{
+	if (!IS_ENABLED(CONFIG_APP_DFU_PRIORITY) || (atomic_set(&priority, on) == on)) {
+		return;
+	}
+
+	LOG_INF("%s telemetry for the firmware download", on ? "Pausing" : "Resuming");
+
+	stream_queue_pause(on);
+	IF_ENABLED(CONFIG_APP_LOG_BACKEND_REMOTE, (log_backend_remote_pause(on);));
+	IF_ENABLED(CONFIG_LOG_BACKEND_GOLIOTH, (golioth_log_pause(on);));
+}
+
+/* Size of the downloaded image, or 0 if unknown */
+static uint32_t image_bytes(void)
+{
+#ifdef CONFIG_MCUBOOT_IMG_MANAGER
+	struct mcuboot_img_header header;
+	int err;
+
+	err = boot_read_bank_header(SECONDARY_AREA_ID, &header, sizeof(header));
+	if (err) {
+		LOG_WRN("Unable to read the downloaded image header: %d", err);
+		return 0;
+	}
+
+	return header.h.v1.hdr_size + header.h.v1.image_size;
+#else
+	return 0;
+#endif
+}
+
+static void download_report(int64_t duration_ms)
+{
+	char sbuf[STATE_BUF_SIZE];
+	uint32_t bytes = image_bytes();
+	uint32_t bps = (duration_ms > 0) ? (uint64_t)bytes * MSEC_PER_SEC / duration_ms : 0;
+	bool paused = IS_ENABLED(CONFIG_APP_DFU_PRIORITY);
+	int err;
+
+	if (bps > 0) {
+		rate_save(paused ? RATE_PRIORITY : RATE_BASELINE, bps);
+	}
+
+	LOG_INF("Firmware downloaded: %u bytes in %lld ms, %u B/s, telemetry %s", bytes,
+		duration_ms, bps, paused ? "paused" : "running");
+	LOG_INF("Last download rates: %u B/s with telemetry running, %u B/s paused",
+		rates[RATE_BASELINE], rates[RATE_PRIORITY]);
+
+	if (!client) {
+		return;
+	}
+
+	snprintk(sbuf, sizeof(sbuf),
+		 "{\"bytes\":%u,\"duration_ms\":%lld,\"bps\":%u,\"priority\":%s,"
+		 "\"baseline_bps\":%u,\"priority_bps\":%u}",
+		 bytes, duration_ms, bps, paused ? "true" : "false", rates[RATE_BASELINE],
+		 rates[RATE_PRIORITY]);
+
+	err = golioth_lightdb_set_async(client,
+					APP_DFU_STATE_ENDP,
+					GOLIOTH_CONTENT_TYPE_JSON,
+					sbuf,
+					strlen(sbuf),
+					state_async_handler,
+					NULL);
+	if (err) {
+		LOG_ERR("Unable to write DFU state to LightDB State: %d", err);
+	}
+}
+
+static void fw_state_changed(enum golioth_ota_state state, enum golioth_ota_reason reason,
+			     void *arg)
+{
+	switch (state) {
+	case GOLIOTH_OTA_STATE_DOWNLOADING:
+		if (download_start_ms < 0) {
+			download_start_ms = k_uptime_get();
+			LOG_INF("Firmware download started");
+		}
+		priority_set(true);
+		break;
+	case GOLIOTH_OTA_STATE_DOWNLOADED:
+		/* Resume while the image is checked, so the backlog drains before the reboot */
+		priority_set(false);
+		if (download_start_ms >= 0) {
+			download_report(k_uptime_get() - download_start_ms);
+			download_start_ms = -1;
+		}
+		break;
+	case GOLIOTH_OTA_STATE_UPDATING:
+		break;
+	default:
+		priority_set(false);
+		/* A retried download is timed from its first attempt */
+		if ((download_start_ms >= 0) && (reason != GOLIOTH_OTA_REASON_AWAIT_RETRY)) {
+			LOG_WRN("Firmware download ended without an image: reason %d", reason);
+			download_start_ms = -1;
+		}
+		break;
+	}
+}
+
+void app_dfu_init(struct golioth_client *dfu_client)
+{
+	client = dfu_client;
+
+	golioth_fw_update_register_state_change_callback(fw_state_changed, NULL);
+}
+
+bool app_dfu_priority_active(void)
+{
+	return atomic_get(&priority);
+}
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Follow firmware downloads run by the Golioth firmware update service, and
+ * give them the link while they run.
+ *
+ * With APP_DFU_PRIORITY, telemetry steps aside while the download runs:
+ * sensor records are held in RAM (see record_hold.h) while alerts still go
+ * out, remote logging is suspended and battery reports and Ostentus updates
+ * pause. Everything resumes when the download completes or fails.
+ *
+ * The throughput of every completed download is logged and written to the
+ * "dfu" LightDB State endpoint, with whether telemetry was paused and the
+ * last rates measured with telemetry running (the baseline) and paused.
+ * Those rates are saved in the settings subsystem, so a download by a build
+ * without APP_DFU_PRIORITY is compared against the next one with it.
+ */
+
+#ifndef __APP_DFU_H__
+#define __APP_DFU_H__
+
+#include <stdbool.h>
+#include <golioth/client.h>
+
+#define APP_DFU_STATE_ENDP "dfu"
+
+/* Call after golioth_fw_update_init() */
+void app_dfu_init(struct golioth_client *client);
+
+/* True while telemetry is paused for a firmware download */
+bool app_dfu_priority_active(void);
+
+#endif /* __APP_DFU_H__ */
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_pipeline, LOG_LEVEL_DBG);
+
+#include <zephyr/kernel.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "app_pipeline.h"
+#include "app_sensors.h"
+#include "app_trace.h"
+#include "lte_policy.h"
+#include "stream_queue.h"
+
+#define PROCESSING_STACK_SIZE 2048
+#define UPLINK_STACK_SIZE     1536
+
+/* Only waits for other publishers of the channel, never for the stage */
+#define PUBLISH_TIMEOUT K_MSEC(100)
+
+/* How often the processing stage retries releasing records held for a firmware download */
+#define HOLD_RELEASE_INTERVAL K_SECONDS(1)
+
+/* Every message waiting for a stage holds one buffer of the zbus subscriber pool */
+BUILD_ASSERT(CONFIG_APP_PIPELINE_RECORD_QUEUE_LEN + CONFIG_APP_PIPELINE_PAYLOAD_QUEUE_LEN <=
+		     CONFIG_ZBUS_MSG_SUBSCRIBER_NET_BUF_POOL_SIZE,
+	     "Pipeline queues do not fit the zbus message subscriber pool");
+
+struct channel_counters {
+	atomic_t published;
+	atomic_t overflows;
+	atomic_t depth_max;
+};
+
+K_MEM_SLAB_DEFINE_STATIC(record_slab, sizeof(struct sensor_record),
+			 CONFIG_APP_PIPELINE_RECORD_QUEUE_LEN, 4);
+K_SEM_DEFINE(payload_slots, CONFIG_APP_PIPELINE_PAYLOAD_QUEUE_LEN,
+	     CONFIG_APP_PIPELINE_PAYLOAD_QUEUE_LEN);
+
+static struct channel_counters record_counters;
+static struct channel_counters payload_counters;
+
+ZBUS_MSG_SUBSCRIBER_DEFINE(processing_sub);
+ZBUS_MSG_SUBSCRIBER_DEFINE(uplink_sub);
+
+ZBUS_CHAN_DEFINE(record_chan, struct sensor_record *, NULL, NULL, ZBUS_OBSERVERS(processing_sub),
+		 ZBUS_MSG_INIT(NULL));
+ZBUS_CHAN_DEFINE(payload_chan, struct payload_buf *, NULL, NULL, ZBUS_OBSERVERS(uplink_sub),
+		 ZBUS_MSG_INIT(NULL));
+
+static uint32_t record_depth(void)
+{
+	return k_mem_slab_num_used_get(&record_slab);
+}
+
+static uint32_t payload_depth(void)
+{
+	return CONFIG_APP_PIPELINE_PAYLOAD_QUEUE_LEN - k_sem_count_get(&payload_slots);
+}
+
+static void count_published(struct channel_counters *counters, uint32_t depth)
+{
+	atomic_inc(&counters->published);
+
+	/* Raise the maximum without losing a higher value set by a concurrent publisher */
+	for (atomic_val_t max = atomic_get(&counters->depth_max); depth > max;
+	     max = atomic_get(&counters->depth_max)) {
+		if (atomic_cas(&counters->depth_max, max, depth)) {
+			break;
+		}
+	}
+}
+
+int app_pipeline_publish_record(const struct sensor_record *record)
+{
+	struct sensor_record *msg;
+	int err;
+
+	if (k_mem_slab_alloc(&record_slab, (void **)&msg, K_NO_WAIT) != 0) {
+		atomic_inc(&record_counters.overflows);
+		LOG_WRN("Processing stage full (%d records), dropping record",
+			CONFIG_APP_PIPELINE_RECORD_QUEUE_LEN);
+		return -ENOBUFS;
+	}
+
+	*msg = *record;
+
+	err = zbus_chan_pub(&record_chan, &msg, PUBLISH_TIMEOUT);
+	if (err) {
+		LOG_ERR("Failed to publish record: %d", err);
+		k_mem_slab_free(&record_slab, msg);
+		return err;
+	}
+
+	count_published(&record_counters, record_depth());
+
+	return 0;
+}
+
+int app_pipeline_publish_payload(struct payload_buf *buf)
+{
+	int err;
+
+	if (k_sem_take(&payload_slots, K_NO_WAIT) != 0) {
+		atomic_inc(&payload_counters.overflows);
+		LOG_WRN("Uplink stage full (%d payloads), waiting",
+			CONFIG_APP_PIPELINE_PAYLOAD_QUEUE_LEN);
+		k_sem_take(&payload_slots, K_FOREVER);
+	}
+
+	err = zbus_chan_pub(&payload_chan, &buf, PUBLISH_TIMEOUT);
+	if (err) {
+		LOG_ERR("Failed to publish payload: %d", err);
+		k_sem_give(&payload_slots);
+		return err;
+	}
+
+	count_published(&payload_counters, payload_depth());
+
+	return 0;
+}
+
+static void stats_get(struct app_pipeline_channel_stats *stats,
+		      const struct channel_counters *counters, uint32_t depth)
+{
+	stats->published = atomic_get(&counters->published);
+	stats->overflows = atomic_get(&counters->overflows);
+	stats->depth = depth;
+	stats->depth_max = atomic_get(&counters->depth_max);
+}
+
+void app_pipeline_stats_get(struct app_pipeline_stats *stats)
+{
+	stats_get(&stats->record, &record_counters, record_depth());
+	stats_get(&stats->payload, &payload_counters, payload_depth());
+}
+
+static k_timeout_t processing_timeout(void)
+{
+#ifdef CONFIG_APP_DFU_PRIORITY
+	if (app_sensors_held()) {
+		return HOLD_RELEASE_INTERVAL;
+	}
+#endif
+
+	return K_FOREVER;
+}
+
+static void processing_thread(void *p1, void *p2, void *p3)
+{
+	const struct zbus_channel *chan;
+	struct sensor_record *record;
+
+	while (true) {
+		if (zbus_sub_wait_msg(&processing_sub, &chan, &record, processing_timeout()) != 0) {
+			/* Timed out, so payload buffers may have freed up for held records */
+			IF_ENABLED(CONFIG_APP_DFU_PRIORITY, (app_sensors_release_held();));
+			continue;
+		}
+
+		app_trace_begin("process", 0);
+		app_sensors_process(record);
+		app_trace_end("process", 0);
+
+		k_mem_slab_free(&record_slab, record);
+	}
+}
+
+static void uplink_thread(void *p1, void *p2, void *p3)
+{
+	const struct zbus_channel *chan;
+	struct payload_buf *buf;
+
+	while (true) {
+		if (zbus_sub_wait_msg(&uplink_sub, &chan, &buf, K_FOREVER) != 0) {
+			continue;
+		}
+
+		/* Let a send due shortly after a PSM wake-up ride on it */
+		IF_ENABLED(CONFIG_APP_LTE_POLICY, (lte_policy_send_hold();));
+
+		app_trace_begin("uplink", buf->len);
+		stream_queue_send(buf);
+		app_trace_end("uplink", 0);
+
+		k_sem_give(&payload_slots);
+	}
+}
+
+K_THREAD_DEFINE(processing_tid, PROCESSING_STACK_SIZE, processing_thread, NULL, NULL, NULL,
+		CONFIG_APP_PIPELINE_PROCESSING_PRIORITY, 0, 0);
+K_THREAD_DEFINE(uplink_tid, UPLINK_STACK_SIZE, uplink_thread, NULL, NULL, NULL,
+		CONFIG_APP_PIPELINE_UPLINK_PRIORITY, 0, 0);
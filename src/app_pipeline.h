@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Sampling pipeline connected by zbus channels.
+ *
+ * The sampling thread acquires a record and publishes it on `record_chan`.
+ * The processing stage adds it to the history and AQI, logs it, encodes it
+ * into stream payloads and updates the display, publishing the payloads on
+ * `payload_chan`. The uplink stage hands them to the stream queue. Each stage
+ * is a zbus message subscriber with its own thread and priority, so a slow
+ * stage only delays the stages that feed it.
+ *
+ * Messages are pointers to records, held in a slab of
+ * APP_PIPELINE_RECORD_QUEUE_LEN, and to payload buffers, of which at most
+ * APP_PIPELINE_PAYLOAD_QUEUE_LEN wait for the uplink stage. Acquisition keeps
+ * its schedule: a record published while the processing stage is full is
+ * dropped and counted as an overflow. The processing stage instead waits for
+ * the uplink stage, counting each wait as an overflow of the payload channel,
+ * so a stalled uplink backs up into dropped records.
+ */
+
+#ifndef __APP_PIPELINE_H__
+#define __APP_PIPELINE_H__
+
+#include <stdint.h>
+
+#include "payload_pool.h"
+#include "sensor_record.h"
+
+struct app_pipeline_channel_stats {
+	uint32_t published;
+	/* Records dropped, or payloads that had to wait, because the next stage was full */
+	uint32_t overflows;
+	/* Messages waiting for or being handled by the next stage */
+	uint32_t depth;
+	uint32_t depth_max;
+};
+
+struct app_pipeline_stats {
+	struct app_pipeline_channel_stats record;
+	struct app_pipeline_channel_stats payload;
+};
+
+/**
+ * Copy a record to the processing stage. Does not block; returns -ENOBUFS if
+ * the processing stage is full.
+ */
+int app_pipeline_publish_record(const struct sensor_record *record);
+
+/**
+ * Hand a payload buffer to the uplink stage, waiting for room if it is full.
+ * On success the buffer belongs to the stream queue, otherwise it is still
+ * owned by the caller.
+ */
+int app_pipeline_publish_payload(struct payload_buf *buf);
+
+void app_pipeline_stats_get(struct app_pipeline_stats *stats);
+
+#endif /* __APP_PIPELINE_H__ */
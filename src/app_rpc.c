@@ -7,6 +7,7 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(app_rpc, LOG_LEVEL_DBG);
 
+#include <string.h>
 #include <golioth/client.h>
 #include <golioth/rpc.h>
 #include <zephyr/logging/log_ctrl.h>
@@ -16,9 +17,14 @@ LOG_MODULE_REGISTER(app_rpc, LOG_LEVEL_DBG);
 #endif
 
 #include <zcbor_common.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
 
 #include "app_rpc.h"
+#include "app_sensors.h"
+#include "history_upload.h"
 #include "sensor_scd4x.h"
+#include "sensor_snapshot.h"
 #include "sensor_sps30.h"
 
 static void reboot_work_handler(struct k_work *work)
@@ -37,6 +43,20 @@ static void reboot_work_handler(struct k_work *work)
 }
 K_WORK_DEFINE(reboot_work, reboot_work_handler);
 
+#define FRESH_READ_TIMEOUT K_SECONDS(CONFIG_APP_READ_SENSORS_FRESH_TIMEOUT_S)
+
+/* Given when a fast reading finishes, whether or not it succeeded */
+K_SEM_DEFINE(fresh_read_sem, 0, 1);
+
+/* The reading runs on the system work queue, as it may wait for a scheduled cycle */
+static void fresh_read_work_handler(struct k_work *work)
+{
+	app_sensors_read_fresh(FRESH_READ_TIMEOUT);
+	k_sem_give(&fresh_read_sem);
+}
+K_WORK_DEFINE(fresh_read_work, fresh_read_work_handler);
+
+#ifdef CONFIG_APP_SENSOR_SPS30
 static void clean_pm_sensor_work_handler(struct k_work *work)
 {
 	sps30_sensor_clean_fan();
@@ -45,9 +65,10 @@ K_WORK_DEFINE(clean_pm_sensor_work, clean_pm_sensor_work_handler);
 
 static void reset_pm_sensor_work_handler(struct k_work *work)
 {
-	sps30_sensor_init();
+	sps30_sensor_reset();
 }
 K_WORK_DEFINE(reset_pm_sensor_work, reset_pm_sensor_work_handler);
+#endif /* CONFIG_APP_SENSOR_SPS30 */
 
 static enum golioth_rpc_status on_get_network_info(zcbor_state_t *request_params_array,
 						   zcbor_state_t *response_detail_map,
@@ -63,6 +84,7 @@ static enum golioth_rpc_status on_set_log_level(zcbor_state_t *request_params_ar
 						void *callback_arg)
 {
 	double param_0;
+	struct zcbor_string param_1 = {0};
 	uint8_t log_level;
 	bool ok;
 
@@ -82,7 +104,17 @@ static enum golioth_rpc_status on_set_log_level(zcbor_state_t *request_params_ar
 		return GOLIOTH_RPC_INVALID_ARGUMENT;
 	}
 
+	/* Optional second parameter selects a single log module by name */
+	if (!zcbor_array_at_end(request_params_array)) {
+		ok = zcbor_tstr_decode(request_params_array, &param_1);
+		if (!ok) {
+			LOG_ERR("Failed to decode module name");
+			return GOLIOTH_RPC_INVALID_ARGUMENT;
+		}
+	}
+
 	int source_id = 0;
+	int modules_set = 0;
 	char *source_name;
 
 	while (1) {
@@ -91,14 +123,23 @@ static enum golioth_rpc_status on_set_log_level(zcbor_state_t *request_params_ar
 			break;
 		}
 
-		log_filter_set(NULL, 0, source_id, log_level);
+		if ((param_1.len == 0) || ((strlen(source_name) == param_1.len) &&
+					   (strncmp(source_name, param_1.value, param_1.len) == 0))) {
+			log_filter_set(NULL, 0, source_id, log_level);
+			++modules_set;
+		}
 		++source_id;
 	}
 
-	LOG_WRN("Log levels for %d modules set to: %d", source_id, log_level);
+	if ((param_1.len != 0) && (modules_set == 0)) {
+		LOG_ERR("Log module not found: %.*s", param_1.len, param_1.value);
+		return GOLIOTH_RPC_INVALID_ARGUMENT;
+	}
+
+	LOG_WRN("Log levels for %d modules set to: %d", modules_set, log_level);
 
 	ok = zcbor_tstr_put_lit(response_detail_map, "log_modules") &&
-	     zcbor_float64_put(response_detail_map, (double)source_id);
+	     zcbor_float64_put(response_detail_map, (double)modules_set);
 
 	return GOLIOTH_RPC_OK;
 }
@@ -116,19 +157,212 @@ static enum golioth_rpc_status on_clean_pm_sensor(zcbor_state_t *request_params_
 						  zcbor_state_t *response_detail_map,
 						  void *callback_arg)
 {
-	k_work_submit(&clean_pm_sensor_work);
-
-	return GOLIOTH_RPC_OK;
+	COND_CODE_1(CONFIG_APP_SENSOR_SPS30,
+		    (k_work_submit(&clean_pm_sensor_work); return GOLIOTH_RPC_OK;),
+		    (return GOLIOTH_RPC_UNIMPLEMENTED;));
 }
 
 static enum golioth_rpc_status on_reset_pm_sensor(zcbor_state_t *request_params_array,
 						  zcbor_state_t *response_detail_map,
 						  void *callback_arg)
 {
-	k_work_submit(&reset_pm_sensor_work);
+	COND_CODE_1(CONFIG_APP_SENSOR_SPS30,
+		    (k_work_submit(&reset_pm_sensor_work); return GOLIOTH_RPC_OK;),
+		    (return GOLIOTH_RPC_UNIMPLEMENTED;));
+}
+
+static enum golioth_rpc_status on_read_sensors(zcbor_state_t *request_params_array,
+					       zcbor_state_t *response_detail_map,
+					       void *callback_arg)
+{
+	struct sensor_snapshot snapshot;
+	const struct sensor_record *record = &snapshot.record;
+	const char *sensor = NULL;
+	bool refreshing = false;
+	bool fresh = false;
+	int64_t now_ms;
+	bool ok;
+
+	/* Optional parameter takes a fast reading to replace the cached one */
+	if (!zcbor_array_at_end(request_params_array)) {
+		ok = zcbor_bool_decode(request_params_array, &fresh);
+		if (!ok) {
+			LOG_ERR("Failed to decode fresh flag");
+			return GOLIOTH_RPC_INVALID_ARGUMENT;
+		}
+	}
+
+	if (fresh) {
+		k_sem_reset(&fresh_read_sem);
+		k_work_submit(&fresh_read_work);
+
+		/* Fall back to the cached reading if the fast one does not finish in time */
+		refreshing = (k_sem_take(&fresh_read_sem, FRESH_READ_TIMEOUT) != 0);
+		if (refreshing) {
+			LOG_WRN("Fast reading not finished, returning the cached one");
+		}
+	}
+
+	if (!sensor_snapshot_read(&snapshot)) {
+		LOG_WRN("No sensor reading available yet");
+		return GOLIOTH_RPC_UNAVAILABLE;
+	}
+
+	now_ms = k_uptime_get();
+
+	/* Sensors have their own cadences, so each has its own age */
+	ok = zcbor_tstr_put_lit(response_detail_map, "age_ms") &&
+	     zcbor_map_start_encode(response_detail_map, SENSOR_CH_COUNT);
+
+	for (int i = 0; ok && (i < SENSOR_CH_COUNT); i++) {
+		const struct sensor_record_channel_info *info = &sensor_record_channels[i];
+
+		/* The channels of a sensor are listed together and read together */
+		if ((snapshot.read_ms[i] < 0) || (sensor && (strcmp(info->sensor, sensor) == 0))) {
+			continue;
+		}
+
+		sensor = info->sensor;
+		ok = zcbor_tstr_put_term(response_detail_map, sensor, SIZE_MAX) &&
+		     zcbor_int64_put(response_detail_map, now_ms - snapshot.read_ms[i]);
+	}
+
+	ok = ok && zcbor_map_end_encode(response_detail_map, SENSOR_CH_COUNT) &&
+	     zcbor_tstr_put_lit(response_detail_map, "refreshing") &&
+	     zcbor_bool_put(response_detail_map, refreshing);
+
+	for (int i = 0; ok && (i < SENSOR_CH_COUNT); i++) {
+		const struct sensor_record_channel_info *info = &sensor_record_channels[i];
+		double value = record->values[i];
+
+		/* Left out until the channel is first read, rather than reported as 0 */
+		if (!(record->channels & BIT(i))) {
+			continue;
+		}
+
+		for (int e = info->exponent; e < 0; e++) {
+			value /= 10;
+		}
+		for (int e = info->exponent; e > 0; e--) {
+			value *= 10;
+		}
+
+		ok = zcbor_tstr_put_term(response_detail_map, info->name, SIZE_MAX) &&
+		     zcbor_float64_put(response_detail_map, value);
+	}
+
+	if (!ok) {
+		LOG_ERR("Failed to encode sensor readings");
+		return GOLIOTH_RPC_RESOURCE_EXHAUSTED;
+	}
+
+	return GOLIOTH_RPC_OK;
+}
+
+#ifdef CONFIG_APP_HISTORY
+/* Clamp a Unix time in seconds to the range of history entries */
+static uint32_t history_time_from_unix(double unix_s)
+{
+	return (uint32_t)CLAMP(unix_s, 0, UINT32_MAX);
+}
+
+/* Pick the finest resolution that still holds the start of the range */
+static enum sensor_history_res history_res_for(uint32_t from_s)
+{
+	for (int res = 0; res < SENSOR_HISTORY_RES_COUNT; res++) {
+		uint32_t oldest_s;
+
+		if (sensor_history_oldest(res, &oldest_s) && (oldest_s <= from_s)) {
+			return res;
+		}
+	}
+
+	return SENSOR_HISTORY_HOUR;
+}
+
+static enum golioth_rpc_status on_get_history(zcbor_state_t *request_params_array,
+					      zcbor_state_t *response_detail_map,
+					      void *callback_arg)
+{
+	enum sensor_history_res res = SENSOR_HISTORY_RES_COUNT;
+	struct zcbor_string res_name = {0};
+	double start_unix_s;
+	double end_unix_s;
+	uint32_t from_s;
+	uint32_t to_s;
+	size_t count;
+	bool ok;
+	int err;
+
+	ok = zcbor_float_decode(request_params_array, &start_unix_s) &&
+	     zcbor_float_decode(request_params_array, &end_unix_s);
+	if (!ok || (end_unix_s < start_unix_s)) {
+		LOG_ERR("Failed to decode time range");
+		return GOLIOTH_RPC_INVALID_ARGUMENT;
+	}
+
+	/* Optional third parameter selects the resolution */
+	if (!zcbor_array_at_end(request_params_array)) {
+		ok = zcbor_tstr_decode(request_params_array, &res_name);
+		if (!ok) {
+			LOG_ERR("Failed to decode resolution");
+			return GOLIOTH_RPC_INVALID_ARGUMENT;
+		}
+
+		for (int i = 0; i < SENSOR_HISTORY_RES_COUNT; i++) {
+			const char *name = sensor_history_res_name(i);
+
+			if ((strlen(name) == res_name.len) &&
+			    (strncmp(name, res_name.value, res_name.len) == 0)) {
+				res = i;
+			}
+		}
+
+		if (res == SENSOR_HISTORY_RES_COUNT) {
+			LOG_ERR("Unknown history resolution: %.*s", res_name.len, res_name.value);
+			return GOLIOTH_RPC_INVALID_ARGUMENT;
+		}
+	}
+
+	/* History is timestamped in uptime until wall-clock time is known */
+	if (!sensor_history_wall_clock()) {
+		LOG_WRN("Wall-clock time not available, cannot map history range");
+		return GOLIOTH_RPC_UNAVAILABLE;
+	}
+
+	from_s = history_time_from_unix(start_unix_s);
+	to_s = history_time_from_unix(end_unix_s);
+
+	if (res == SENSOR_HISTORY_RES_COUNT) {
+		res = history_res_for(from_s);
+	}
+
+	count = sensor_history_count(res, from_s, to_s);
+	if (count > 0) {
+		err = history_upload_start(res, from_s, to_s);
+		if (err) {
+			LOG_WRN("History upload already in progress");
+			return GOLIOTH_RPC_UNAVAILABLE;
+		}
+	}
+
+	LOG_INF("Uploading %u %s history entries", count, sensor_history_res_name(res));
+
+	ok = zcbor_tstr_put_lit(response_detail_map, "resolution") &&
+	     zcbor_tstr_put_term(response_detail_map, sensor_history_res_name(res), SIZE_MAX) &&
+	     zcbor_tstr_put_lit(response_detail_map, "entries") &&
+	     zcbor_uint32_put(response_detail_map, count);
 
 	return GOLIOTH_RPC_OK;
 }
+#else
+static enum golioth_rpc_status on_get_history(zcbor_state_t *request_params_array,
+					      zcbor_state_t *response_detail_map,
+					      void *callback_arg)
+{
+	return GOLIOTH_RPC_UNIMPLEMENTED;
+}
+#endif /* CONFIG_APP_HISTORY */
 
 static void rpc_log_if_register_failure(int err)
 {
@@ -157,4 +391,10 @@ void app_rpc_register(struct golioth_client *client)
 
 	err = golioth_rpc_register(rpc, "reset_pm_sensor", on_reset_pm_sensor, NULL);
 	rpc_log_if_register_failure(err);
+
+	err = golioth_rpc_register(rpc, "read_sensors", on_read_sensors, NULL);
+	rpc_log_if_register_failure(err);
+
+	err = golioth_rpc_register(rpc, "get_history", on_get_history, NULL);
+	rpc_log_if_register_failure(err);
 }
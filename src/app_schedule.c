@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_schedule, LOG_LEVEL_DBG);
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "app_schedule.h"
+#include "app_settings.h"
+#include "app_time.h"
+#include "power_policy.h"
+#include "sensor_record.h"
+
+static void schedule_timer_expiry(struct k_timer *timer);
+
+K_TIMER_DEFINE(schedule_timer, schedule_timer_expiry, NULL);
+K_SEM_DEFINE(schedule_sem, 0, 1);
+K_MUTEX_DEFINE(schedule_stats_mutex);
+
+/* Set when the period changes; the deadlines are recomputed on the next wake-up */
+static atomic_t period_changed;
+
+/* Uptime in ticks at which the next scheduled cycle starts; only used by the sampling thread */
+static int64_t deadline;
+
+static struct app_schedule_stats stats;
+static uint64_t jitter_sum_us;
+
+/* Whether the cycle that is starting was triggered ahead of schedule */
+static bool triggered;
+
+struct sensor_cadence {
+	uint32_t channels;
+	/* Offset of the read interval in struct app_settings */
+	size_t interval_s;
+	/* Scheduled cycles left before the sensor is read again */
+	uint32_t skip;
+};
+
+/* Only used by the sampling thread */
+static struct sensor_cadence cadences[] = {
+#ifdef CONFIG_APP_SENSOR_BME280
+	{SENSOR_RECORD_CHANNELS_BME280, offsetof(struct app_settings, env_interval_s)},
+#endif
+#ifdef CONFIG_APP_SENSOR_SCD4X
+	{SENSOR_RECORD_CHANNELS_SCD4X, offsetof(struct app_settings, co2_interval_s)},
+#endif
+#ifdef CONFIG_APP_SENSOR_SPS30
+	{SENSOR_RECORD_CHANNELS_SPS30, offsetof(struct app_settings, pm_interval_s)},
+#endif
+};
+
+static void schedule_timer_expiry(struct k_timer *timer)
+{
+	k_sem_give(&schedule_sem);
+}
+
+int64_t app_schedule_period_ms(void)
+{
+	struct app_settings settings;
+	int64_t period_ms;
+
+	app_settings_get(&settings);
+	period_ms = (int64_t)settings.loop_delay_s * MSEC_PER_SEC;
+
+	/* Stretched on a low battery */
+	IF_ENABLED(CONFIG_APP_POWER_POLICY, (period_ms *= power_policy_period_factor();));
+
+	return period_ms;
+}
+
+/* Deadline of the cycle that follows a deadline (or any point in time) `after` */
+static int64_t next_deadline(int64_t after)
+{
+	int64_t period_ms = app_schedule_period_ms();
+	int64_t after_ms = k_ticks_to_ms_floor64(after);
+	int64_t unix_ms;
+	int64_t next_ms;
+
+	if (IS_ENABLED(CONFIG_APP_SCHEDULE_ALIGN_WALL_CLOCK) &&
+	    (app_time_uptime_to_unix_ms(after_ms, &unix_ms) == 0)) {
+		/* Next multiple of the period in Unix time. Aligning every deadline
+		 * rather than only the first follows wall-clock corrections.
+		 */
+		next_ms = after_ms + period_ms - (unix_ms % period_ms);
+
+		/* A clock step back must not put two deadlines right after each other */
+		if ((next_ms - after_ms) < (period_ms / 2)) {
+			next_ms += period_ms;
+		}
+
+		return k_ms_to_ticks_ceil64(next_ms);
+	}
+
+	return after + k_ms_to_ticks_ceil64(period_ms);
+}
+
+void app_schedule_start(void)
+{
+	struct app_settings settings;
+
+	/* The cycle running at start-up is not scheduled; the first deadline follows it */
+	deadline = next_deadline(k_uptime_ticks());
+
+	app_settings_get(&settings);
+	LOG_INF("Sampling every %d s%s", settings.loop_delay_s,
+		IS_ENABLED(CONFIG_APP_SCHEDULE_ALIGN_WALL_CLOCK) ? ", aligned to wall-clock time"
+								  : "");
+}
+
+static void record_cycle_start(int64_t scheduled, int64_t now)
+{
+	int64_t jitter_us = k_ticks_to_us_floor64(now - scheduled);
+
+	k_mutex_lock(&schedule_stats_mutex, K_FOREVER);
+
+	stats.cycles++;
+	stats.jitter_last_us = (int32_t)CLAMP(jitter_us, INT32_MIN, INT32_MAX);
+	stats.jitter_max_us = MAX(stats.jitter_max_us, (uint32_t)MAX(stats.jitter_last_us, 0));
+	jitter_sum_us += MAX(stats.jitter_last_us, 0);
+	stats.jitter_avg_us = (uint32_t)(jitter_sum_us / stats.cycles);
+
+	LOG_INF("Cycle %u: start jitter %d us (avg %u us, max %u us), %u overruns", stats.cycles,
+		stats.jitter_last_us, stats.jitter_avg_us, stats.jitter_max_us, stats.overruns);
+
+	k_mutex_unlock(&schedule_stats_mutex);
+}
+
+/* Skip the deadlines a long cycle has run past */
+static void skip_missed_deadlines(int64_t now)
+{
+	uint32_t missed = 0;
+
+	while (deadline <= now) {
+		deadline = next_deadline(deadline);
+		missed++;
+	}
+
+	if (missed == 0) {
+		return;
+	}
+
+	k_mutex_lock(&schedule_stats_mutex, K_FOREVER);
+	stats.overruns += missed;
+	k_mutex_unlock(&schedule_stats_mutex);
+
+	LOG_WRN("Cycle overran %u deadline(s)", missed);
+}
+
+void app_schedule_wait(void)
+{
+	int64_t now;
+
+	skip_missed_deadlines(k_uptime_ticks());
+
+	/* Wake-ups that arrived while the previous cycle was running are dropped */
+	k_sem_reset(&schedule_sem);
+
+	while (true) {
+		if (atomic_clear(&period_changed)) {
+			/* Between cycles, so the new period can take effect right away */
+			app_settings_refresh();
+			deadline = next_deadline(k_uptime_ticks());
+		}
+
+		k_timer_start(&schedule_timer, K_TIMEOUT_ABS_TICKS(deadline), K_NO_WAIT);
+		k_sem_take(&schedule_sem, K_FOREVER);
+		k_timer_stop(&schedule_timer);
+
+		if (atomic_get(&period_changed)) {
+			continue;
+		}
+
+		now = k_uptime_ticks();
+
+		if (now < deadline) {
+			k_mutex_lock(&schedule_stats_mutex, K_FOREVER);
+			stats.triggered++;
+			k_mutex_unlock(&schedule_stats_mutex);
+
+			LOG_INF("Cycle triggered ahead of schedule");
+			triggered = true;
+			return;
+		}
+
+		break;
+	}
+
+	triggered = false;
+	record_cycle_start(deadline, now);
+
+	deadline = next_deadline(deadline);
+}
+
+void app_schedule_trigger(void)
+{
+	k_sem_give(&schedule_sem);
+}
+
+void app_schedule_period_changed(void)
+{
+	atomic_set(&period_changed, 1);
+	k_sem_give(&schedule_sem);
+}
+
+int64_t app_schedule_next_ms(void)
+{
+	return k_ticks_to_ms_floor64(deadline);
+}
+
+/* Sensor intervals are rounded up to whole cycles */
+static uint32_t cycles_per_read(const struct sensor_cadence *cadence,
+				const struct app_settings *settings)
+{
+	int32_t interval_s = app_settings_s32(settings, cadence->interval_s);
+
+	return MAX(DIV_ROUND_UP(interval_s, settings->loop_delay_s), 1);
+}
+
+uint32_t app_schedule_due_channels(void)
+{
+	struct app_settings settings;
+	uint32_t due = 0;
+
+	app_settings_get(&settings);
+
+	for (size_t i = 0; i < ARRAY_SIZE(cadences); i++) {
+		struct sensor_cadence *cadence = &cadences[i];
+		uint32_t cycles = cycles_per_read(cadence, &settings);
+
+		if (triggered) {
+			due |= cadence->channels;
+			continue;
+		}
+
+		/* A shorter interval takes effect right away */
+		cadence->skip = MIN(cadence->skip, cycles - 1);
+
+		if (cadence->skip == 0) {
+			due |= cadence->channels;
+			cadence->skip = cycles - 1;
+		} else {
+			cadence->skip--;
+		}
+	}
+
+	return due;
+}
+
+int64_t app_schedule_next_read_ms(uint32_t channels)
+{
+	uint32_t skip = UINT32_MAX;
+
+	for (size_t i = 0; i < ARRAY_SIZE(cadences); i++) {
+		if (cadences[i].channels & channels) {
+			skip = MIN(skip, cadences[i].skip);
+		}
+	}
+
+	if (skip == UINT32_MAX) {
+		return app_schedule_next_ms();
+	}
+
+	return app_schedule_next_ms() + (int64_t)skip * app_schedule_period_ms();
+}
+
+void app_schedule_stats_get(struct app_schedule_stats *out)
+{
+	k_mutex_lock(&schedule_stats_mutex, K_FOREVER);
+	*out = stats;
+	k_mutex_unlock(&schedule_stats_mutex);
+}
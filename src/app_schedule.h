@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Fixed-rate sampling schedule.
+ *
+ * Cycles start on absolute deadlines LOOP_DELAY_S apart, independent of how
+ * long each cycle takes. With CONFIG_APP_SCHEDULE_ALIGN_WALL_CLOCK, deadlines
+ * fall on multiples of the period in Unix time (e.g. every full minute) once
+ * wall-clock time is known, so devices in a fleet sample at the same moments.
+ * A cycle that runs past one or more deadlines is counted as an overrun and the
+ * missed deadlines are skipped rather than run back to back.
+ *
+ * Each sensor is read every ENV_INTERVAL_S, CO2_INTERVAL_S or PM_INTERVAL_S,
+ * rounded up to a whole number of cycles; 0 reads it every cycle. A cycle
+ * triggered ahead of schedule reads every sensor without moving their
+ * schedules.
+ */
+
+#ifndef __APP_SCHEDULE_H__
+#define __APP_SCHEDULE_H__
+
+#include <stdint.h>
+
+struct app_schedule_stats {
+	uint32_t cycles;
+	uint32_t overruns;
+	uint32_t triggered;
+	/* Delay between a deadline and the start of its cycle */
+	int32_t jitter_last_us;
+	uint32_t jitter_max_us;
+	uint32_t jitter_avg_us;
+};
+
+void app_schedule_start(void);
+
+/* Block until the next cycle is due or a cycle is triggered */
+void app_schedule_wait(void);
+
+/* Run a cycle now without moving the deadlines. Can be called from an ISR. */
+void app_schedule_trigger(void);
+
+/* Recompute the deadlines after the period has changed */
+void app_schedule_period_changed(void);
+
+/* Current sampling period in ms, stretched by the power policy */
+int64_t app_schedule_period_ms(void);
+
+/* Uptime in ms at which the next scheduled cycle starts */
+int64_t app_schedule_next_ms(void);
+
+/* Record channels of the sensors due in the cycle that is starting; call once per cycle */
+uint32_t app_schedule_due_channels(void);
+
+/* Uptime in ms at which the next scheduled cycle reading any of `channels` starts */
+int64_t app_schedule_next_read_ms(uint32_t channels);
+
+void app_schedule_stats_get(struct app_schedule_stats *stats);
+
+#endif /* __APP_SCHEDULE_H__ */
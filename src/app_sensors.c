@@ -8,16 +8,35 @@
 LOG_MODULE_REGISTER(app_sensors, LOG_LEVEL_DBG);
 
 #include <golioth/client.h>
-#include <golioth/stream.h>
 #include <zcbor_encode.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/sensor.h>
 
+#include "app_alerts.h"
+#include "app_dfu.h"
+#include "app_pipeline.h"
+#include "app_schedule.h"
 #include "app_sensors.h"
+#include "app_settings.h"
 #include "sensor_bme280.h"
 #include "sensor_scd4x.h"
 #include "sensor_sps30.h"
+#include "log_backend_remote.h"
+#include "lte_policy.h"
+#include "payload_pool.h"
+#include "power_policy.h"
+#include "record_hold.h"
+#include "stream_queue.h"
+#include "app_time.h"
+#include "app_trace.h"
+#include "aqi_nowcast.h"
+#include "batch_encoder.h"
+#include "sensor_async.h"
+#include "sensor_history.h"
+#include "sensor_record.h"
+#include "sensor_recovery.h"
+#include "sensor_snapshot.h"
 
 #ifdef CONFIG_LIB_OSTENTUS
 #include <libostentus.h>
@@ -29,175 +48,724 @@ static const struct device *o_dev = DEVICE_DT_GET_ANY(golioth_ostentus);
 
 static struct golioth_client *client;
 
-/* Formatting string for sending sensor JSON to Golioth */
-/* clang-format off */
-#define JSON_FMT \
-"{" \
-	"\"tem\":%f," \
-	"\"pre\":%f," \
-	"\"hum\":%f," \
-	"\"co2\":%u," \
-	"\"mc_1p0\":%f," \
-	"\"mc_2p5\":%f," \
-	"\"mc_4p0\":%f," \
-	"\"mc_10p0\":%f," \
-	"\"nc_0p5\":%f," \
-	"\"nc_1p0\":%f," \
-	"\"nc_2p5\":%f," \
-	"\"nc_4p0\":%f," \
-	"\"nc_10p0\":%f," \
-	"\"tps\":%f" \
-"}"
-/* clang-format on */
-
-#define JSON_BUF_SIZE 512
+/* Readings persist so a sensor that fails or is skipped keeps its last values */
+static struct sensor_readings readings;
+K_MUTEX_DEFINE(acquire_mutex);
+
+/* Acquisition timestamp, and PM averaging window for PM records, prepended to the JSON record
+ * when known
+ */
+#define JSON_TIME_FMT	"\"time\":\"%s\","
+#define JSON_WINDOW_FMT "\"win_start\":%lld,\"win_end\":%lld,"
+
+#define JSON_TIME_BUF_SIZE                                                                         \
+	(sizeof(JSON_TIME_FMT) + APP_TIME_RFC3339_LEN + sizeof(JSON_WINDOW_FMT) + 2 * 20)
+
+/* NowCast AQI and category index, added to the JSON record once known */
+#define JSON_AQI_FMT "\"aqi\":%u,\"aqi_cat\":%u,"
+
+#define JSON_PREFIX_BUF_SIZE (JSON_TIME_BUF_SIZE + sizeof(JSON_AQI_FMT) + 2 * 5)
+
+/* Ostentus slide values are short strings */
+#define SLIDE_BUF_SIZE 40
 
 void app_sensors_init(void)
 {
 	/* Initialize weather sensor */
-	bme280_sensor_init();
+	IF_ENABLED(CONFIG_APP_SENSOR_BME280, (bme280_sensor_init();));
 
 	/* Initialize CO₂ sensor */
-	scd4x_sensor_init();
+	IF_ENABLED(CONFIG_APP_SENSOR_SCD4X, (scd4x_sensor_init();));
 
 	/* Initialize PM sensor */
-	sps30_sensor_init();
+	IF_ENABLED(CONFIG_APP_SENSOR_SPS30, (sps30_sensor_init();));
+
+	/* Watch sensor reads from here on */
+	sensor_async_init();
+}
+
+/* Report how much logging the sampling path cost in this cycle */
+static void log_cycle_cost(uint32_t log_cycles)
+{
+#ifdef CONFIG_APP_LOG_BACKEND_REMOTE
+	static struct log_backend_remote_stats last;
+	struct log_backend_remote_stats now;
+
+	log_backend_remote_stats_get(&now);
+
+	LOG_INF("Logging cost this cycle: %u us, %u B uploaded, %u lines rate-limited",
+		k_cyc_to_us_floor32(log_cycles), now.bytes_sent - last.bytes_sent,
+		now.rate_limited - last.rate_limited);
+
+	last = now;
+#else
+	LOG_INF("Logging cost this cycle: %u us", k_cyc_to_us_floor32(log_cycles));
+#endif
+}
+
+/* Get a payload buffer, dropping the oldest queued reading rather than the newest one */
+static struct payload_buf *payload_buf_get(void)
+{
+	struct payload_buf *buf = payload_pool_alloc();
+
+	if (!buf) {
+		buf = stream_queue_reclaim_oldest();
+	}
+
+	if (!buf) {
+		LOG_ERR("No free payload buffer, dropping reading");
+	}
+
+	return buf;
 }
 
-/* Callback for LightDB Stream */
-static void async_error_handler(struct golioth_client *client, enum golioth_status status,
-				const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
-				void *arg)
+#ifdef CONFIG_APP_STREAM_BATCH
+
+/* Most payload buffers taken by sending one record */
+#define RECORD_PAYLOADS_MAX 1
+
+static struct sensor_record batch[CONFIG_APP_STREAM_BATCH_SIZE];
+static size_t batch_count;
+
+static void send_batch(const struct sensor_record *records, size_t count)
 {
-	if (status != GOLIOTH_OK) {
-		LOG_ERR("Async task failed: %d", status);
+	struct payload_buf *buf = payload_buf_get();
+	int err;
+
+	if (!buf) {
+		return;
+	}
+
+	app_trace_begin("encode_batch", count);
+	err = batch_encoder_encode(records, count, buf->data, sizeof(buf->data), &buf->len);
+	app_trace_end("encode_batch", buf->len);
+	if ((err == -ENOMEM) && (count > 1)) {
+		/* Unusually large deltas; split the batch in two */
+		payload_pool_free(buf);
+		send_batch(records, count / 2);
+		send_batch(&records[count / 2], count - count / 2);
+		return;
+	}
+
+	if (err) {
+		LOG_ERR("Failed to encode batch of %u records: %d", count, err);
+		payload_pool_free(buf);
 		return;
 	}
+
+	LOG_DBG("Sending batch of %u records to Golioth", count);
+
+	buf->path = "sensor_batch";
+	buf->content_type = GOLIOTH_CONTENT_TYPE_CBOR;
+	buf->sample_ms = records[0].sample_ms;
+
+	if (app_pipeline_publish_payload(buf)) {
+		payload_pool_free(buf);
+	}
 }
 
-/* This will be called by the main() loop */
-/* Do all of your work here! */
-void app_sensors_read_and_stream(void)
+static void send_batched_record(const struct sensor_record *record)
 {
+	batch[batch_count++] = *record;
+
+	if (batch_count < ARRAY_SIZE(batch)) {
+		LOG_DBG("Batched %u of %u records", batch_count, ARRAY_SIZE(batch));
+		return;
+	}
+
+	send_batch(batch, batch_count);
+	batch_count = 0;
+}
+
+#else /* CONFIG_APP_STREAM_BATCH */
+
+/* Each sensor streams its channels to its own path, in the cycles it is read */
+struct json_stream {
+	const char *path;
+	uint32_t channels;
+};
+
+static const struct json_stream json_streams[] = {
+#ifdef CONFIG_APP_SENSOR_BME280
+	{"sensor/env", SENSOR_RECORD_CHANNELS_BME280},
+#endif
+#ifdef CONFIG_APP_SENSOR_SCD4X
+	{"sensor/co2", SENSOR_RECORD_CHANNELS_SCD4X},
+#endif
+#ifdef CONFIG_APP_SENSOR_SPS30
+	{"sensor/pm", SENSOR_RECORD_CHANNELS_SPS30},
+#endif
+};
+
+#define RECORD_PAYLOADS_MAX ARRAY_SIZE(json_streams)
+
+/* Format the wall-clock fields of a record, or an empty string if the time is not known yet.
+ * The PM averaging window is only included with `window`.
+ */
+static void format_time_fields(char *buf, size_t len, const struct sensor_record *record,
+			       bool window)
+{
+	char rfc3339[APP_TIME_RFC3339_LEN];
+	int64_t sample_unix_ms;
+	int64_t win_start_unix_ms;
+	int64_t win_end_unix_ms;
+
+	buf[0] = '\0';
+
+	if (app_time_uptime_to_unix_ms(record->sample_ms, &sample_unix_ms) ||
+	    app_time_uptime_to_unix_ms(record->win_start_ms, &win_start_unix_ms) ||
+	    app_time_uptime_to_unix_ms(record->win_end_ms, &win_end_unix_ms) ||
+	    app_time_format_rfc3339(sample_unix_ms, rfc3339, sizeof(rfc3339))) {
+		LOG_WRN("Wall-clock time not available, record will use arrival time");
+		return;
+	}
+
+	snprintk(buf, len, JSON_TIME_FMT, rfc3339);
+
+	if (window) {
+		snprintk(&buf[strlen(buf)], len - strlen(buf), JSON_WINDOW_FMT, win_start_unix_ms,
+			 win_end_unix_ms);
+	}
+}
+
+#ifdef CONFIG_APP_AQI
+/* Format the AQI fields, or an empty string if the NowCast is not known yet. Returns the
+ * channels of `channels` to send alongside them.
+ */
+static uint32_t format_aqi_fields(char *buf, size_t len, uint32_t channels)
+{
+	struct aqi_nowcast nowcast;
+
+	buf[0] = '\0';
+
+	if (!aqi_nowcast_get(&nowcast)) {
+		return channels;
+	}
+
+	snprintk(buf, len, JSON_AQI_FMT, nowcast.aqi, nowcast.category);
+
+	if (IS_ENABLED(CONFIG_APP_AQI_REPLACES_PM)) {
+		return channels & ~SENSOR_RECORD_CHANNELS_SPS30;
+	}
+
+	return channels;
+}
+#endif /* CONFIG_APP_AQI */
+
+static void send_json_stream(const struct sensor_record *record, const struct json_stream *stream)
+{
+	char prefix[JSON_PREFIX_BUF_SIZE];
+	uint32_t channels = stream->channels;
+	bool pm = (stream->channels & SENSOR_RECORD_CHANNELS_SPS30) != 0;
+	struct payload_buf *buf = payload_buf_get();
+	size_t pos;
 	int err;
-	static struct bme280_sensor_measurement bme280_sm;
-	static struct scd4x_sensor_measurement scd4x_sm;
-	static struct sps30_sensor_measurement sps30_sm;
 
-	/* Golioth custom hardware for demos */
-	IF_ENABLED(CONFIG_ALUDEL_BATTERY_MONITOR, (
-		LOG_DBG("Collecting battery measurements...");
-		read_and_report_battery(client);
-		IF_ENABLED(CONFIG_LIB_OSTENTUS, (
-			ostentus_slide_set(o_dev,
-					   BATTERY_V,
-					   get_batt_v_str(),
-					   strlen(get_batt_v_str()));
-			ostentus_slide_set(o_dev,
-					   BATTERY_LVL,
-					   get_batt_lvl_str(),
-					   strlen(get_batt_lvl_str()));
-		));
-	));
+	if (!buf) {
+		return;
+	}
 
-	LOG_DBG("Collecting sensor measurements...");
+	LOG_DBG("Sending %s data to Golioth", stream->path);
+
+	app_trace_begin("encode_json", 0);
+
+	format_time_fields(prefix, sizeof(prefix), record, pm);
+	pos = strlen(prefix);
+
+#ifdef CONFIG_APP_AQI
+	if (pm) {
+		channels = format_aqi_fields(&prefix[pos], sizeof(prefix) - pos, channels);
+	}
+#endif
+
+	err = sensor_record_json_encode(record, prefix, channels, (char *)buf->data,
+					sizeof(buf->data));
+
+	app_trace_end("encode_json", err ? 0 : strlen((char *)buf->data));
 
-	/* Read the weather sensor */
-	err = bme280_sensor_read(&bme280_sm);
 	if (err) {
-		LOG_ERR("Failed to read from Weather Sensor BME280: %d", err);
-	} else {
-		bme280_log_measurements(&bme280_sm);
+		LOG_ERR("Failed to encode sensor record: %d", err);
+		payload_pool_free(buf);
+		return;
+	}
+
+	/* LOG_DBG("%s", buf->data); */
+
+	buf->path = stream->path;
+	buf->content_type = GOLIOTH_CONTENT_TYPE_JSON;
+	buf->sample_ms = record->sample_ms;
+	buf->len = strlen((char *)buf->data);
+
+	if (app_pipeline_publish_payload(buf)) {
+		payload_pool_free(buf);
+	}
+}
+
+static void send_json_record(const struct sensor_record *record)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(json_streams); i++) {
+		if (record->channels & json_streams[i].channels) {
+			send_json_stream(record, &json_streams[i]);
+		}
+	}
+}
+
+#endif /* CONFIG_APP_STREAM_BATCH */
+
+static void send_record(const struct sensor_record *record)
+{
+#ifdef CONFIG_APP_STREAM_BATCH
+	send_batched_record(record);
+#else
+	send_json_record(record);
+#endif
+}
+
+#ifdef CONFIG_APP_DFU_PRIORITY
+
+/* Buffers kept free for alerts while held records are released */
+#define HOLD_RELEASE_RESERVE 1
+
+/* Otherwise a record with every channel could never be released */
+BUILD_ASSERT(CONFIG_APP_PAYLOAD_POOL_COUNT > RECORD_PAYLOADS_MAX + HOLD_RELEASE_RESERVE,
+	     "APP_PAYLOAD_POOL_COUNT too small to release held records");
+
+/* Payload buffers sending a record takes at most */
+static uint32_t record_payloads(const struct sensor_record *record)
+{
+#ifdef CONFIG_APP_STREAM_BATCH
+	ARG_UNUSED(record);
+
+	return 1;
+#else
+	uint32_t payloads = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(json_streams); i++) {
+		if (record->channels & json_streams[i].channels) {
+			payloads++;
+		}
 	}
 
-	/* Read the CO₂ sensor */
-	err = scd4x_sensor_read(&scd4x_sm);
+	return payloads;
+#endif
+}
+
+bool app_sensors_held(void)
+{
+	return record_hold_count() > 0;
+}
+
+void app_sensors_release_held(void)
+{
+	struct payload_pool_stats pool;
+	struct sensor_record record;
+	uint32_t released = 0;
+
+	while (!app_dfu_priority_active() && app_sensors_held()) {
+		payload_pool_stats_get(&pool);
+		if ((pool.used + record_payloads(record_hold_peek()) + HOLD_RELEASE_RESERVE) >
+		    CONFIG_APP_PAYLOAD_POOL_COUNT) {
+			break;
+		}
+
+		record_hold_get(&record);
+		send_record(&record);
+		released++;
+	}
+
+	if (released > 0) {
+		LOG_INF("Released %u held record(s), %u still held, %u dropped", released,
+			record_hold_count(), record_hold_dropped());
+	}
+}
+
+#endif /* CONFIG_APP_DFU_PRIORITY */
+
+static void log_uplink_stats(void)
+{
+	struct stream_queue_stats stats;
+
+	stream_queue_stats_get(&stats);
+
+	LOG_INF("Uplink: %u sent, %u queued, %u retries, %u dropped, latency avg %u ms max %u ms",
+		stats.sent, stats.queued, stats.retries, stats.dropped, stats.latency_avg_ms,
+		stats.latency_max_ms);
+}
+
+#ifdef CONFIG_APP_UPLINK_BENCHMARK
+#define BENCHMARK_POLL_INTERVAL K_MSEC(1)
+
+/* Records per second carried by `payloads` sent over `elapsed_ms` */
+static uint32_t benchmark_record_rate(const struct sensor_record *record, uint32_t payloads,
+				      int64_t elapsed_ms)
+{
+#ifdef CONFIG_APP_STREAM_BATCH
+	ARG_UNUSED(record);
+
+	/* A batch that does not fit is split, so this is an upper bound */
+	return (uint32_t)((uint64_t)payloads * CONFIG_APP_STREAM_BATCH_SIZE * MSEC_PER_SEC /
+			  elapsed_ms);
+#else
+	uint32_t streams = 0;
+
+	/* Each record is sent as one payload per sensor it holds channels of */
+	for (size_t i = 0; i < ARRAY_SIZE(json_streams); i++) {
+		if (record->channels & json_streams[i].channels) {
+			streams++;
+		}
+	}
+
+	if (streams == 0) {
+		return 0;
+	}
+
+	return (uint32_t)((uint64_t)payloads * MSEC_PER_SEC / ((uint64_t)elapsed_ms * streams));
+#endif
+}
+
+static void log_benchmark_stats(const struct sensor_record *record,
+				const struct stream_queue_stats *last,
+				const struct stream_queue_stats *now, int64_t elapsed_ms)
+{
+	uint32_t payloads = now->sent - last->sent;
+	uint32_t bytes = (uint32_t)(now->bytes_sent - last->bytes_sent);
+
+	LOG_INF("Benchmark: %u records/s, %u payloads/s, %u B/s, %u B/payload",
+		benchmark_record_rate(record, payloads, elapsed_ms),
+		(uint32_t)((uint64_t)payloads * MSEC_PER_SEC / elapsed_ms),
+		(uint32_t)((uint64_t)bytes * MSEC_PER_SEC / elapsed_ms),
+		payloads ? bytes / payloads : 0);
+	LOG_INF("Benchmark: %u queue full (max %d requests), %u dropped, ack latency p50 %u ms "
+		"p90 %u ms p99 %u ms",
+		now->queue_full - last->queue_full, CONFIG_GOLIOTH_COAP_REQUEST_QUEUE_MAX_ITEMS,
+		now->dropped - last->dropped, now->ack_p50_ms, now->ack_p90_ms, now->ack_p99_ms);
+}
+#endif /* CONFIG_APP_UPLINK_BENCHMARK */
+
+static void log_pipeline_stats(void)
+{
+	struct app_pipeline_stats stats;
+
+	app_pipeline_stats_get(&stats);
+
+	LOG_INF("Pipeline: records %u published, %u dropped, depth max %u; payloads %u published, "
+		"%u waited, depth max %u",
+		stats.record.published, stats.record.overflows, stats.record.depth_max,
+		stats.payload.published, stats.payload.overflows, stats.payload.depth_max);
+}
+
+static void log_recovery_stats(void)
+{
+	struct sensor_recovery_stats stats;
+
+	sensor_recovery_stats_get(&stats);
+
+	LOG_INF("Sensor recovery: %u bus (%u ms, max %u ms), %u re-init (%u ms, max %u ms), "
+		"%u reboots, %u watchdog, %u failed",
+		stats.count[SENSOR_RECOVERY_BUS], stats.total_ms[SENSOR_RECOVERY_BUS],
+		stats.max_ms[SENSOR_RECOVERY_BUS], stats.count[SENSOR_RECOVERY_REINIT],
+		stats.total_ms[SENSOR_RECOVERY_REINIT], stats.max_ms[SENSOR_RECOVERY_REINIT],
+		stats.count[SENSOR_RECOVERY_REBOOT], stats.watchdog, stats.failed);
+	LOG_INF("Sensor outages: %u (%u readings lost, %u ms, max %u ms)", stats.outages,
+		stats.lost, stats.outage_total_ms, stats.outage_max_ms);
+}
+
+#ifdef CONFIG_APP_SENSOR_SPS30
+static void log_sps30_stats(void)
+{
+	LOG_INF("SPS30 fan: on %u s/h%s", sps30_sensor_fan_on_s_per_hour(),
+		IS_ENABLED(CONFIG_APP_SPS30_DUTY_CYCLE) ? ", sleeping between windows" : "");
+}
+#endif /* CONFIG_APP_SENSOR_SPS30 */
+
+#ifdef CONFIG_APP_ALERTS
+static void log_alert_stats(void)
+{
+	struct app_alerts_stats stats;
+
+	app_alerts_stats_get(&stats);
+
+	LOG_INF("Alerts: %u raised, %u cleared, enqueue latency last %u ms avg %u ms max %u ms",
+		stats.raised, stats.cleared, stats.latency_last_ms, stats.latency_avg_ms,
+		stats.latency_max_ms);
+}
+#endif /* CONFIG_APP_ALERTS */
+
+#ifdef CONFIG_APP_LTE_POLICY
+/* Records are sent every cycle, or once per batch */
+static uint32_t upload_interval_s(void)
+{
+	int64_t interval_ms = app_schedule_period_ms();
+
+	IF_ENABLED(CONFIG_APP_STREAM_BATCH, (interval_ms *= CONFIG_APP_STREAM_BATCH_SIZE;));
+
+	return interval_ms / MSEC_PER_SEC;
+}
+
+static void log_lte_stats(void)
+{
+	struct lte_policy_stats stats;
+
+	lte_policy_stats_get(&stats);
+
+	LOG_INF("LTE: %u PSM wake-ups, %u sends held for one (%u ms)", stats.wakes, stats.held,
+		stats.held_ms);
+}
+#endif /* CONFIG_APP_LTE_POLICY */
+
+#ifdef CONFIG_LIB_OSTENTUS
+/* Update the value of every channel that has a slide. Slide keys are the channel numbers. */
+static void slides_update(const struct sensor_record *record)
+{
+	char sbuf[SLIDE_BUF_SIZE];
+
+	if (IS_ENABLED(CONFIG_APP_DFU_PRIORITY) && app_dfu_priority_active()) {
+		return;
+	}
+
+	app_trace_begin("ostentus", 0);
+
+	for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+		const struct sensor_record_channel_info *ch = &sensor_record_channels[i];
+		size_t len;
+
+		if (!ch->slide) {
+			continue;
+		}
+
+		len = sensor_record_format_value(sbuf, sizeof(sbuf), record->values[i],
+						 ch->exponent);
+		snprintk(&sbuf[len], sizeof(sbuf) - len, " %s", ch->unit);
+
+		ostentus_slide_set(o_dev, i, sbuf, strlen(sbuf));
+	}
+
+#ifdef CONFIG_APP_AQI
+	struct aqi_nowcast nowcast;
+
+	if (aqi_nowcast_get(&nowcast)) {
+		snprintk(sbuf, sizeof(sbuf), "%u %s", nowcast.aqi,
+			 aqi_category_name(nowcast.category));
+		ostentus_slide_set(o_dev, AQI, sbuf, strlen(sbuf));
+	}
+#endif /* CONFIG_APP_AQI */
+
+	app_trace_end("ostentus", 0);
+}
+#endif /* CONFIG_LIB_OSTENTUS */
+
+/* Read the sensors providing `channels` into a record and publish it as the latest snapshot.
+ * Must be called with acquire_mutex held.
+ */
+static int acquire(struct sensor_record *record, bool fast, uint32_t channels)
+{
+	int64_t sample_ms = k_uptime_get();
+	int err;
+
+	/* Submit every sensor at once; the slow reads overlap */
+	err = sensor_async_read(&readings, fast, &channels);
+
+	sensor_record_fill(record, sample_ms, &readings);
+	record->channels = channels;
+	sensor_snapshot_publish(record);
+
+	/* Check alerts before the record waits in a batch or behind the stream */
+	IF_ENABLED(CONFIG_APP_ALERTS, (app_alerts_check(record);));
+
+	return err;
+}
+
+int app_sensors_read_fresh(k_timeout_t timeout)
+{
+	struct sensor_record record;
+	int err;
+
+	err = k_mutex_lock(&acquire_mutex, timeout);
 	if (err) {
-		LOG_ERR("Failed to read from Co2 Sensor SCD4x: %d", err);
-	} else {
-		scd4x_log_measurements(&scd4x_sm);
+		LOG_WRN("Sensors busy, no fresh reading taken: %d", err);
+		return err;
 	}
 
-	/* Read the PM sensor */
-	err = sps30_sensor_read(&sps30_sm);
+	LOG_DBG("Taking a fast reading");
+
+	err = acquire(&record, true, SENSOR_RECORD_CHANNELS_ALL);
+
+	k_mutex_unlock(&acquire_mutex);
+
+	return err;
+}
+
+#ifdef CONFIG_ALUDEL_BATTERY_MONITOR
+/* Read the battery once per cycle, for both the power policy and the battery report */
+static void battery_update(void)
+{
+	struct battery_data data;
+	int err;
+
+	LOG_DBG("Collecting battery measurements...");
+
+	err = read_battery_data(&data);
 	if (err) {
-		LOG_ERR("Failed to read from PM Sensor SPS30: %d", err);
-	} else {
-		sps30_log_measurements(&sps30_sm);
+		LOG_ERR("Failed to read battery data: %d", err);
+		return;
 	}
 
-	/* Send sensor data to Golioth */
-	char *json_buf = malloc(sizeof(char) * JSON_BUF_SIZE);
+	/* A low battery may stretch the period or leave sensors out from this cycle on */
+	IF_ENABLED(CONFIG_APP_POWER_POLICY, (power_policy_update(&data);));
 
-	if (!json_buf) {
-		LOG_ERR("Unable to allocate memory for JSON buffer. Reading will not be sent.");
+	/* The report is paused while a firmware download has priority */
+	if (IS_ENABLED(CONFIG_APP_DFU_PRIORITY) && app_dfu_priority_active()) {
 		return;
 	}
 
-	if (golioth_client_is_connected(client)) {
-		LOG_DBG("Sending sensor data to Golioth");
-
-		snprintk(json_buf, JSON_BUF_SIZE, JSON_FMT,
-			sensor_value_to_double(&bme280_sm.temperature),
-			sensor_value_to_double(&bme280_sm.pressure),
-			sensor_value_to_double(&bme280_sm.humidity), scd4x_sm.co2,
-			sensor_value_to_double(&sps30_sm.mc_1p0), sensor_value_to_double(&sps30_sm.mc_2p5),
-			sensor_value_to_double(&sps30_sm.mc_4p0),
-			sensor_value_to_double(&sps30_sm.mc_10p0),
-			sensor_value_to_double(&sps30_sm.nc_0p5), sensor_value_to_double(&sps30_sm.nc_1p0),
-			sensor_value_to_double(&sps30_sm.nc_2p5), sensor_value_to_double(&sps30_sm.nc_4p0),
-			sensor_value_to_double(&sps30_sm.nc_10p0),
-			sensor_value_to_double(&sps30_sm.typical_particle_size));
-
-		/* LOG_DBG("%s", json_buf); */
-
-		err = golioth_stream_set_async(client,
-					"sensor",
-					GOLIOTH_CONTENT_TYPE_JSON,
-					json_buf,
-					strlen(json_buf),
-					async_error_handler,
-					NULL);
-		if (err) {
-			LOG_ERR("Failed to send sensor data to Golioth: %d", err);
-		}
+	log_battery_data();
+
+	err = stream_battery_data(client, &data);
+	if (err) {
+		LOG_ERR("Failed to stream battery data: %d", err);
+	}
+
+	IF_ENABLED(CONFIG_LIB_OSTENTUS, (
+		app_trace_begin("ostentus", 0);
+		ostentus_slide_set(o_dev,
+				   BATTERY_V,
+				   get_batt_v_str(),
+				   strlen(get_batt_v_str()));
+		ostentus_slide_set(o_dev,
+				   BATTERY_LVL,
+				   get_batt_lvl_str(),
+				   strlen(get_batt_lvl_str()));
+		app_trace_end("ostentus", 0);
+	));
+}
+#endif /* CONFIG_ALUDEL_BATTERY_MONITOR */
+
+/* This will be called by the main() loop */
+/* Do all of your work here! */
+void app_sensors_read_and_stream(void)
+{
+	int err;
+	uint32_t channels;
+	static struct sensor_record record;
+
+	app_trace_begin("cycle", 0);
+
+	/* Settings changed from here on apply to the next cycle */
+	app_settings_refresh();
+
+	/* Golioth custom hardware for demos */
+	IF_ENABLED(CONFIG_ALUDEL_BATTERY_MONITOR, (battery_update();));
+
+	channels = app_schedule_due_channels();
+	IF_ENABLED(CONFIG_APP_POWER_POLICY, (channels &= power_policy_channels();));
+
+	/* Follow the upload interval with the modem's sleep timers */
+	IF_ENABLED(CONFIG_APP_LTE_POLICY, (lte_policy_update(upload_interval_s());));
+
+	LOG_DBG("Collecting sensor measurements...");
+
+	k_mutex_lock(&acquire_mutex, K_FOREVER);
+	err = acquire(&record, false, channels);
+	k_mutex_unlock(&acquire_mutex);
+
+	if (err) {
+		LOG_ERR("Failed to read all sensors: %d", err);
+	}
+
+	/* The processing stage logs and sends the record at its own pace */
+	app_pipeline_publish_record(&record);
+
+	app_trace_end("cycle", err);
+}
+
+void app_sensors_process(const struct sensor_record *record)
+{
+	uint32_t log_start;
+	uint32_t log_cycles;
+
+	IF_ENABLED(CONFIG_APP_HISTORY, (sensor_history_add(record);));
+	IF_ENABLED(CONFIG_APP_AQI, (aqi_nowcast_add(record);));
+
+	log_start = k_cycle_get_32();
+	sensor_record_log(record);
+	log_cycles = k_cycle_get_32() - log_start;
+
+	log_cycle_cost(log_cycles);
+
+	/* Send sensor data to Golioth. Readings taken while disconnected are queued. */
+#ifdef CONFIG_APP_DFU_PRIORITY
+	/* Held during a firmware download, and until the records held before are sent */
+	app_sensors_release_held();
+	if (app_dfu_priority_active() || app_sensors_held()) {
+		record_hold_put(record);
 	} else {
-		LOG_WRN("Device is not connected to Golioth, unable to send sensor data");
+		send_record(record);
 	}
+#else
+	send_record(record);
+#endif
 
+	log_pipeline_stats();
+	log_uplink_stats();
+	log_recovery_stats();
+	IF_ENABLED(CONFIG_APP_SENSOR_SPS30, (log_sps30_stats();));
+	IF_ENABLED(CONFIG_APP_ALERTS, (log_alert_stats();));
+	IF_ENABLED(CONFIG_APP_LTE_POLICY, (log_lte_stats();));
 
 	/* Golioth custom hardware for demos */
-	IF_ENABLED(CONFIG_LIB_OSTENTUS, (
-		/* Update slide values on Ostentus
-		 *  -values should be sent as strings
-		 *  -use the enum from app_sensors.h for slide key values
-		 */
-		snprintk(json_buf, JSON_BUF_SIZE, "%.2f °C",
-			 sensor_value_to_double(&bme280_sm.temperature));
-		ostentus_slide_set(o_dev, TEMPERATURE, json_buf, strlen(json_buf));
-
-		snprintk(json_buf, JSON_BUF_SIZE, "%.2f kPa",
-			 sensor_value_to_double(&bme280_sm.pressure));
-		ostentus_slide_set(o_dev, PRESSURE, json_buf, strlen(json_buf));
-
-		snprintk(json_buf, JSON_BUF_SIZE, "%.2f %%RH",
-			 sensor_value_to_double(&bme280_sm.humidity));
-		ostentus_slide_set(o_dev, HUMIDITY, json_buf, strlen(json_buf));
-
-		snprintk(json_buf, JSON_BUF_SIZE, "%u ppm", scd4x_sm.co2);
-		ostentus_slide_set(o_dev, CO2, json_buf, strlen(json_buf));
-
-		snprintk(json_buf, JSON_BUF_SIZE, "%d ug/m^3", sps30_sm.mc_2p5.val1);
-		ostentus_slide_set(o_dev, PM2P5, json_buf, strlen(json_buf));
-
-		snprintk(json_buf, JSON_BUF_SIZE, "%d ug/m^3", sps30_sm.mc_10p0.val1);
-		ostentus_slide_set(o_dev, PM10P0, json_buf, strlen(json_buf));
-	));
+	IF_ENABLED(CONFIG_LIB_OSTENTUS, (slides_update(record);));
+}
+
+#ifdef CONFIG_APP_UPLINK_BENCHMARK
+void app_sensors_benchmark(void)
+{
+	static struct sensor_record record;
+	struct stream_queue_stats last;
+	struct stream_queue_stats now;
+	struct payload_pool_stats pool;
+	int64_t report_ms;
+	int64_t elapsed_ms;
+
+	while (!client || !golioth_client_is_connected(client)) {
+		k_sleep(K_MSEC(100));
+	}
 
-	free(json_buf);
+	app_settings_refresh();
+
+	k_mutex_lock(&acquire_mutex, K_FOREVER);
+	acquire(&record, false, SENSOR_RECORD_CHANNELS_ALL);
+	k_mutex_unlock(&acquire_mutex);
+
+	LOG_INF("Starting uplink benchmark");
+
+	stream_queue_stats_get(&last);
+	report_ms = k_uptime_get();
+
+	while (true) {
+		/* Only payloads that can be held until their acknowledgment are sent */
+		payload_pool_stats_get(&pool);
+		if (pool.used >= CONFIG_APP_PAYLOAD_POOL_COUNT) {
+			k_sleep(BENCHMARK_POLL_INTERVAL);
+		} else {
+			record.sample_ms = k_uptime_get();
+			send_record(&record);
+		}
+
+		elapsed_ms = k_uptime_get() - report_ms;
+		if (elapsed_ms >= CONFIG_APP_UPLINK_BENCHMARK_REPORT_S * MSEC_PER_SEC) {
+			stream_queue_stats_get(&now);
+			log_benchmark_stats(&record, &last, &now, elapsed_ms);
+			last = now;
+			report_ms += elapsed_ms;
+		}
+	}
 }
+#endif /* CONFIG_APP_UPLINK_BENCHMARK */
 
 void app_sensors_set_client(struct golioth_client *sensors_client)
 {
 	client = sensors_client;
+	stream_queue_set_client(sensors_client);
+	IF_ENABLED(CONFIG_APP_ALERTS, (app_alerts_set_client(sensors_client);));
+	IF_ENABLED(CONFIG_APP_POWER_POLICY, (power_policy_set_client(sensors_client);));
 }
@@ -15,32 +15,66 @@
  */
 
 #include <golioth/client.h>
+#include <zephyr/kernel.h>
+
+#include "sensor_record.h"
 
 void app_sensors_init(void);
 void app_sensors_set_client(struct golioth_client *sensors_client);
+
+/**
+ * Acquire one record and publish it to the processing stage of the sampling
+ * pipeline (see app_pipeline.h).
+ */
 void app_sensors_read_and_stream(void);
 
-#define LABEL_TEMPERATURE "Temperature"
-#define LABEL_PRESSURE	  "Pressure"
-#define LABEL_HUMIDITY	  "Humidity"
-#define LABEL_CO2	  "CO2"
-#define LABEL_PM2P5	  "PM2.5"
-#define LABEL_PM10P0	  "PM10.0"
-#define LABEL_BATTERY	  "Battery"
-#define LABEL_FIRMWARE	  "Firmware"
-#define SUMMARY_TITLE	  "Air Quality"
+/**
+ * Processing stage: add a record to the history and AQI, log it, encode and
+ * publish it to the uplink stage, and update the display.
+ */
+void app_sensors_process(const struct sensor_record *record);
+
+/* Whether the processing stage holds records back from a firmware download */
+bool app_sensors_held(void);
+
+/**
+ * Stream held records, oldest first, once the firmware download is over and
+ * as long as the payload pool has room for them. Called by the processing
+ * stage.
+ */
+void app_sensors_release_held(void);
+
+/**
+ * Take a fast reading outside the sampling schedule and publish it as the
+ * latest snapshot without streaming it. Waits up to `timeout` for a scheduled
+ * reading in progress to finish, then blocks for the reading itself, so it
+ * must not be called from the Golioth client thread.
+ */
+int app_sensors_read_fresh(k_timeout_t timeout);
 
 /**
- * Each Ostentus slide needs a unique key. You may add additional slides by
- * inserting elements with the name of your choice to this enum.
+ * Take one reading once connected, then stream it back to back as fast as
+ * payload buffers are freed, logging throughput every
+ * APP_UPLINK_BENCHMARK_REPORT_S. Does not return.
+ */
+void app_sensors_benchmark(void);
+
+#define LABEL_BATTERY  "Battery"
+#define LABEL_FIRMWARE "Firmware"
+#define LABEL_AQI      "AQI"
+#define SUMMARY_TITLE  "Air Quality"
+
+/**
+ * Each Ostentus slide needs a unique key. Sensor channels with a slide use
+ * their SENSOR_CH_* value as the key (see sensor_channels.h). You may add
+ * additional slides by inserting elements with the name of your choice to
+ * this enum.
  */
 typedef enum {
-	TEMPERATURE,
-	PRESSURE,
-	HUMIDITY,
-	CO2,
-	PM2P5,
-	PM10P0,
+	SLIDE_KEY_CHANNELS_END = SENSOR_CH_COUNT - 1,
+#ifdef CONFIG_APP_AQI
+	AQI,
+#endif
 #ifdef CONFIG_ALUDEL_BATTERY_MONITOR
 	BATTERY_V,
 	BATTERY_LVL,
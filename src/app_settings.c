@@ -7,94 +7,232 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(app_settings, LOG_LEVEL_DBG);
 
+#include <string.h>
 #include <golioth/client.h>
 #include <golioth/settings.h>
-#include "main.h"
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <drivers/sensor/scd4x.h>
+#include "app_schedule.h"
 #include "app_settings.h"
 #include "sensor_scd4x.h"
 #include "sensor_sps30.h"
 
-static int32_t _loop_delay_s = 60;
 #define LOOP_DELAY_S_MAX 43200
 #define LOOP_DELAY_S_MIN 1
 
-static int32_t _scd4x_temperature_offset_s = 4;
-static uint16_t _scd4x_altitude_s;
-static bool _scd4x_asc_s = true;
-static uint32_t _sps30_samples_per_measurement_s = 30;
-static uint32_t _sps30_cleaning_interval_s = 604800;
+#define APP_SETTINGS_DEFAULTS                                                                      \
+	{                                                                                          \
+		.loop_delay_s = 60,                                                                \
+		.env_interval_s = 0,                                                               \
+		.co2_interval_s = 0,                                                               \
+		.pm_interval_s = 0,                                                                \
+		.scd4x_temperature_offset = 4,                                                     \
+		.scd4x_altitude = 0,                                                               \
+		.scd4x_asc = true,                                                                 \
+		.sps30_samples_per_measurement = 30,                                               \
+		.sps30_cleaning_interval_s = 604800,                                               \
+		.sps30_warmup_s = 30,                                                              \
+		.alert_co2_ppm = 1500,                                                             \
+		.alert_co2_hysteresis_ppm = 100,                                                   \
+		.alert_pm2p5_ugm3 = 55,                                                            \
+		.alert_pm2p5_hysteresis_ugm3 = 5,                                                  \
+	}
+
+/* Settings as received, only touched by the Golioth client thread that runs the callbacks */
+static struct app_settings received = APP_SETTINGS_DEFAULTS;
+
+/*
+ * Double-buffered settings behind a sequence counter, as in sensor_snapshot.c:
+ * readers copy the one the single writer is not writing, and retry only if it
+ * preempted them mid-copy.
+ */
+struct settings_seqlock {
+	atomic_t seq;
+	struct app_settings copies[2];
+};
+
+#define SETTINGS_SEQLOCK_INIT {.copies = {APP_SETTINGS_DEFAULTS, APP_SETTINGS_DEFAULTS}}
+
+/* `received` as of the last change, written by the Golioth client thread */
+static struct settings_seqlock received_lock = SETTINGS_SEQLOCK_INIT;
+
+/* Settings of the current cycle, written by the sampling thread and read from any thread */
+static struct settings_seqlock cycle_lock = SETTINGS_SEQLOCK_INIT;
 
-int32_t get_loop_delay_s(void)
+/* The validated settings of the current cycle, only touched by the sampling thread */
+static struct app_settings cycle = APP_SETTINGS_DEFAULTS;
+
+static void seqlock_write(struct settings_seqlock *lock, const struct app_settings *settings)
 {
-	return _loop_delay_s;
+	atomic_inc(&lock->seq);
+	lock->copies[0] = *settings;
+	atomic_inc(&lock->seq);
+	lock->copies[1] = *settings;
 }
 
-int32_t get_scd4x_temperature_offset_s(void)
+static void seqlock_read(struct settings_seqlock *lock, struct app_settings *out)
 {
-	return _scd4x_temperature_offset_s;
+	atomic_val_t start;
+
+	do {
+		start = atomic_get(&lock->seq);
+		memcpy(out, &lock->copies[start & 1], sizeof(*out));
+	} while (atomic_get(&lock->seq) != start);
 }
 
-uint16_t get_scd4x_altitude_s(void)
+static void publish(void)
 {
-	return _scd4x_altitude_s;
+	seqlock_write(&received_lock, &received);
 }
 
-bool get_scd4x_asc_s(void)
+static void read_received(struct app_settings *out)
 {
-	return _scd4x_asc_s;
+	seqlock_read(&received_lock, out);
 }
 
-uint32_t get_sps30_samples_per_measurement_s(void)
+void app_settings_refresh(void)
 {
-	return _sps30_samples_per_measurement_s;
+	struct app_settings next;
+
+	read_received(&next);
+
+	/* Out of range values keep the value of the previous cycle */
+	if ((next.loop_delay_s < LOOP_DELAY_S_MIN) || (next.loop_delay_s > LOOP_DELAY_S_MAX)) {
+		LOG_WRN("Ignoring loop delay of %d seconds", next.loop_delay_s);
+		next.loop_delay_s = cycle.loop_delay_s;
+	}
+
+	if ((next.env_interval_s < 0) || (next.env_interval_s > LOOP_DELAY_S_MAX)) {
+		LOG_WRN("Ignoring environmental sensor interval of %d seconds",
+			next.env_interval_s);
+		next.env_interval_s = cycle.env_interval_s;
+	}
+
+	if ((next.co2_interval_s < 0) || (next.co2_interval_s > LOOP_DELAY_S_MAX)) {
+		LOG_WRN("Ignoring CO₂ sensor interval of %d seconds", next.co2_interval_s);
+		next.co2_interval_s = cycle.co2_interval_s;
+	}
+
+	if ((next.pm_interval_s < 0) || (next.pm_interval_s > LOOP_DELAY_S_MAX)) {
+		LOG_WRN("Ignoring PM sensor interval of %d seconds", next.pm_interval_s);
+		next.pm_interval_s = cycle.pm_interval_s;
+	}
+
+	if (next.sps30_samples_per_measurement < 1) {
+		LOG_WRN("Ignoring %u SPS30 samples per measurement",
+			next.sps30_samples_per_measurement);
+		next.sps30_samples_per_measurement = cycle.sps30_samples_per_measurement;
+	}
+
+	if (next.sps30_warmup_s > LOOP_DELAY_S_MAX) {
+		LOG_WRN("Ignoring SPS30 warm-up time of %u seconds", next.sps30_warmup_s);
+		next.sps30_warmup_s = cycle.sps30_warmup_s;
+	}
+
+	/* An alert must clear above zero, otherwise it would never clear */
+	if ((next.alert_co2_ppm > 0) && (next.alert_co2_hysteresis_ppm >= next.alert_co2_ppm)) {
+		LOG_WRN("Ignoring CO₂ alert hysteresis of %d ppm at a %d ppm threshold",
+			next.alert_co2_hysteresis_ppm, next.alert_co2_ppm);
+		next.alert_co2_ppm = cycle.alert_co2_ppm;
+		next.alert_co2_hysteresis_ppm = cycle.alert_co2_hysteresis_ppm;
+	}
+
+	if ((next.alert_pm2p5_ugm3 > 0) &&
+	    (next.alert_pm2p5_hysteresis_ugm3 >= next.alert_pm2p5_ugm3)) {
+		LOG_WRN("Ignoring PM2.5 alert hysteresis of %d ug/m^3 at a %d ug/m^3 threshold",
+			next.alert_pm2p5_hysteresis_ugm3, next.alert_pm2p5_ugm3);
+		next.alert_pm2p5_ugm3 = cycle.alert_pm2p5_ugm3;
+		next.alert_pm2p5_hysteresis_ugm3 = cycle.alert_pm2p5_hysteresis_ugm3;
+	}
+
+	cycle = next;
+	seqlock_write(&cycle_lock, &cycle);
 }
 
-uint32_t get_sps30_cleaning_interval_s(void)
+void app_settings_get(struct app_settings *settings)
 {
-	return _sps30_cleaning_interval_s;
+	seqlock_read(&cycle_lock, settings);
 }
 
 /* Work items for settings that need to be written to hardware sensors */
+#ifdef CONFIG_APP_SENSOR_SCD4X
 static void scd4x_sensor_set_temperature_offset_work_handler(struct k_work *work)
 {
-	scd4x_sensor_set_temperature_offset(_scd4x_temperature_offset_s);
+	struct app_settings settings;
+
+	read_received(&settings);
+	scd4x_sensor_set_temperature_offset(settings.scd4x_temperature_offset);
 }
 K_WORK_DEFINE(scd4x_sensor_set_temperature_offset_work,
 	      scd4x_sensor_set_temperature_offset_work_handler);
 
 static void scd4x_sensor_set_sensor_altitude_work_handler(struct k_work *work)
 {
-	scd4x_sensor_set_sensor_altitude(_scd4x_altitude_s);
+	struct app_settings settings;
+
+	read_received(&settings);
+	scd4x_sensor_set_sensor_altitude(settings.scd4x_altitude);
 }
 K_WORK_DEFINE(scd4x_sensor_set_sensor_altitude_work, scd4x_sensor_set_sensor_altitude_work_handler);
 
 static void scd4x_sensor_set_automatic_self_calibration_work_handler(struct k_work *work)
 {
-	scd4x_sensor_set_automatic_self_calibration(_scd4x_asc_s);
+	struct app_settings settings;
+
+	read_received(&settings);
+	scd4x_sensor_set_automatic_self_calibration(settings.scd4x_asc);
 }
 K_WORK_DEFINE(scd4x_sensor_set_automatic_self_calibration_work,
 	      scd4x_sensor_set_automatic_self_calibration_work_handler);
+#endif /* CONFIG_APP_SENSOR_SCD4X */
 
+#ifdef CONFIG_APP_SENSOR_SPS30
 static void sps30_sensor_set_fan_auto_cleaning_interval_work_handler(struct k_work *work)
 {
-	sps30_sensor_set_fan_auto_cleaning_interval(_sps30_cleaning_interval_s);
+	struct app_settings settings;
+
+	read_received(&settings);
+	sps30_sensor_set_fan_auto_cleaning_interval(settings.sps30_cleaning_interval_s);
 }
 K_WORK_DEFINE(sps30_sensor_set_fan_auto_cleaning_interval_work,
 	      sps30_sensor_set_fan_auto_cleaning_interval_work_handler);
+#endif /* CONFIG_APP_SENSOR_SPS30 */
 
 static enum golioth_settings_status on_loop_delay_setting(int32_t new_value, void *arg)
 {
-	_loop_delay_s = new_value;
+	received.loop_delay_s = new_value;
+	publish();
 	LOG_INF("Set loop delay to %i seconds", new_value);
-	wake_system_thread();
+	app_schedule_period_changed();
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+
+#ifdef CONFIG_APP_SENSOR_BME280
+static enum golioth_settings_status on_env_interval_setting(int32_t new_value, void *arg)
+{
+	received.env_interval_s = new_value;
+	publish();
+	LOG_INF("Set environmental sensor interval to %i seconds", new_value);
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+#endif /* CONFIG_APP_SENSOR_BME280 */
+
+#ifdef CONFIG_APP_SENSOR_SCD4X
+static enum golioth_settings_status on_co2_interval_setting(int32_t new_value, void *arg)
+{
+	received.co2_interval_s = new_value;
+	publish();
+	LOG_INF("Set CO₂ sensor interval to %i seconds", new_value);
 	return GOLIOTH_SETTINGS_SUCCESS;
 }
 
 static enum golioth_settings_status on_scd4x_temperature_offset_setting(int32_t new_value,
 									void *arg)
 {
-	_scd4x_temperature_offset_s = new_value;
-	LOG_INF("Set SCD4x temperature offset to %i degrees", _scd4x_temperature_offset_s);
+	received.scd4x_temperature_offset = new_value;
+	publish();
+	LOG_INF("Set SCD4x temperature offset to %i degrees", received.scd4x_temperature_offset);
 	/* Submit a work item to write this setting to the sensor */
 	k_work_submit(&scd4x_sensor_set_temperature_offset_work);
 	return GOLIOTH_SETTINGS_SUCCESS;
@@ -102,8 +240,9 @@ static enum golioth_settings_status on_scd4x_temperature_offset_setting(int32_t
 
 static enum golioth_settings_status on_scd4x_altitude_setting(int32_t new_value, void *arg)
 {
-	_scd4x_altitude_s = (uint16_t)new_value;
-	LOG_INF("Set SCD4x altitude to %u feet", _scd4x_altitude_s);
+	received.scd4x_altitude = (uint16_t)new_value;
+	publish();
+	LOG_INF("Set SCD4x altitude to %u feet", received.scd4x_altitude);
 	/* Submit a work item to write this setting to the sensor */
 	k_work_submit(&scd4x_sensor_set_sensor_altitude_work);
 	return GOLIOTH_SETTINGS_SUCCESS;
@@ -111,30 +250,88 @@ static enum golioth_settings_status on_scd4x_altitude_setting(int32_t new_value,
 
 static enum golioth_settings_status on_scd4x_asc_setting(bool new_value, void *arg)
 {
-	_scd4x_asc_s = new_value;
-	LOG_INF("Set SCD4x ASC to %s", _scd4x_asc_s ? "true" : "false");
+	received.scd4x_asc = new_value;
+	publish();
+	LOG_INF("Set SCD4x ASC to %s", received.scd4x_asc ? "true" : "false");
 	/* Submit a work item to write this setting to the sensor */
 	k_work_submit(&scd4x_sensor_set_automatic_self_calibration_work);
 	return GOLIOTH_SETTINGS_SUCCESS;
 }
+#endif /* CONFIG_APP_SENSOR_SCD4X */
+
+#ifdef CONFIG_APP_SENSOR_SPS30
+static enum golioth_settings_status on_pm_interval_setting(int32_t new_value, void *arg)
+{
+	received.pm_interval_s = new_value;
+	publish();
+	LOG_INF("Set PM sensor interval to %i seconds", new_value);
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
 
 static enum golioth_settings_status on_sps30_samples_per_measurement_setting(int32_t new_value,
 									     void *arg)
 {
-	_sps30_samples_per_measurement_s = (uint32_t)new_value;
-	LOG_INF("Set SPS30 samples per measurement to %i", _sps30_samples_per_measurement_s);
+	received.sps30_samples_per_measurement = (uint32_t)new_value;
+	publish();
+	LOG_INF("Set SPS30 samples per measurement to %i", received.sps30_samples_per_measurement);
 	return GOLIOTH_SETTINGS_SUCCESS;
 }
 
 static enum golioth_settings_status on_sps30_cleaning_interval_setting(int32_t new_value, void *arg)
 {
-	_sps30_cleaning_interval_s = (uint32_t)new_value;
-	LOG_INF("Set SPS30 cleaning interval to %i seconds", _sps30_cleaning_interval_s);
+	received.sps30_cleaning_interval_s = (uint32_t)new_value;
+	publish();
+	LOG_INF("Set SPS30 cleaning interval to %i seconds", received.sps30_cleaning_interval_s);
 	/* Submit a work item to write this setting to the sensor */
 	k_work_submit(&sps30_sensor_set_fan_auto_cleaning_interval_work);
 	return GOLIOTH_SETTINGS_SUCCESS;
 }
 
+static enum golioth_settings_status on_sps30_warmup_setting(int32_t new_value, void *arg)
+{
+	received.sps30_warmup_s = (uint32_t)new_value;
+	publish();
+	LOG_INF("Set SPS30 warm-up time to %i seconds", received.sps30_warmup_s);
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+#endif /* CONFIG_APP_SENSOR_SPS30 */
+
+#if defined(CONFIG_APP_ALERTS) && defined(CONFIG_APP_SENSOR_SCD4X)
+static enum golioth_settings_status on_alert_co2_setting(int32_t new_value, void *arg)
+{
+	received.alert_co2_ppm = new_value;
+	publish();
+	LOG_INF("Set CO₂ alert threshold to %i ppm", received.alert_co2_ppm);
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+
+static enum golioth_settings_status on_alert_co2_hysteresis_setting(int32_t new_value, void *arg)
+{
+	received.alert_co2_hysteresis_ppm = new_value;
+	publish();
+	LOG_INF("Set CO₂ alert hysteresis to %i ppm", received.alert_co2_hysteresis_ppm);
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+#endif
+
+#if defined(CONFIG_APP_ALERTS) && defined(CONFIG_APP_SENSOR_SPS30)
+static enum golioth_settings_status on_alert_pm2p5_setting(int32_t new_value, void *arg)
+{
+	received.alert_pm2p5_ugm3 = new_value;
+	publish();
+	LOG_INF("Set PM2.5 alert threshold to %i ug/m^3", received.alert_pm2p5_ugm3);
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+
+static enum golioth_settings_status on_alert_pm2p5_hysteresis_setting(int32_t new_value, void *arg)
+{
+	received.alert_pm2p5_hysteresis_ugm3 = new_value;
+	publish();
+	LOG_INF("Set PM2.5 alert hysteresis to %i ug/m^3", received.alert_pm2p5_hysteresis_ugm3);
+	return GOLIOTH_SETTINGS_SUCCESS;
+}
+#endif
+
 int app_settings_register(struct golioth_client *client)
 {
 	int err;
@@ -152,10 +349,35 @@ int app_settings_register(struct golioth_client *client)
 		return err;
 	}
 
+#ifdef CONFIG_APP_SENSOR_BME280
+	err = golioth_settings_register_int_with_range(settings,
+							   "ENV_INTERVAL_S",
+							   0,
+							   LOOP_DELAY_S_MAX,
+							   on_env_interval_setting,
+							   NULL);
+	if (err) {
+		LOG_ERR("Failed to register on_env_interval_setting callback: %d", err);
+		return err;
+	}
+#endif /* CONFIG_APP_SENSOR_BME280 */
+
+#ifdef CONFIG_APP_SENSOR_SCD4X
+	err = golioth_settings_register_int_with_range(settings,
+							   "CO2_INTERVAL_S",
+							   0,
+							   LOOP_DELAY_S_MAX,
+							   on_co2_interval_setting,
+							   NULL);
+	if (err) {
+		LOG_ERR("Failed to register on_co2_interval_setting callback: %d", err);
+		return err;
+	}
+
 	err = golioth_settings_register_int_with_range(settings,
 							   "CO2_SENSOR_TEMPERATURE_OFFSET",
-							   INT32_MIN,
-							   INT32_MAX,
+							   0,
+							   SCD4X_TEMPERATURE_OFFSET_MAX_MILLI,
 							   on_scd4x_temperature_offset_setting,
 							   NULL);
 	if (err) {
@@ -182,10 +404,23 @@ int app_settings_register(struct golioth_client *client)
 		LOG_ERR("Failed to register on_scd4x_asc_setting callback: %d", err);
 		return err;
 	}
+#endif /* CONFIG_APP_SENSOR_SCD4X */
 
+#ifdef CONFIG_APP_SENSOR_SPS30
 	err = golioth_settings_register_int_with_range(settings,
-							   "PM_SENSOR_SAMPLES_PER_MEASUREMENT",
+							   "PM_INTERVAL_S",
 							   0,
+							   LOOP_DELAY_S_MAX,
+							   on_pm_interval_setting,
+							   NULL);
+	if (err) {
+		LOG_ERR("Failed to register on_pm_interval_setting callback: %d", err);
+		return err;
+	}
+
+	err = golioth_settings_register_int_with_range(settings,
+							   "PM_SENSOR_SAMPLES_PER_MEASUREMENT",
+							   1,
 							   INT32_MAX,
 							   on_sps30_samples_per_measurement_setting,
 							   NULL);
@@ -206,5 +441,65 @@ int app_settings_register(struct golioth_client *client)
 		return err;
 	}
 
+	err = golioth_settings_register_int_with_range(settings,
+							   "PM_SENSOR_WARMUP_S",
+							   0,
+							   LOOP_DELAY_S_MAX,
+							   on_sps30_warmup_setting,
+							   NULL);
+	if (err) {
+		LOG_ERR("Failed to register on_sps30_warmup_setting callback: %d", err);
+		return err;
+	}
+#endif /* CONFIG_APP_SENSOR_SPS30 */
+
+#if defined(CONFIG_APP_ALERTS) && defined(CONFIG_APP_SENSOR_SCD4X)
+	err = golioth_settings_register_int_with_range(settings,
+							   "ALERT_CO2_PPM",
+							   0,
+							   40000,
+							   on_alert_co2_setting,
+							   NULL);
+	if (err) {
+		LOG_ERR("Failed to register on_alert_co2_setting callback: %d", err);
+		return err;
+	}
+
+	err = golioth_settings_register_int_with_range(settings,
+							   "ALERT_CO2_HYSTERESIS_PPM",
+							   0,
+							   40000,
+							   on_alert_co2_hysteresis_setting,
+							   NULL);
+	if (err) {
+		LOG_ERR("Failed to register on_alert_co2_hysteresis_setting callback: %d", err);
+		return err;
+	}
+#endif
+
+#if defined(CONFIG_APP_ALERTS) && defined(CONFIG_APP_SENSOR_SPS30)
+	err = golioth_settings_register_int_with_range(settings,
+							   "ALERT_PM2P5_UGM3",
+							   0,
+							   1000,
+							   on_alert_pm2p5_setting,
+							   NULL);
+	if (err) {
+		LOG_ERR("Failed to register on_alert_pm2p5_setting callback: %d", err);
+		return err;
+	}
+
+	err = golioth_settings_register_int_with_range(settings,
+							   "ALERT_PM2P5_HYSTERESIS_UGM3",
+							   0,
+							   1000,
+							   on_alert_pm2p5_hysteresis_setting,
+							   NULL);
+	if (err) {
+		LOG_ERR("Failed to register on_alert_pm2p5_hysteresis_setting callback: %d", err);
+		return err;
+	}
+#endif
+
 	return 0;
 }
@@ -9,19 +9,55 @@
  * to Golioth to indicate the success or failure of the update.
  *
  * https://docs.golioth.io/firmware/zephyr-device-sdk/device-settings-service
+ *
+ * Changes are received on the Golioth client thread but only take effect at
+ * the start of a cycle: the sampling thread calls app_settings_refresh() to
+ * take a consistent, validated copy of all settings, and app_settings_get()
+ * returns that copy until the next refresh. It may be called from any thread,
+ * e.g. by a fresh read for an RPC or by the alert checks, never waits, and
+ * always returns every field from the same refresh.
  */
 
 #ifndef __APP_SETTINGS_H__
 #define __APP_SETTINGS_H__
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
-#include <golioth/client.h>
 
-int32_t get_loop_delay_s(void);
+struct golioth_client;
+
+struct app_settings {
+	int32_t loop_delay_s;
+	/* Per-sensor read intervals, 0 reads the sensor every cycle */
+	int32_t env_interval_s;
+	int32_t co2_interval_s;
+	int32_t pm_interval_s;
+	int32_t scd4x_temperature_offset;
+	uint16_t scd4x_altitude;
+	bool scd4x_asc;
+	uint32_t sps30_samples_per_measurement;
+	uint32_t sps30_cleaning_interval_s;
+	uint32_t sps30_warmup_s;
+	/* Alert thresholds in whole units of the channel, 0 disables the alert */
+	int32_t alert_co2_ppm;
+	int32_t alert_co2_hysteresis_ppm;
+	int32_t alert_pm2p5_ugm3;
+	int32_t alert_pm2p5_hysteresis_ugm3;
+};
+
 int app_settings_register(struct golioth_client *client);
-int32_t get_scd4x_temperature_offset_s(void);
-uint16_t get_scd4x_altitude_s(void);
-bool get_scd4x_asc_s(void);
-uint32_t get_sps30_samples_per_measurement_s(void);
+
+/* Take the settings received so far; values that fail validation keep their previous value */
+void app_settings_refresh(void);
+
+/* Copy the settings of the current cycle */
+void app_settings_get(struct app_settings *settings);
+
+/* Read the int32_t field at `offset`, for tables that select a setting with offsetof() */
+static inline int32_t app_settings_s32(const struct app_settings *settings, size_t offset)
+{
+	return *(const int32_t *)((const uint8_t *)settings + offset);
+}
 
 #endif /* __APP_SETTINGS_H__ */
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(app_time, LOG_LEVEL_DBG);
+
+#include <time.h>
+#include <zephyr/kernel.h>
+
+#ifdef CONFIG_DATE_TIME
+#include <date_time.h>
+#elif defined(CONFIG_SNTP)
+#include <zephyr/net/sntp.h>
+#endif
+
+#include "app_time.h"
+
+#ifdef CONFIG_DATE_TIME
+
+/* date_time tracks modem network time and NTP against the uptime counter */
+static int unix_offset_get(int64_t *offset_ms)
+{
+	int64_t unix_ms;
+	int64_t uptime_ms = k_uptime_get();
+	int err;
+
+	err = date_time_now(&unix_ms);
+	if (err) {
+		return err;
+	}
+
+	*offset_ms = unix_ms - uptime_ms;
+
+	return 0;
+}
+
+void app_time_init(void)
+{
+	/* Time updates are handled by the date_time library */
+}
+
+#elif defined(CONFIG_SNTP)
+
+#define SNTP_TIMEOUT_MS 3000
+
+/* Written by the system workqueue, read from any thread */
+static struct k_spinlock sntp_lock;
+static int64_t sntp_offset_ms;
+static bool sntp_synced;
+
+static void sntp_work_handler(struct k_work *work);
+K_WORK_DELAYABLE_DEFINE(sntp_work, sntp_work_handler);
+
+static void sntp_work_handler(struct k_work *work)
+{
+	struct sntp_time ts;
+	k_spinlock_key_t key;
+	int64_t uptime_ms;
+	int64_t offset_ms;
+	int err;
+
+	err = sntp_simple(CONFIG_APP_TIME_SNTP_SERVER, SNTP_TIMEOUT_MS, &ts);
+	uptime_ms = k_uptime_get();
+
+	if (err) {
+		LOG_WRN("SNTP query failed: %d", err);
+		k_work_schedule(&sntp_work, K_SECONDS(60));
+		return;
+	}
+
+	offset_ms = (int64_t)ts.seconds * MSEC_PER_SEC +
+		    (((uint64_t)ts.fraction * MSEC_PER_SEC) >> 32) - uptime_ms;
+
+	key = k_spin_lock(&sntp_lock);
+	sntp_offset_ms = offset_ms;
+	sntp_synced = true;
+	k_spin_unlock(&sntp_lock, key);
+
+	LOG_DBG("SNTP time synchronized");
+
+	k_work_schedule(&sntp_work, K_SECONDS(CONFIG_APP_TIME_SNTP_RESYNC_S));
+}
+
+static int unix_offset_get(int64_t *offset_ms)
+{
+	k_spinlock_key_t key = k_spin_lock(&sntp_lock);
+	int err = 0;
+
+	if (sntp_synced) {
+		*offset_ms = sntp_offset_ms;
+	} else {
+		err = -ENODATA;
+	}
+
+	k_spin_unlock(&sntp_lock, key);
+
+	return err;
+}
+
+void app_time_init(void)
+{
+	k_work_schedule(&sntp_work, K_NO_WAIT);
+}
+
+#else
+
+static int unix_offset_get(int64_t *offset_ms)
+{
+	return -ENOTSUP;
+}
+
+void app_time_init(void)
+{
+}
+
+#endif /* CONFIG_DATE_TIME */
+
+int app_time_uptime_to_unix_ms(int64_t uptime_ms, int64_t *unix_ms)
+{
+	int64_t offset_ms;
+	int err;
+
+	err = unix_offset_get(&offset_ms);
+	if (err) {
+		return err;
+	}
+
+	*unix_ms = uptime_ms + offset_ms;
+
+	return 0;
+}
+
+int app_time_unix_to_uptime_ms(int64_t unix_ms, int64_t *uptime_ms)
+{
+	int64_t offset_ms;
+	int err;
+
+	err = unix_offset_get(&offset_ms);
+	if (err) {
+		return err;
+	}
+
+	*uptime_ms = unix_ms - offset_ms;
+
+	return 0;
+}
+
+int app_time_format_rfc3339(int64_t unix_ms, char *buf, size_t len)
+{
+	time_t seconds = (time_t)(unix_ms / MSEC_PER_SEC);
+	struct tm tm;
+	int ret;
+
+	if (gmtime_r(&seconds, &tm) == NULL) {
+		return -EINVAL;
+	}
+
+	ret = snprintk(buf, len, "%04d-%02d-%02dT%02d:%02d:%02d.%03dZ", tm.tm_year + 1900,
+		       tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+		       (int)(unix_ms % MSEC_PER_SEC));
+	if ((ret < 0) || ((size_t)ret >= len)) {
+		return -ENOMEM;
+	}
+
+	return 0;
+}
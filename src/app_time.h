@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Wall-clock time for timestamping samples at acquisition.
+ *
+ * Network time (from the modem or NTP via the nRF Connect SDK date_time
+ * library, or from SNTP on other platforms) is kept as an offset to the
+ * kernel uptime counter, so an uptime captured when a sample was taken can be
+ * converted to Unix time at any later point.
+ */
+
+#ifndef __APP_TIME_H__
+#define __APP_TIME_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* "YYYY-MM-DDTHH:MM:SS.mmmZ" plus NUL */
+#define APP_TIME_RFC3339_LEN 25
+
+void app_time_init(void);
+int app_time_uptime_to_unix_ms(int64_t uptime_ms, int64_t *unix_ms);
+int app_time_unix_to_uptime_ms(int64_t unix_ms, int64_t *uptime_ms);
+int app_time_format_rfc3339(int64_t unix_ms, char *buf, size_t len);
+
+#endif /* __APP_TIME_H__ */
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Named trace spans for offline profiling.
+ *
+ * With CONFIG_APP_TRACE, the start and end of each span are emitted as CTF
+ * "named_event" records alongside the kernel events of Zephyr's CTF tracing.
+ * The first argument of the event is APP_TRACE_BEGIN or APP_TRACE_END, the
+ * second a value specific to the span (a result, a length). CTF truncates
+ * names to 19 characters. The Sensirion drivers emit their own spans the same
+ * way (see sensirion_common.h).
+ */
+
+#ifndef __APP_TRACE_H__
+#define __APP_TRACE_H__
+
+#include <stdint.h>
+#include <zephyr/toolchain.h>
+#ifdef CONFIG_APP_TRACE
+#include <zephyr/tracing/tracing.h>
+#endif
+
+#define APP_TRACE_BEGIN 0
+#define APP_TRACE_END	1
+
+static inline void app_trace_begin(const char *name, uint32_t arg)
+{
+#ifdef CONFIG_APP_TRACE
+	sys_trace_named_event(name, APP_TRACE_BEGIN, arg);
+#else
+	ARG_UNUSED(name);
+	ARG_UNUSED(arg);
+#endif
+}
+
+static inline void app_trace_end(const char *name, uint32_t arg)
+{
+#ifdef CONFIG_APP_TRACE
+	sys_trace_named_event(name, APP_TRACE_END, arg);
+#else
+	ARG_UNUSED(name);
+	ARG_UNUSED(arg);
+#endif
+}
+
+#endif /* __APP_TRACE_H__ */
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(aqi_nowcast, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#include "aqi_nowcast.h"
+
+#define NOWCAST_HOURS 12
+
+/* Weights are Q16 fixed point; PM uses a minimum weight of 1/2 */
+#define WEIGHT_ONE BIT(16)
+#define WEIGHT_MIN (WEIGHT_ONE / 2)
+
+enum pollutant {
+	PM2P5,
+	PM10,
+	POLLUTANT_COUNT
+};
+
+struct hour_sums {
+	uint32_t hour;
+	uint32_t samples;
+	/* Tenths of ug/m^3 */
+	int32_t sums[POLLUTANT_COUNT];
+};
+
+/* Concentrations in tenths of ug/m^3 */
+struct aqi_breakpoint {
+	int32_t c_lo;
+	int32_t c_hi;
+	uint16_t i_lo;
+	uint16_t i_hi;
+};
+
+/* clang-format off */
+static const struct aqi_breakpoint pm2p5_breakpoints[] = {
+	{0, 90, 0, 50},
+	{91, 354, 51, 100},
+	{355, 554, 101, 150},
+	{555, 1254, 151, 200},
+	{1255, 2254, 201, 300},
+	{2255, 3254, 301, 500},
+};
+
+static const struct aqi_breakpoint pm10_breakpoints[] = {
+	{0, 540, 0, 50},
+	{550, 1540, 51, 100},
+	{1550, 2540, 101, 150},
+	{2550, 3540, 151, 200},
+	{3550, 4240, 201, 300},
+	{4250, 6040, 301, 500},
+};
+/* clang-format on */
+
+static const char *const category_names[] = {
+	[AQI_GOOD] = "Good",
+	[AQI_MODERATE] = "Moderate",
+	[AQI_UNHEALTHY_SENSITIVE] = "Unhealthy for Sensitive Groups",
+	[AQI_UNHEALTHY] = "Unhealthy",
+	[AQI_VERY_UNHEALTHY] = "Very Unhealthy",
+	[AQI_HAZARDOUS] = "Hazardous",
+};
+
+static const enum sensor_record_channel channels[POLLUTANT_COUNT] = {
+	[PM2P5] = SENSOR_CH_MC_2P5,
+	[PM10] = SENSOR_CH_MC_10P0,
+};
+
+/* Index 0 is the hour in progress */
+static struct hour_sums hours[NOWCAST_HOURS];
+static bool started;
+
+static struct aqi_nowcast latest;
+static bool latest_valid;
+K_MUTEX_DEFINE(nowcast_mutex);
+
+static int32_t to_tenths(int32_t value, int8_t exponent)
+{
+	for (int i = exponent; i > -1; i--) {
+		value *= 10;
+	}
+	for (int i = exponent; i < -1; i++) {
+		value /= 10;
+	}
+
+	return value;
+}
+
+/* Move to a new hour, keeping an empty slot for every hour without readings */
+static void hours_advance(uint32_t hour)
+{
+	uint32_t shift = MIN(hour - hours[0].hour, NOWCAST_HOURS);
+
+	memmove(&hours[shift], &hours[0], (NOWCAST_HOURS - shift) * sizeof(hours[0]));
+	memset(&hours[0], 0, shift * sizeof(hours[0]));
+
+	for (uint32_t i = 0; i < shift; i++) {
+		hours[i].hour = hour - i;
+	}
+}
+
+/* NowCast concentration in tenths of ug/m^3, or -1 if there is not enough data */
+static int32_t nowcast_compute(enum pollutant p)
+{
+	int32_t avg[NOWCAST_HOURS];
+	int32_t c_min = INT32_MAX;
+	int32_t c_max = 0;
+	uint64_t weight_pow = WEIGHT_ONE;
+	uint64_t num = 0;
+	uint64_t den = 0;
+	uint32_t weight;
+	int recent = 0;
+
+	for (int i = 0; i < NOWCAST_HOURS; i++) {
+		if (hours[i].samples == 0) {
+			avg[i] = -1;
+			continue;
+		}
+
+		avg[i] = MAX(hours[i].sums[p] / (int32_t)hours[i].samples, 0);
+		c_min = MIN(c_min, avg[i]);
+		c_max = MAX(c_max, avg[i]);
+
+		if (i < 3) {
+			recent++;
+		}
+	}
+
+	if (recent < 2) {
+		return -1;
+	}
+
+	weight = (c_max > 0) ? (uint32_t)(((uint64_t)c_min << 16) / c_max) : WEIGHT_ONE;
+	weight = MAX(weight, WEIGHT_MIN);
+
+	for (int i = 0; i < NOWCAST_HOURS; i++) {
+		if (avg[i] >= 0) {
+			num += weight_pow * avg[i];
+			den += weight_pow;
+		}
+
+		weight_pow = (weight_pow * weight) >> 16;
+	}
+
+	return (int32_t)(num / den);
+}
+
+static uint16_t aqi_compute(int32_t c, const struct aqi_breakpoint *bp, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		if (c <= bp[i].c_hi) {
+			int32_t span_c = bp[i].c_hi - bp[i].c_lo;
+			int32_t span_i = bp[i].i_hi - bp[i].i_lo;
+
+			c = MAX(c, bp[i].c_lo);
+
+			return bp[i].i_lo + (span_i * (c - bp[i].c_lo) + span_c / 2) / span_c;
+		}
+	}
+
+	/* Beyond the AQI scale */
+	return bp[count - 1].i_hi;
+}
+
+static enum aqi_category category_for(uint16_t aqi)
+{
+	static const uint16_t upper[] = {50, 100, 150, 200, 300};
+
+	for (size_t i = 0; i < ARRAY_SIZE(upper); i++) {
+		if (aqi <= upper[i]) {
+			return i;
+		}
+	}
+
+	return AQI_HAZARDOUS;
+}
+
+void aqi_nowcast_add(const struct sensor_record *record)
+{
+	uint32_t hour = (uint32_t)(record->sample_ms / (MSEC_PER_SEC * 3600));
+	struct aqi_nowcast nowcast;
+	int32_t pm2p5;
+	int32_t pm10;
+
+	/* Only fresh PM readings count towards the hourly averages */
+	if (!(record->channels & SENSOR_RECORD_CHANNELS_SPS30)) {
+		return;
+	}
+
+	if (!started) {
+		hours[0].hour = hour;
+		started = true;
+	} else if (hour != hours[0].hour) {
+		hours_advance(hour);
+	}
+
+	for (int p = 0; p < POLLUTANT_COUNT; p++) {
+		const struct sensor_record_channel_info *ch = &sensor_record_channels[channels[p]];
+
+		hours[0].sums[p] += to_tenths(record->values[channels[p]], ch->exponent);
+	}
+	hours[0].samples++;
+
+	pm2p5 = nowcast_compute(PM2P5);
+	pm10 = nowcast_compute(PM10);
+	if ((pm2p5 < 0) || (pm10 < 0)) {
+		LOG_DBG("Not enough hourly data for NowCast yet");
+		return;
+	}
+
+	/* PM10 NowCast is truncated to whole ug/m^3 */
+	pm10 = (pm10 / 10) * 10;
+
+	nowcast.nowcast_pm2p5 = pm2p5;
+	nowcast.nowcast_pm10 = pm10;
+	nowcast.aqi_pm2p5 = aqi_compute(pm2p5, pm2p5_breakpoints, ARRAY_SIZE(pm2p5_breakpoints));
+	nowcast.aqi_pm10 = aqi_compute(pm10, pm10_breakpoints, ARRAY_SIZE(pm10_breakpoints));
+	nowcast.aqi = MAX(nowcast.aqi_pm2p5, nowcast.aqi_pm10);
+	nowcast.category = category_for(nowcast.aqi);
+
+	k_mutex_lock(&nowcast_mutex, K_FOREVER);
+	latest = nowcast;
+	latest_valid = true;
+	k_mutex_unlock(&nowcast_mutex);
+
+	LOG_DBG("NowCast AQI %u (%s): PM2.5 %d.%d ug/m^3 (AQI %u), PM10 %d ug/m^3 (AQI %u)",
+		nowcast.aqi, aqi_category_name(nowcast.category), pm2p5 / 10, pm2p5 % 10,
+		nowcast.aqi_pm2p5, pm10 / 10, nowcast.aqi_pm10);
+}
+
+bool aqi_nowcast_get(struct aqi_nowcast *nowcast)
+{
+	bool valid;
+
+	k_mutex_lock(&nowcast_mutex, K_FOREVER);
+	*nowcast = latest;
+	valid = latest_valid;
+	k_mutex_unlock(&nowcast_mutex);
+
+	return valid;
+}
+
+const char *aqi_category_name(enum aqi_category category)
+{
+	return category_names[category];
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * US EPA NowCast Air Quality Index from the SPS30 PM2.5 and PM10 readings.
+ *
+ * Readings are summed into a ring of the last 12 clock hours of uptime. Each
+ * cycle the NowCast concentration of both pollutants is computed from the
+ * hourly averages, with the hour in progress as the most recent hour, and
+ * converted to an AQI with the 2024 EPA breakpoints. The reported AQI is the
+ * higher of the two. Everything is done in integer arithmetic.
+ *
+ * See the EPA Technical Assistance Document for the Reporting of Daily Air
+ * Quality (AQI) for the NowCast method and the breakpoints.
+ */
+
+#ifndef __AQI_NOWCAST_H__
+#define __AQI_NOWCAST_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sensor_record.h"
+
+enum aqi_category {
+	AQI_GOOD,
+	AQI_MODERATE,
+	AQI_UNHEALTHY_SENSITIVE,
+	AQI_UNHEALTHY,
+	AQI_VERY_UNHEALTHY,
+	AQI_HAZARDOUS,
+};
+
+struct aqi_nowcast {
+	uint16_t aqi;
+	enum aqi_category category;
+	uint16_t aqi_pm2p5;
+	uint16_t aqi_pm10;
+	/* NowCast concentrations in tenths of ug/m^3 */
+	int32_t nowcast_pm2p5;
+	int32_t nowcast_pm10;
+};
+
+void aqi_nowcast_add(const struct sensor_record *record);
+
+/**
+ * Get the latest NowCast AQI.
+ *
+ * @return false until two of the three most recent hours have readings
+ */
+bool aqi_nowcast_get(struct aqi_nowcast *nowcast);
+
+const char *aqi_category_name(enum aqi_category category);
+
+#endif /* __AQI_NOWCAST_H__ */
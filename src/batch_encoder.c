@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(batch_encoder, LOG_LEVEL_DBG);
+
+#include <zcbor_encode.h>
+#include <zephyr/kernel.h>
+
+#include "batch_encoder.h"
+#include "app_time.h"
+
+/* A zig-zag encoded 64-bit delta takes at most 10 varint bytes */
+#define VARINT_MAX_LEN 10
+
+/* Scratch buffers, shared by live batches and history uploads */
+K_MUTEX_DEFINE(scratch_mutex);
+static int64_t column[BATCH_ENCODER_MAX_RECORDS];
+static uint8_t deltas[(BATCH_ENCODER_MAX_RECORDS - 1) * VARINT_MAX_LEN + 1];
+static uint8_t present[DIV_ROUND_UP(BATCH_ENCODER_MAX_RECORDS, 8)];
+
+static size_t varint_put(uint8_t *out, int64_t value)
+{
+	uint64_t zigzag = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+	size_t len = 0;
+
+	do {
+		uint8_t byte = zigzag & 0x7f;
+
+		zigzag >>= 7;
+		out[len++] = byte | (zigzag ? 0x80 : 0);
+	} while (zigzag);
+
+	return len;
+}
+
+/* Encode `count` values from `column` as "<name>": {["e": exp,] ["p": present,] "b": base,
+ * "d": deltas}, with the first `present_len` bytes of `present` unless `present_len` is 0
+ */
+static bool encode_column(zcbor_state_t *zse, const char *name, size_t count,
+			  const int8_t *exponent, size_t present_len)
+{
+	size_t len = 0;
+
+	for (size_t i = 1; i < count; i++) {
+		len += varint_put(&deltas[len], column[i] - column[i - 1]);
+	}
+
+	return zcbor_tstr_encode_ptr(zse, name, strlen(name)) &&
+	       zcbor_map_start_encode(zse, 4) &&
+	       (!exponent || (zcbor_tstr_put_lit(zse, "e") && zcbor_int32_put(zse, *exponent))) &&
+	       ((present_len == 0) ||
+		(zcbor_tstr_put_lit(zse, "p") &&
+		 zcbor_bstr_encode_ptr(zse, (const char *)present, present_len))) &&
+	       zcbor_tstr_put_lit(zse, "b") && zcbor_int64_put(zse, column[0]) &&
+	       zcbor_tstr_put_lit(zse, "d") && zcbor_bstr_encode_ptr(zse, (const char *)deltas, len) &&
+	       zcbor_map_end_encode(zse, 4);
+}
+
+/* Fill `column` with the values of a channel in the records that read it, and `present` with
+ * a bitmap of those records. Returns the number of values.
+ */
+static size_t channel_column_fill(const struct sensor_record *records, size_t count, size_t ch)
+{
+	size_t n = 0;
+
+	memset(present, 0, sizeof(present));
+
+	for (size_t i = 0; i < count; i++) {
+		if (records[i].channels & BIT(ch)) {
+			column[n++] = records[i].values[ch];
+			present[i / 8] |= BIT(i % 8);
+		}
+	}
+
+	return n;
+}
+
+/* Fill `column` with Unix times for an uptime field of each record */
+static int time_column_fill(const struct sensor_record *records, size_t count, size_t offset)
+{
+	for (size_t i = 0; i < count; i++) {
+		const int64_t *uptime_ms = (const int64_t *)((const uint8_t *)&records[i] + offset);
+		int err = app_time_uptime_to_unix_ms(*uptime_ms, &column[i]);
+
+		if (err) {
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static int encode(const struct sensor_record *records, size_t count, uint8_t *buf, size_t buf_len,
+		  size_t *encoded_len)
+{
+	static const struct {
+		const char *name;
+		size_t offset;
+	} time_columns[] = {
+		{"time", offsetof(struct sensor_record, sample_ms)},
+		{"win_start", offsetof(struct sensor_record, win_start_ms)},
+		{"win_end", offsetof(struct sensor_record, win_end_ms)},
+	};
+	size_t samples = 0;
+	bool has_time = true;
+	bool ok;
+
+	if ((count == 0) || (count > BATCH_ENCODER_MAX_RECORDS)) {
+		return -EINVAL;
+	}
+
+	ZCBOR_STATE_E(zse, 2, buf, buf_len, 1);
+
+	ok = zcbor_map_start_encode(zse, 2 + ARRAY_SIZE(time_columns) + SENSOR_CH_COUNT) &&
+	     zcbor_tstr_put_lit(zse, "v") && zcbor_uint32_put(zse, BATCH_ENCODER_VERSION) &&
+	     zcbor_tstr_put_lit(zse, "n") && zcbor_uint32_put(zse, count);
+
+	/* Convert uptimes at encode time so records taken before time sync still get stamped */
+	for (size_t c = 0; ok && has_time && (c < ARRAY_SIZE(time_columns)); c++) {
+		if (time_column_fill(records, count, time_columns[c].offset)) {
+			LOG_WRN("Wall-clock time not available, batch will use arrival time");
+			has_time = false;
+			break;
+		}
+
+		ok = encode_column(zse, time_columns[c].name, count, NULL, 0);
+	}
+
+	/* Channels a record did not read hold stale values, so they are left out of the column */
+	for (size_t ch = 0; ok && (ch < SENSOR_CH_COUNT); ch++) {
+		size_t n = channel_column_fill(records, count, ch);
+
+		if (n == 0) {
+			continue;
+		}
+
+		ok = encode_column(zse, sensor_record_channels[ch].name, n,
+				   &sensor_record_channels[ch].exponent,
+				   (n < count) ? DIV_ROUND_UP(count, 8) : 0);
+		samples += n;
+	}
+
+	ok = ok && zcbor_map_end_encode(zse, 2 + ARRAY_SIZE(time_columns) + SENSOR_CH_COUNT);
+	if (!ok) {
+		return -ENOMEM;
+	}
+
+	*encoded_len = zse->payload - buf;
+
+	samples = MAX(samples, 1);
+	LOG_DBG("Encoded %u records in %u bytes (%u.%02u bytes per channel-sample)", count,
+		*encoded_len, *encoded_len / samples, (*encoded_len * 100 / samples) % 100);
+
+	return 0;
+}
+
+int batch_encoder_encode(const struct sensor_record *records, size_t count, uint8_t *buf,
+			 size_t buf_len, size_t *encoded_len)
+{
+	int err;
+
+	k_mutex_lock(&scratch_mutex, K_FOREVER);
+	err = encode(records, count, buf, buf_len, encoded_len);
+	k_mutex_unlock(&scratch_mutex);
+
+	return err;
+}
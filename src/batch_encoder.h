@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Columnar CBOR encoding for batches of sensor records.
+ *
+ * A batch is a CBOR map with one entry per channel. Each channel is stored
+ * as a base value followed by zig-zag LEB128 varint deltas between consecutive
+ * records, using the fixed-point exponent from sensor_record_channels:
+ *
+ *   {
+ *     "v": 2,                                  format version
+ *     "n": <records>,
+ *     "time":      {"b": <unix ms>, "d": <bstr deltas>},   (only when wall-clock
+ *     "win_start": {"b": <unix ms>, "d": <bstr deltas>},    time is known)
+ *     "win_end":   {"b": <unix ms>, "d": <bstr deltas>},
+ *     "<channel>": {"e": <exponent>, "p": <bstr>, "b": <base>, "d": <bstr deltas>},
+ *     ...
+ *   }
+ *
+ * A channel only holds values for the records that read it (see
+ * sensor_record.channels). When some records did not, "p" is a bitmap of the
+ * records that did, one bit per record starting with the least significant
+ * bit of the first byte, and the values belong to those records in order. A
+ * channel read by none of the records is left out.
+ *
+ * scripts/decode_batch.py expands a batch back into individual records.
+ */
+
+#ifndef __BATCH_ENCODER_H__
+#define __BATCH_ENCODER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/util.h>
+
+#include "sensor_record.h"
+
+#define BATCH_ENCODER_VERSION 2
+
+/* Large enough for a live batch and for a history upload chunk */
+#define BATCH_ENCODER_MAX_RECORDS                                                                  \
+	MAX(COND_CODE_1(CONFIG_APP_STREAM_BATCH, (CONFIG_APP_STREAM_BATCH_SIZE), (1)),             \
+	    COND_CODE_1(CONFIG_APP_HISTORY, (CONFIG_APP_HISTORY_CHUNK_SIZE), (1)))
+
+int batch_encoder_encode(const struct sensor_record *records, size_t count, uint8_t *buf,
+			 size_t buf_len, size_t *encoded_len);
+
+#endif /* __BATCH_ENCODER_H__ */
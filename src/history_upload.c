@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(history_upload, LOG_LEVEL_DBG);
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+
+#include "batch_encoder.h"
+#include "history_upload.h"
+#include "payload_pool.h"
+#include "stream_queue.h"
+
+/* How long to wait for a payload buffer to free up before trying again */
+#define HISTORY_UPLOAD_RETRY_MS 1000
+
+static struct {
+	enum sensor_history_res res;
+	uint32_t from_s;
+	uint32_t to_s;
+	/* Sequence number of the next entry to look at */
+	uint32_t seq;
+	uint32_t sent;
+	bool active;
+} upload;
+
+/* Only touched from the work handler */
+static struct sensor_history_entry entries[CONFIG_APP_HISTORY_CHUNK_SIZE];
+static struct sensor_record records[CONFIG_APP_HISTORY_CHUNK_SIZE];
+
+K_MUTEX_DEFINE(upload_mutex);
+
+static void upload_work_handler(struct k_work *work);
+K_WORK_DELAYABLE_DEFINE(upload_work, upload_work_handler);
+
+/* Keep at least one payload buffer free for live readings */
+static struct payload_buf *spare_payload_buf_get(void)
+{
+	struct payload_pool_stats stats;
+
+	payload_pool_stats_get(&stats);
+	if (stats.used + 1 >= CONFIG_APP_PAYLOAD_POOL_COUNT) {
+		return NULL;
+	}
+
+	return payload_pool_alloc();
+}
+
+/* Send the next chunk and schedule the one after it. Called with upload_mutex held. */
+static void upload_next_chunk(void)
+{
+	struct payload_buf *buf;
+	uint32_t seq = upload.seq;
+	size_t count;
+	int err;
+
+	count = sensor_history_query(upload.res, upload.from_s, upload.to_s, &seq, entries,
+				     ARRAY_SIZE(entries));
+	if (count == 0) {
+		LOG_INF("History upload done: %u %s entries", upload.sent,
+			sensor_history_res_name(upload.res));
+		upload.active = false;
+		return;
+	}
+
+	buf = spare_payload_buf_get();
+	if (!buf) {
+		k_work_schedule(&upload_work, K_MSEC(HISTORY_UPLOAD_RETRY_MS));
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		err = sensor_history_unpack(upload.res, &entries[i], &records[i]);
+		if (err) {
+			LOG_ERR("Failed to convert history entry time: %d", err);
+			payload_pool_free(buf);
+			upload.active = false;
+			return;
+		}
+	}
+
+	/* Send fewer entries if a chunk does not fit in a payload buffer */
+	do {
+		err = batch_encoder_encode(records, count, buf->data, sizeof(buf->data), &buf->len);
+		if (err == -ENOMEM) {
+			count /= 2;
+		}
+	} while ((err == -ENOMEM) && (count > 0));
+
+	if (err) {
+		LOG_ERR("Failed to encode history chunk: %d", err);
+		payload_pool_free(buf);
+		upload.active = false;
+		return;
+	}
+
+	buf->path = "history";
+	buf->content_type = GOLIOTH_CONTENT_TYPE_CBOR;
+	buf->sample_ms = records[0].sample_ms;
+
+	stream_queue_send(buf);
+
+	/* Entries left out of a chunk that was split are sent in the next one */
+	upload.seq = seq + count;
+	upload.sent += count;
+
+	LOG_DBG("Sent %u history entries (%u total)", count, upload.sent);
+
+	k_work_schedule(&upload_work, K_NO_WAIT);
+}
+
+static void upload_work_handler(struct k_work *work)
+{
+	k_mutex_lock(&upload_mutex, K_FOREVER);
+	upload_next_chunk();
+	k_mutex_unlock(&upload_mutex);
+}
+
+int history_upload_start(enum sensor_history_res res, uint32_t from_s, uint32_t to_s)
+{
+	k_mutex_lock(&upload_mutex, K_FOREVER);
+
+	if (upload.active) {
+		k_mutex_unlock(&upload_mutex);
+		return -EBUSY;
+	}
+
+	upload.res = res;
+	upload.from_s = from_s;
+	upload.to_s = to_s;
+	upload.seq = 0;
+	upload.sent = 0;
+	upload.active = true;
+
+	k_work_schedule(&upload_work, K_NO_WAIT);
+
+	k_mutex_unlock(&upload_mutex);
+
+	return 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Upload a time range of on-device history to LightDB Stream.
+ *
+ * The range is sent to the "history" stream path in chunks of up to
+ * APP_HISTORY_CHUNK_SIZE entries, each encoded in the columnar batch format
+ * (see batch_encoder.h). Chunks are sent from the system work queue and only
+ * while a payload buffer is left over for live readings, so a large backfill
+ * never displaces current data.
+ */
+
+#ifndef __HISTORY_UPLOAD_H__
+#define __HISTORY_UPLOAD_H__
+
+#include <stdint.h>
+
+#include "sensor_history.h"
+
+/**
+ * Start uploading the entries of a resolution with from_s <= time_s <= to_s
+ * (Unix seconds).
+ *
+ * @return 0 on success, -EBUSY if an upload is already in progress
+ */
+int history_upload_start(enum sensor_history_res res, uint32_t from_s, uint32_t to_s);
+
+#endif /* __HISTORY_UPLOAD_H__ */
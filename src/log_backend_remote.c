@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <golioth/client.h>
+#include <golioth/stream.h>
+#include <zcbor_encode.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log_backend.h>
+#include <zephyr/logging/log_core.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/logging/log_output.h>
+
+#include "log_backend_remote.h"
+
+/* This file must not log: every message would loop back into this backend */
+
+#define REMOTE_LOG_PATH	       "log"
+#define REMOTE_LOG_BATCH_SIZE  CONFIG_APP_LOG_BACKEND_REMOTE_BATCH_SIZE
+#define REMOTE_LOG_LINE_SIZE   CONFIG_APP_LOG_BACKEND_REMOTE_LINE_SIZE
+#define REMOTE_LOG_FLUSH_DELAY K_SECONDS(CONFIG_APP_LOG_BACKEND_REMOTE_FLUSH_S)
+/* CBOR array header plus a string header for each line */
+#define REMOTE_LOG_SEND_SIZE   (REMOTE_LOG_BATCH_SIZE + REMOTE_LOG_BATCH_SIZE / 4 + 8)
+
+static struct golioth_client *client;
+
+/* Lines waiting to be sent, stored back to back as NUL-terminated strings */
+static char batch_buf[REMOTE_LOG_BATCH_SIZE];
+static size_t batch_len;
+static size_t batch_lines;
+K_MUTEX_DEFINE(batch_mutex);
+
+static uint8_t send_buf[REMOTE_LOG_SEND_SIZE];
+
+/* Line currently being formatted by log_output */
+static char line_buf[REMOTE_LOG_LINE_SIZE];
+static size_t line_len;
+
+static uint8_t output_buf[32];
+
+/* Token bucket: tokens are scaled by 60000 so refill works in whole milliseconds */
+#define TOKEN_SCALE (MSEC_PER_SEC * SEC_PER_MIN)
+static int64_t tokens = (int64_t)CONFIG_APP_LOG_BACKEND_REMOTE_BURST * TOKEN_SCALE;
+static int64_t tokens_updated_ms;
+
+/* Updated by the log thread and the flush work, read by the sampling thread */
+static struct {
+	atomic_t lines_sent;
+	atomic_t bytes_sent;
+	atomic_t batches_sent;
+	atomic_t rate_limited;
+	atomic_t dropped;
+} stats;
+static atomic_t paused;
+
+static void flush_work_handler(struct k_work *work);
+K_WORK_DELAYABLE_DEFINE(flush_work, flush_work_handler);
+
+static int line_out(uint8_t *data, size_t length, void *ctx)
+{
+	size_t copy = MIN(length, sizeof(line_buf) - 1 - line_len);
+
+	memcpy(&line_buf[line_len], data, copy);
+	line_len += copy;
+
+	/* Silently truncate overlong lines */
+	return length;
+}
+
+LOG_OUTPUT_DEFINE(log_output_remote, line_out, output_buf, sizeof(output_buf));
+
+static bool rate_limit_allow(void)
+{
+	int64_t now = k_uptime_get();
+	int64_t max_tokens = (int64_t)CONFIG_APP_LOG_BACKEND_REMOTE_BURST * TOKEN_SCALE;
+
+	tokens += (now - tokens_updated_ms) * CONFIG_APP_LOG_BACKEND_REMOTE_RATE_PER_MIN;
+	tokens = MIN(tokens, max_tokens);
+	tokens_updated_ms = now;
+
+	if (tokens < TOKEN_SCALE) {
+		return false;
+	}
+
+	tokens -= TOKEN_SCALE;
+	return true;
+}
+
+static void flush_work_handler(struct k_work *work)
+{
+	size_t offset = 0;
+	size_t payload_len;
+	size_t lines;
+	bool ok;
+	int err;
+
+	if (atomic_get(&paused)) {
+		/* Sent once resumed */
+		return;
+	}
+
+	if (!client || !golioth_client_is_connected(client)) {
+		/* Keep the batch until the client is connected */
+		k_work_reschedule(&flush_work, REMOTE_LOG_FLUSH_DELAY);
+		return;
+	}
+
+	k_mutex_lock(&batch_mutex, K_FOREVER);
+
+	lines = batch_lines;
+	if (lines == 0) {
+		k_mutex_unlock(&batch_mutex);
+		return;
+	}
+
+	ZCBOR_STATE_E(zse, 1, send_buf, sizeof(send_buf), 1);
+
+	ok = zcbor_list_start_encode(zse, lines);
+	while (ok && offset < batch_len) {
+		size_t len = strlen(&batch_buf[offset]);
+
+		ok = zcbor_tstr_encode_ptr(zse, &batch_buf[offset], len);
+		offset += len + 1;
+	}
+	ok = ok && zcbor_list_end_encode(zse, lines);
+
+	batch_len = 0;
+	batch_lines = 0;
+
+	k_mutex_unlock(&batch_mutex);
+
+	if (!ok) {
+		atomic_add(&stats.dropped, lines);
+		return;
+	}
+
+	payload_len = zse->payload - send_buf;
+
+	/* The payload is copied into the request, so send_buf can be reused right away */
+	err = golioth_stream_set_async(client,
+				       REMOTE_LOG_PATH,
+				       GOLIOTH_CONTENT_TYPE_CBOR,
+				       send_buf,
+				       payload_len,
+				       NULL,
+				       NULL);
+	if (err) {
+		atomic_add(&stats.dropped, lines);
+		return;
+	}
+
+	atomic_add(&stats.lines_sent, lines);
+	atomic_add(&stats.bytes_sent, payload_len);
+	atomic_inc(&stats.batches_sent);
+}
+
+static void process(const struct log_backend *const backend, union log_msg_generic *msg)
+{
+	if (!rate_limit_allow()) {
+		atomic_inc(&stats.rate_limited);
+		return;
+	}
+
+	line_len = 0;
+	log_output_msg_process(&log_output_remote, &msg->log,
+			       LOG_OUTPUT_FLAG_LEVEL | LOG_OUTPUT_FLAG_CRLF_NONE);
+	log_output_flush(&log_output_remote);
+	line_buf[line_len] = '\0';
+
+	k_mutex_lock(&batch_mutex, K_FOREVER);
+
+	if (batch_len + line_len + 1 > sizeof(batch_buf)) {
+		atomic_inc(&stats.dropped);
+		k_mutex_unlock(&batch_mutex);
+		k_work_reschedule(&flush_work, K_NO_WAIT);
+		return;
+	}
+
+	memcpy(&batch_buf[batch_len], line_buf, line_len + 1);
+	batch_len += line_len + 1;
+	batch_lines++;
+
+	k_mutex_unlock(&batch_mutex);
+
+	if (batch_len > (sizeof(batch_buf) * 3) / 4) {
+		k_work_reschedule(&flush_work, K_NO_WAIT);
+	} else {
+		/* Start the batch window on the first line only */
+		k_work_schedule(&flush_work, REMOTE_LOG_FLUSH_DELAY);
+	}
+}
+
+static void dropped(const struct log_backend *const backend, uint32_t cnt)
+{
+	atomic_add(&stats.dropped, cnt);
+}
+
+static void panic(const struct log_backend *const backend)
+{
+	/* Nothing can be sent once the system has panicked */
+	log_backend_deactivate(backend);
+}
+
+static const struct log_backend_api log_backend_remote_api = {
+	.process = process,
+	.dropped = dropped,
+	.panic = panic,
+};
+
+LOG_BACKEND_DEFINE(log_backend_remote, log_backend_remote_api, false);
+
+void log_backend_remote_set_client(struct golioth_client *remote_client)
+{
+	client = remote_client;
+	tokens_updated_ms = k_uptime_get();
+
+	/* Sets the runtime filter of every source to the default remote level */
+	log_backend_enable(&log_backend_remote, NULL, CONFIG_APP_LOG_BACKEND_REMOTE_LEVEL);
+}
+
+void log_backend_remote_pause(bool pause)
+{
+	atomic_set(&paused, pause);
+
+	if (!pause) {
+		k_work_reschedule(&flush_work, K_NO_WAIT);
+	}
+}
+
+void log_backend_remote_stats_get(struct log_backend_remote_stats *out)
+{
+	out->lines_sent = atomic_get(&stats.lines_sent);
+	out->bytes_sent = atomic_get(&stats.bytes_sent);
+	out->batches_sent = atomic_get(&stats.batches_sent);
+	out->rate_limited = atomic_get(&stats.rate_limited);
+	out->dropped = atomic_get(&stats.dropped);
+}
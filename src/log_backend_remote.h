@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Batching, rate-limited log backend that uploads log lines to Golioth
+ * LightDB Stream as a CBOR array of strings.
+ *
+ * Only messages that pass the backend's runtime filter are formatted, and the
+ * filter defaults to CONFIG_APP_LOG_BACKEND_REMOTE_LEVEL (warnings and errors).
+ * The filter can be raised or lowered at runtime with the `set_log_level` RPC.
+ *
+ * While paused, lines are batched but not sent; lines that do not fit in the
+ * batch are dropped.
+ */
+
+#ifndef __LOG_BACKEND_REMOTE_H__
+#define __LOG_BACKEND_REMOTE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <golioth/client.h>
+
+struct log_backend_remote_stats {
+	uint32_t lines_sent;
+	uint32_t bytes_sent;
+	uint32_t batches_sent;
+	uint32_t rate_limited;
+	uint32_t dropped;
+};
+
+void log_backend_remote_set_client(struct golioth_client *remote_client);
+void log_backend_remote_pause(bool pause);
+void log_backend_remote_stats_get(struct log_backend_remote_stats *stats);
+
+#endif /* __LOG_BACKEND_REMOTE_H__ */
@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(lte_policy, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+#include "lte_policy.h"
+
+struct timer_unit {
+	uint8_t bits;
+	uint32_t seconds;
+};
+
+/* GPRS timer 3 units, shortest first (3GPP TS 24.008 table 10.5.163a) */
+static const struct timer_unit tau_units[] = {
+	{0x3, 2}, {0x4, 30}, {0x5, 60}, {0x0, 600}, {0x1, 3600}, {0x2, 36000}, {0x6, 1152000},
+};
+
+/* GPRS timer 2 units, shortest first (3GPP TS 24.008 table 10.5.163) */
+static const struct timer_unit active_time_units[] = {
+	{0x0, 2},
+	{0x1, 60},
+	{0x2, 360},
+};
+
+#define TIMER_VALUE_MAX 31
+
+/* eDRX cycles in milliseconds, indexed by their 4-bit value (3GPP TS 24.008 table 10.5.5.32) */
+static const uint32_t edrx_ms[] = {
+	5120,	10240,	 20480,	  40960,   61440,   81920,   102400,  122880,
+	143360, 163840, 327680, 655360, 1310720, 2621440, 5242880, 10485760,
+};
+
+/* Values NB-IoT accepts; LTE-M accepts all of them */
+#define EDRX_NBIOT_VALID 0xFE2C
+
+struct lte_request {
+	bool psm;
+	char tau[LTE_POLICY_TIMER_STR_LEN];
+	char active_time[LTE_POLICY_TIMER_STR_LEN];
+	bool edrx;
+	char edrx_ltem[LTE_POLICY_EDRX_STR_LEN];
+	char edrx_nbiot[LTE_POLICY_EDRX_STR_LEN];
+};
+
+static const struct lte_policy_ops *ops;
+
+/* Only touched by the sampling thread */
+static struct lte_request requested;
+static bool requested_valid;
+
+/* Modem sleep state, updated from LTE events and read by the uplink stage */
+static K_MUTEX_DEFINE(sleep_mutex);
+static K_SEM_DEFINE(wake_sem, 0, 1);
+static bool asleep;
+/* Uptime at which the modem is due to wake, negative if unknown */
+static int64_t wake_at_ms = -1;
+static struct lte_policy_stats stats;
+
+static void bits_to_str(uint32_t value, size_t nbits, char *buf)
+{
+	for (size_t i = 0; i < nbits; i++) {
+		buf[i] = (value & BIT(nbits - 1 - i)) ? '1' : '0';
+	}
+	buf[nbits] = '\0';
+}
+
+static uint32_t encode_timer(const struct timer_unit *units, size_t count, uint32_t seconds,
+			     char buf[LTE_POLICY_TIMER_STR_LEN])
+{
+	const struct timer_unit *unit = &units[count - 1];
+	uint32_t value = TIMER_VALUE_MAX;
+
+	for (size_t i = 0; i < count; i++) {
+		uint32_t v = DIV_ROUND_UP(seconds, units[i].seconds);
+
+		if (v <= TIMER_VALUE_MAX) {
+			unit = &units[i];
+			value = v;
+			break;
+		}
+	}
+
+	bits_to_str((unit->bits << 5) | value, 8, buf);
+
+	return unit->seconds * value;
+}
+
+uint32_t lte_policy_encode_tau(uint32_t seconds, char buf[LTE_POLICY_TIMER_STR_LEN])
+{
+	return encode_timer(tau_units, ARRAY_SIZE(tau_units), seconds, buf);
+}
+
+uint32_t lte_policy_encode_active_time(uint32_t seconds, char buf[LTE_POLICY_TIMER_STR_LEN])
+{
+	return encode_timer(active_time_units, ARRAY_SIZE(active_time_units), seconds, buf);
+}
+
+uint32_t lte_policy_encode_edrx(enum lte_policy_rat rat, uint32_t ms,
+				char buf[LTE_POLICY_EDRX_STR_LEN])
+{
+	uint32_t valid = (rat == LTE_POLICY_RAT_NBIOT) ? EDRX_NBIOT_VALID : 0xFFFF;
+	int value = -1;
+
+	for (size_t i = 0; i < ARRAY_SIZE(edrx_ms); i++) {
+		if (!(valid & BIT(i))) {
+			continue;
+		}
+		if ((value < 0) || (edrx_ms[i] <= ms)) {
+			value = i;
+		}
+		if (edrx_ms[i] >= ms) {
+			break;
+		}
+	}
+
+	bits_to_str(value, 4, buf);
+
+	return edrx_ms[value];
+}
+
+static void request_for_interval(uint32_t interval_s, struct lte_request *req)
+{
+	memset(req, 0, sizeof(*req));
+
+	if (interval_s >= CONFIG_APP_LTE_PSM_MIN_INTERVAL_S) {
+		uint32_t tau_s, active_s;
+
+		req->psm = true;
+		tau_s = lte_policy_encode_tau(interval_s + interval_s / 2, req->tau);
+		active_s = lte_policy_encode_active_time(
+			MIN(CONFIG_APP_LTE_ACTIVE_TIME_S, interval_s / 4), req->active_time);
+
+		LOG_DBG("Interval %u s: PSM, TAU %u s, active time %u s", interval_s, tau_s,
+			active_s);
+		return;
+	}
+
+	uint32_t edrx_target_ms = MIN(interval_s / 2, CONFIG_APP_LTE_EDRX_MAX_S) * MSEC_PER_SEC;
+
+	if (edrx_target_ms < edrx_ms[0]) {
+		LOG_DBG("Interval %u s: no PSM or eDRX", interval_s);
+		return;
+	}
+
+	req->edrx = true;
+	lte_policy_encode_edrx(LTE_POLICY_RAT_LTEM, edrx_target_ms, req->edrx_ltem);
+	lte_policy_encode_edrx(LTE_POLICY_RAT_NBIOT, edrx_target_ms, req->edrx_nbiot);
+
+	LOG_DBG("Interval %u s: eDRX %s (LTE-M), %s (NB-IoT)", interval_s, req->edrx_ltem,
+		req->edrx_nbiot);
+}
+
+static int request_apply(const struct lte_request *req)
+{
+	int err;
+
+	if (req->psm) {
+		err = ops->psm_set(req->tau, req->active_time);
+		if (err) {
+			LOG_ERR("Failed to set PSM parameters: %d", err);
+			return err;
+		}
+	}
+
+	err = ops->psm_enable(req->psm);
+	if (err) {
+		LOG_ERR("Failed to %s PSM: %d", req->psm ? "request" : "disable", err);
+		return err;
+	}
+
+	if (req->edrx) {
+		err = ops->edrx_set(LTE_POLICY_RAT_LTEM, req->edrx_ltem);
+		if (!err) {
+			err = ops->edrx_set(LTE_POLICY_RAT_NBIOT, req->edrx_nbiot);
+		}
+		if (err) {
+			LOG_ERR("Failed to set eDRX parameters: %d", err);
+			return err;
+		}
+	}
+
+	err = ops->edrx_enable(req->edrx);
+	if (err) {
+		LOG_ERR("Failed to %s eDRX: %d", req->edrx ? "request" : "disable", err);
+		return err;
+	}
+
+	return 0;
+}
+
+void lte_policy_init(const struct lte_policy_ops *lte_ops)
+{
+	ops = lte_ops;
+	requested_valid = false;
+}
+
+void lte_policy_update(uint32_t upload_interval_s)
+{
+	struct lte_request req;
+
+	if (!ops) {
+		return;
+	}
+
+	request_for_interval(upload_interval_s, &req);
+
+	if (requested_valid && (memcmp(&req, &requested, sizeof(req)) == 0)) {
+		return;
+	}
+
+	/* Retried next cycle on failure */
+	requested_valid = false;
+	if (request_apply(&req) == 0) {
+		requested = req;
+		requested_valid = true;
+
+		if (req.psm) {
+			LOG_INF("Requested PSM, TAU %s, active time %s", req.tau, req.active_time);
+		} else if (req.edrx) {
+			LOG_INF("Requested eDRX %s", req.edrx_ltem);
+		} else {
+			LOG_INF("PSM and eDRX disabled");
+		}
+	}
+}
+
+void lte_policy_sleep_entered(int64_t duration_ms)
+{
+	k_mutex_lock(&sleep_mutex, K_FOREVER);
+	asleep = true;
+	wake_at_ms = (duration_ms >= 0) ? (k_uptime_get() + duration_ms) : -1;
+	k_mutex_unlock(&sleep_mutex);
+
+	k_sem_reset(&wake_sem);
+}
+
+void lte_policy_sleep_exited(void)
+{
+	k_mutex_lock(&sleep_mutex, K_FOREVER);
+	asleep = false;
+	wake_at_ms = -1;
+	stats.wakes++;
+	k_mutex_unlock(&sleep_mutex);
+
+	k_sem_give(&wake_sem);
+}
+
+void lte_policy_granted(int32_t tau_s, int32_t active_time_s)
+{
+	LOG_INF("Network granted TAU %d s, active time %d s", tau_s, active_time_s);
+}
+
+void lte_policy_send_hold(void)
+{
+	int64_t wait_ms = -1;
+
+	k_mutex_lock(&sleep_mutex, K_FOREVER);
+	if (asleep && (wake_at_ms >= 0)) {
+		wait_ms = MAX(wake_at_ms - k_uptime_get(), 0);
+	}
+	k_mutex_unlock(&sleep_mutex);
+
+	if ((wait_ms < 0) || (wait_ms > CONFIG_APP_LTE_SEND_HOLD_S * MSEC_PER_SEC)) {
+		return;
+	}
+
+	int64_t start = k_uptime_get();
+
+	/* Send on the wake-up, or when it was due if the event never comes */
+	(void)k_sem_take(&wake_sem, K_MSEC(wait_ms));
+
+	uint32_t held_ms = k_uptime_get() - start;
+
+	k_mutex_lock(&sleep_mutex, K_FOREVER);
+	stats.held++;
+	stats.held_ms += held_ms;
+	k_mutex_unlock(&sleep_mutex);
+
+	LOG_DBG("Send held %u ms for a modem wake-up", held_ms);
+}
+
+void lte_policy_stats_get(struct lte_policy_stats *out)
+{
+	k_mutex_lock(&sleep_mutex, K_FOREVER);
+	*out = stats;
+	k_mutex_unlock(&sleep_mutex);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * LTE power saving derived from the upload interval.
+ *
+ * Every cycle the upload interval (the sampling period, times the batch size
+ * when batching) determines the timers requested from the network:
+ *
+ * - Intervals of at least APP_LTE_PSM_MIN_INTERVAL_S use PSM. The periodic
+ *   TAU is requested at one and a half intervals, so uploads normally refresh
+ *   it before it expires, and the active time is APP_LTE_ACTIVE_TIME_S, at most
+ *   a quarter of the interval.
+ * - Shorter intervals use eDRX instead, with the longest paging cycle up to
+ *   half the interval and at most APP_LTE_EDRX_MAX_S.
+ *
+ * The network may grant other timers and wake the modem on its own. While the
+ * modem sleeps in PSM, the uplink stage holds a send for up to
+ * APP_LTE_SEND_HOLD_S if the modem is due to wake within that time, so the
+ * send rides on the wake-up instead of causing one of its own.
+ *
+ * The modem is reached through struct lte_policy_ops only, so that the policy
+ * can run against a mock on targets without a modem. lte_policy_lte_lc_ops
+ * implements it with the nRF Connect SDK LTE link controller.
+ */
+
+#ifndef __LTE_POLICY_H__
+#define __LTE_POLICY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* 3GPP TS 24.008 GPRS timer bit strings, e.g. "00100001", and the eDRX value, e.g. "0101" */
+#define LTE_POLICY_TIMER_STR_LEN 9
+#define LTE_POLICY_EDRX_STR_LEN	 5
+
+enum lte_policy_rat {
+	LTE_POLICY_RAT_LTEM,
+	LTE_POLICY_RAT_NBIOT,
+};
+
+struct lte_policy_ops {
+	/* Set the requested periodic TAU (GPRS timer 3) and active time (GPRS timer 2) */
+	int (*psm_set)(const char *tau, const char *active_time);
+	int (*psm_enable)(bool enable);
+	/* Set the requested eDRX value for a radio access technology */
+	int (*edrx_set)(enum lte_policy_rat rat, const char *edrx);
+	int (*edrx_enable)(bool enable);
+};
+
+struct lte_policy_stats {
+	/* Sends held for a modem wake-up, and the total time they waited */
+	uint32_t held;
+	uint32_t held_ms;
+	/* Wake-ups reported by the modem */
+	uint32_t wakes;
+};
+
+void lte_policy_init(const struct lte_policy_ops *ops);
+
+/* Request the timers for an upload interval; only changes are passed to the modem */
+void lte_policy_update(uint32_t upload_interval_s);
+
+/* Modem events: PSM sleep for `duration_ms` (negative if unknown), wake-up, granted timers */
+void lte_policy_sleep_entered(int64_t duration_ms);
+void lte_policy_sleep_exited(void);
+void lte_policy_granted(int32_t tau_s, int32_t active_time_s);
+
+/* Called by the uplink stage before each send */
+void lte_policy_send_hold(void);
+
+void lte_policy_stats_get(struct lte_policy_stats *stats);
+
+/**
+ * Encode a GPRS timer 3 (periodic TAU) or GPRS timer 2 (active time) as the
+ * shortest value of at least `seconds`.
+ *
+ * @return The encoded duration in seconds
+ */
+uint32_t lte_policy_encode_tau(uint32_t seconds, char buf[LTE_POLICY_TIMER_STR_LEN]);
+uint32_t lte_policy_encode_active_time(uint32_t seconds, char buf[LTE_POLICY_TIMER_STR_LEN]);
+
+/**
+ * Encode the longest eDRX cycle of at most `ms` valid for `rat`, or the
+ * shortest one if none is short enough.
+ *
+ * @return The encoded cycle in milliseconds
+ */
+uint32_t lte_policy_encode_edrx(enum lte_policy_rat rat, uint32_t ms,
+				char buf[LTE_POLICY_EDRX_STR_LEN]);
+
+#ifdef CONFIG_LTE_LINK_CONTROL
+struct lte_lc_evt;
+
+extern const struct lte_policy_ops lte_policy_lte_lc_ops;
+
+/* Pass LTE link controller events on to the policy */
+void lte_policy_lte_lc_event(const struct lte_lc_evt *const evt);
+#endif
+
+#endif /* __LTE_POLICY_H__ */
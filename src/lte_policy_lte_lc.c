@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(lte_policy, LOG_LEVEL_DBG);
+
+#include <modem/lte_lc.h>
+
+#include "lte_policy.h"
+
+static int psm_set(const char *tau, const char *active_time)
+{
+	return lte_lc_psm_param_set(tau, active_time);
+}
+
+static int psm_enable(bool enable)
+{
+	return lte_lc_psm_req(enable);
+}
+
+static int edrx_set(enum lte_policy_rat rat, const char *edrx)
+{
+	enum lte_lc_lte_mode mode =
+		(rat == LTE_POLICY_RAT_NBIOT) ? LTE_LC_LTE_MODE_NBIOT : LTE_LC_LTE_MODE_LTEM;
+
+	return lte_lc_edrx_param_set(mode, edrx);
+}
+
+static int edrx_enable(bool enable)
+{
+	return lte_lc_edrx_req(enable);
+}
+
+const struct lte_policy_ops lte_policy_lte_lc_ops = {
+	.psm_set = psm_set,
+	.psm_enable = psm_enable,
+	.edrx_set = edrx_set,
+	.edrx_enable = edrx_enable,
+};
+
+void lte_policy_lte_lc_event(const struct lte_lc_evt *const evt)
+{
+	switch (evt->type) {
+	case LTE_LC_EVT_PSM_UPDATE:
+		lte_policy_granted(evt->psm_cfg.tau, evt->psm_cfg.active_time);
+		break;
+	case LTE_LC_EVT_EDRX_UPDATE:
+		LOG_INF("Network granted eDRX cycle %d ms",
+			(int)(evt->edrx_cfg.edrx * MSEC_PER_SEC));
+		break;
+	case LTE_LC_EVT_MODEM_SLEEP_ENTER:
+		/* Only PSM keeps an uplink waiting until the modem wakes */
+		if (evt->modem_sleep.type == LTE_LC_MODEM_SLEEP_PSM) {
+			lte_policy_sleep_entered(evt->modem_sleep.time);
+		}
+		break;
+	case LTE_LC_EVT_MODEM_SLEEP_EXIT:
+		if (evt->modem_sleep.type == LTE_LC_MODEM_SLEEP_PSM) {
+			lte_policy_sleep_exited();
+		}
+		break;
+	default:
+		break;
+	}
+}
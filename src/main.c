@@ -9,12 +9,16 @@
 LOG_MODULE_REGISTER(golioth_air_quality, LOG_LEVEL_DBG);
 
 #include <app_version.h>
+#include "app_alerts.h"
 #include "app_rpc.h"
 #include "app_settings.h"
 #include "app_state.h"
+#include "app_dfu.h"
+#include "app_schedule.h"
 #include "app_sensors.h"
-#include "sensor_scd4x.h"
-#include "sensor_sps30.h"
+#include "log_backend_remote.h"
+#include "lte_policy.h"
+#include "app_time.h"
 #include <golioth/client.h>
 #include <golioth/fw_update.h>
 #include <samples/common/net_connect.h>
@@ -46,8 +50,6 @@ static const char *_current_version =
 static struct golioth_client *client;
 K_SEM_DEFINE(connected, 0, 1);
 
-static k_tid_t _system_thread = 0;
-
 #if DT_NODE_EXISTS(DT_ALIAS(golioth_led))
 static const struct gpio_dt_spec golioth_led = GPIO_DT_SPEC_GET(DT_ALIAS(golioth_led), gpios);
 #endif /* DT_NODE_EXISTS(DT_ALIAS(golioth_led)) */
@@ -57,11 +59,6 @@ static struct gpio_callback button_cb_data;
 /* Forward declarations */
 void golioth_connection_led_set(uint8_t state);
 
-void wake_system_thread(void)
-{
-	k_wakeup(_system_thread);
-}
-
 static void on_client_event(struct golioth_client *client, enum golioth_client_event event,
 			    void *arg)
 {
@@ -70,6 +67,7 @@ static void on_client_event(struct golioth_client *client, enum golioth_client_e
 	if (is_connected) {
 		k_sem_give(&connected);
 		golioth_connection_led_set(1);
+		IF_ENABLED(CONFIG_APP_ALERTS, (app_alerts_connected();));
 	}
 	LOG_INF("Golioth client %s", is_connected ? "connected" : "disconnected");
 }
@@ -86,7 +84,10 @@ static void start_golioth_client(void)
 	golioth_client_register_event_callback(client, on_client_event, NULL);
 
 	/* Initialize DFU components */
-	golioth_fw_update_init(client, _current_version);
+	IF_ENABLED(CONFIG_GOLIOTH_FW_UPDATE, (golioth_fw_update_init(client, _current_version);));
+
+	/* Follow firmware downloads and give them priority over telemetry */
+	IF_ENABLED(CONFIG_APP_DFU_MONITOR, (app_dfu_init(client);));
 
 	/*** Call Golioth APIs for other services in dedicated app files ***/
 
@@ -101,12 +102,17 @@ static void start_golioth_client(void)
 
 	/* Register RPC service */
 	app_rpc_register(client);
+
+	/* Start uploading logs through the batching backend */
+	IF_ENABLED(CONFIG_APP_LOG_BACKEND_REMOTE, (log_backend_remote_set_client(client);));
 }
 
 #ifdef CONFIG_SOC_SERIES_NRF91X
 
 static void lte_handler(const struct lte_lc_evt *const evt)
 {
+	IF_ENABLED(CONFIG_APP_LTE_POLICY, (lte_policy_lte_lc_event(evt);));
+
 	if (evt->type == LTE_LC_EVT_NW_REG_STATUS) {
 
 		if ((evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_HOME) ||
@@ -149,7 +155,7 @@ void button_pressed(const struct device *dev, struct gpio_callback *cb, uint32_t
 	/* This function is an Interrupt Service Routine. Do not call functions that
 	 * use other threads, or perform long-running operations here
 	 */
-	k_wakeup(_system_thread);
+	app_schedule_trigger();
 }
 
 /* Set (unset) LED indicators for active Golioth connection */
@@ -181,11 +187,10 @@ int main(void)
 		k_msleep(300);
 
 		/* Read firmware version from faceplate */
-		char *o_version = (char *)calloc(32, sizeof(char));
+		char o_version[32] = {0};
 
-		ostentus_version_get(o_dev, o_version, 32);
+		ostentus_version_get(o_dev, o_version, sizeof(o_version));
 		LOG_INF("Ostentus reports firmware version: %s", o_version);
-		free(o_version);
 
 		/* Update Ostentus LEDS using bitmask (Power On and Battery) */
 		ostentus_led_bitmask(o_dev, LED_POW | LED_BAT);
@@ -194,9 +199,6 @@ int main(void)
 		ostentus_show_splash(o_dev);
 	));
 
-	/* Get system thread id so loop delay change event can wake main */
-	_system_thread = k_current_get();
-
 #if DT_NODE_EXISTS(DT_ALIAS(golioth_led))
 	/* Initialize Golioth logo LED */
 	err = gpio_pin_configure_dt(&golioth_led, GPIO_OUTPUT_INACTIVE);
@@ -210,6 +212,9 @@ int main(void)
 	 * Golioth Client will start automatically when LTE connects
 	 */
 
+	/* PSM and eDRX are requested once the first cycle knows the upload interval */
+	IF_ENABLED(CONFIG_APP_LTE_POLICY, (lte_policy_init(&lte_policy_lte_lc_ops);));
+
 	LOG_INF("Connecting to LTE, this may take some time...");
 	lte_lc_connect_async(lte_handler);
 
@@ -224,10 +229,17 @@ int main(void)
 	/* Start Golioth client */
 	start_golioth_client();
 
-	/* Block until connected to Golioth */
-	k_sem_take(&connected, K_FOREVER);
+	/* Block until connected to Golioth. A replayed trace runs through the sampling cycle
+	 * whether or not Golioth can be reached.
+	 */
+	if (!IS_ENABLED(CONFIG_SENSOR_REPLAY)) {
+		k_sem_take(&connected, K_FOREVER);
+	}
 #endif /* CONFIG_SOC_SERIES_NRF91X */
 
+	/* Start tracking wall-clock time for sample timestamps */
+	app_time_init();
+
 	/* Initialize sensors */
 	app_sensors_init();
 
@@ -252,18 +264,21 @@ int main(void)
 	IF_ENABLED(CONFIG_LIB_OSTENTUS, (
 		/* Set up a slideshow on Ostentus
 		 *  - add up to 256 slides
+		 *  - sensor channel slides come from sensor_channels.h
 		 *  - use the enum in app_sensors.h to add new keys
 		 *  - values are updated using these keys (see app_sensors.c)
 		 */
-		ostentus_slide_add(o_dev, CO2, LABEL_CO2, strlen(LABEL_CO2));
-		ostentus_slide_add(o_dev, PM2P5, LABEL_PM2P5, strlen(LABEL_PM2P5));
-		ostentus_slide_add(o_dev, PM10P0, LABEL_PM10P0, strlen(LABEL_PM10P0));
-		ostentus_slide_add(o_dev,
-				   TEMPERATURE,
-				   LABEL_TEMPERATURE,
-				   strlen(LABEL_TEMPERATURE));
-		ostentus_slide_add(o_dev, PRESSURE, LABEL_PRESSURE, strlen(LABEL_PRESSURE));
-		ostentus_slide_add(o_dev, HUMIDITY, LABEL_HUMIDITY, strlen(LABEL_HUMIDITY));
+		for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+			const struct sensor_record_channel_info *ch = &sensor_record_channels[i];
+
+			if (ch->slide) {
+				ostentus_slide_add(o_dev, i, ch->label, strlen(ch->label));
+			}
+		}
+
+		IF_ENABLED(CONFIG_APP_AQI, (
+			ostentus_slide_add(o_dev, AQI, LABEL_AQI, strlen(LABEL_AQI));
+		));
 
 		IF_ENABLED(CONFIG_ALUDEL_BATTERY_MONITOR, (
 			ostentus_slide_add(o_dev,
@@ -289,10 +304,15 @@ int main(void)
 		ostentus_slideshow(o_dev, 30000);
 	));
 
+	IF_ENABLED(CONFIG_APP_UPLINK_BENCHMARK, (app_sensors_benchmark();));
+
+	/* Sample once right away, then on fixed-rate deadlines */
+	app_schedule_start();
+
 	while (true) {
 		app_sensors_read_and_stream();
 
-		k_sleep(K_SECONDS(get_loop_delay_s()));
+		app_schedule_wait();
 	}
 
 	return 0;
@@ -1,12 +0,0 @@
-/*
- * Copyright (c) 2023 Golioth, Inc.
- *
- * SPDX-License-Identifier: Apache-2.0
- */
-
-#ifndef __MAIN_H__
-#define __MAIN_H__
-
-void wake_system_thread(void);
-
-#endif /* __MAIN_H__ */
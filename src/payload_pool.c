@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(payload_pool, LOG_LEVEL_DBG);
+
+#include <zephyr/kernel.h>
+
+#include "payload_pool.h"
+
+K_MEM_SLAB_DEFINE_STATIC(payload_slab, sizeof(struct payload_buf), CONFIG_APP_PAYLOAD_POOL_COUNT,
+			 4);
+
+static atomic_t high_water_mark;
+static atomic_t allocated;
+/* Allocations that found every buffer in use */
+static atomic_t exhausted;
+
+void payload_buf_reset(struct payload_buf *buf)
+{
+	buf->path = NULL;
+	buf->content_type = GOLIOTH_CONTENT_TYPE_JSON;
+	buf->sample_ms = k_uptime_get();
+	buf->enqueue_ms = 0;
+	buf->attempts = 0;
+	buf->urgent = false;
+	buf->len = 0;
+}
+
+struct payload_buf *payload_pool_alloc(void)
+{
+	struct payload_buf *buf;
+	uint32_t used;
+
+	if (k_mem_slab_alloc(&payload_slab, (void **)&buf, K_NO_WAIT) != 0) {
+		/* Not a drop yet: the caller may reclaim a queued buffer or retry later */
+		atomic_inc(&exhausted);
+		LOG_DBG("Payload pool exhausted (%d buffers)", CONFIG_APP_PAYLOAD_POOL_COUNT);
+		return NULL;
+	}
+
+	atomic_inc(&allocated);
+
+	used = k_mem_slab_num_used_get(&payload_slab);
+
+	/* Raise the mark without losing a higher value set by a concurrent caller */
+	for (atomic_val_t mark = atomic_get(&high_water_mark); used > mark;
+	     mark = atomic_get(&high_water_mark)) {
+		if (atomic_cas(&high_water_mark, mark, used)) {
+			LOG_INF("Payload pool high-water mark: %u of %d buffers", used,
+				CONFIG_APP_PAYLOAD_POOL_COUNT);
+			break;
+		}
+	}
+
+	payload_buf_reset(buf);
+
+	return buf;
+}
+
+void payload_pool_free(struct payload_buf *buf)
+{
+	if (buf) {
+		k_mem_slab_free(&payload_slab, (void *)buf);
+	}
+}
+
+void payload_pool_stats_get(struct payload_pool_stats *stats)
+{
+	stats->used = k_mem_slab_num_used_get(&payload_slab);
+	stats->high_water_mark = atomic_get(&high_water_mark);
+	stats->allocated = atomic_get(&allocated);
+	stats->exhausted = atomic_get(&exhausted);
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Fixed pool of payload buffers for asynchronous Golioth requests.
+ *
+ * Buffers come from a statically allocated k_mem_slab so that periodic sends
+ * never touch the system heap. A buffer is owned by the request it was passed
+ * to and returned to the pool from the request's completion callback. When
+ * the pool is exhausted the allocation fails and is counted; the caller then
+ * reclaims a queued payload's buffer, retries later or drops its payload.
+ */
+
+#ifndef __PAYLOAD_POOL_H__
+#define __PAYLOAD_POOL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <golioth/client.h>
+
+#define PAYLOAD_BUF_SIZE CONFIG_APP_PAYLOAD_BUF_SIZE
+
+struct payload_buf {
+	/* Stream path and content type, kept so the payload can be resent */
+	const char *path;
+	enum golioth_content_type content_type;
+	/* Uptime when the data in this payload was acquired */
+	int64_t sample_ms;
+	/* Uptime when the payload was last handed to the Golioth client */
+	int64_t enqueue_ms;
+	uint8_t attempts;
+	/* Retried before, and never dropped in favor of, other payloads */
+	bool urgent;
+	size_t len;
+	uint8_t data[PAYLOAD_BUF_SIZE];
+};
+
+struct payload_pool_stats {
+	uint32_t used;
+	uint32_t high_water_mark;
+	uint32_t allocated;
+	uint32_t exhausted;
+};
+
+void payload_buf_reset(struct payload_buf *buf);
+struct payload_buf *payload_pool_alloc(void);
+void payload_pool_free(struct payload_buf *buf);
+void payload_pool_stats_get(struct payload_pool_stats *stats);
+
+#endif /* __PAYLOAD_POOL_H__ */
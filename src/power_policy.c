@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(power_policy, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <battery_monitor.h>
+#include <golioth/client.h>
+#include <golioth/lightdb_state.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log_ctrl.h>
+
+#include "app_schedule.h"
+#include "power_policy.h"
+#include "sensor_record.h"
+#include "sensor_sps30.h"
+
+/* e.g. {"tier":"critical","level":9,"runtime_h":71} */
+#define STATE_BUF_SIZE 64
+
+/* Weight of the previous drain rate estimate, out of 4 */
+#define DRAIN_EMA_WEIGHT 3
+
+#define DRAIN_WINDOW_MS ((int64_t)CONFIG_APP_POWER_DRAIN_WINDOW_MIN * 60 * MSEC_PER_SEC)
+#define HOUR_MS		((int64_t)SEC_PER_HOUR * MSEC_PER_SEC)
+
+/* Log sources whose level can be restored; the others are only ever lowered */
+#define LOG_SOURCES_MAX 256
+
+/* A short projected runtime is only cleared once the projection is this much longer */
+#define MIN_RUNTIME_CLEAR_H (CONFIG_APP_POWER_MIN_RUNTIME_H + CONFIG_APP_POWER_MIN_RUNTIME_H / 4)
+
+struct power_tier_info {
+	const char *name;
+	/* Battery level (%) at or below which the tier is entered */
+	uint8_t level;
+	uint32_t period_factor;
+	/* Cap on the runtime log level of every module */
+	uint8_t log_level;
+};
+
+static const struct power_tier_info tiers[POWER_TIER_COUNT] = {
+	[POWER_TIER_NORMAL] = {"normal", 100, 1, LOG_LEVEL_DBG},
+	[POWER_TIER_SAVER] = {"saver", CONFIG_APP_POWER_SAVER_PCT,
+			      CONFIG_APP_POWER_SAVER_PERIOD_FACTOR, LOG_LEVEL_INF},
+	[POWER_TIER_LOW] = {"low", CONFIG_APP_POWER_LOW_PCT, CONFIG_APP_POWER_LOW_PERIOD_FACTOR,
+			    LOG_LEVEL_WRN},
+	[POWER_TIER_CRITICAL] = {"critical", CONFIG_APP_POWER_CRITICAL_PCT,
+				 CONFIG_APP_POWER_CRITICAL_PERIOD_FACTOR, LOG_LEVEL_ERR},
+};
+
+BUILD_ASSERT((CONFIG_APP_POWER_SAVER_PCT > CONFIG_APP_POWER_LOW_PCT) &&
+		     (CONFIG_APP_POWER_LOW_PCT > CONFIG_APP_POWER_CRITICAL_PCT),
+	     "Power tier levels must decrease");
+
+static struct golioth_client *client;
+
+/*
+ * Everything below is only touched by the sampling thread, except `tier`,
+ * which other threads may read.
+ */
+static enum power_tier tier;
+/* Tier called for by the battery level alone */
+static enum power_tier level_tier;
+static bool runtime_short;
+static int level = -1;
+
+/* Start of the current drain window, and the drain estimate in hundredths of a percent per
+ * hour, negative until known
+ */
+static int64_t window_start_ms;
+static int window_start_level = -1;
+static int32_t drain_cpph = -1;
+
+/*
+ * Level of each log source before the tier lowered it, and the level it was
+ * lowered to, or 0 if the tier left it alone
+ */
+static uint8_t log_saved[LOG_SOURCES_MAX];
+static uint8_t log_lowered[LOG_SOURCES_MAX];
+
+static void state_async_handler(struct golioth_client *client, enum golioth_status status,
+				const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
+				void *arg)
+{
+	if (status != GOLIOTH_OK) {
+		LOG_WRN("Failed to set power state: %d", status);
+		return;
+	}
+
+	LOG_DBG("Power state successfully set");
+}
+
+static void state_update(int32_t runtime_h)
+{
+	char sbuf[STATE_BUF_SIZE];
+	size_t pos;
+	int err;
+
+	if (!client) {
+		return;
+	}
+
+	pos = snprintk(sbuf, sizeof(sbuf), "{\"tier\":\"%s\",\"level\":%d,\"runtime_h\":",
+		       tiers[tier].name, level);
+	if (runtime_h < 0) {
+		snprintk(&sbuf[pos], sizeof(sbuf) - pos, "null}");
+	} else {
+		snprintk(&sbuf[pos], sizeof(sbuf) - pos, "%d}", runtime_h);
+	}
+
+	err = golioth_lightdb_set_async(client,
+					POWER_POLICY_STATE_ENDP,
+					GOLIOTH_CONTENT_TYPE_JSON,
+					sbuf,
+					strlen(sbuf),
+					state_async_handler,
+					NULL);
+	if (err) {
+		LOG_ERR("Unable to write power state to LightDB State: %d", err);
+	}
+}
+
+/* Close the drain window once it is long enough, returning true if the estimate changed */
+static bool drain_update(int64_t now)
+{
+	int64_t elapsed_ms = now - window_start_ms;
+	int32_t sample;
+
+	if ((window_start_level < 0) || (level > window_start_level)) {
+		/* First reading or charging; the previous estimate no longer applies */
+		window_start_level = level;
+		window_start_ms = now;
+		if (drain_cpph >= 0) {
+			drain_cpph = -1;
+			return true;
+		}
+		return false;
+	}
+
+	if (elapsed_ms < DRAIN_WINDOW_MS) {
+		return false;
+	}
+
+	sample = (int32_t)((int64_t)(window_start_level - level) * 100 * HOUR_MS / elapsed_ms);
+	drain_cpph = (drain_cpph < 0) ? sample
+				       : (drain_cpph * DRAIN_EMA_WEIGHT + sample) /
+						 (DRAIN_EMA_WEIGHT + 1);
+
+	window_start_level = level;
+	window_start_ms = now;
+
+	LOG_DBG("Battery drain %d.%02d %%/h", drain_cpph / 100, drain_cpph % 100);
+
+	return true;
+}
+
+/* Projected runtime in hours, or -1 while the drain is not known */
+static int32_t runtime_h(void)
+{
+	if (drain_cpph <= 0) {
+		return -1;
+	}
+
+	return (level * 100) / drain_cpph;
+}
+
+/* Tiers are entered at their level and left only at their level plus the hysteresis */
+static enum power_tier tier_for_level(enum power_tier current)
+{
+	enum power_tier next = current;
+
+	while ((next < POWER_TIER_CRITICAL) && (level <= tiers[next + 1].level)) {
+		next++;
+	}
+
+	while ((next > POWER_TIER_NORMAL) &&
+	       (level >= tiers[next].level + CONFIG_APP_POWER_HYSTERESIS_PCT)) {
+		next--;
+	}
+
+	return next;
+}
+
+/*
+ * Cap the level of every log source, restoring the level it had before an
+ * earlier tier lowered it. A level changed in the meantime, e.g. with the
+ * set_log_level RPC, is taken as the level to restore.
+ */
+static void log_level_cap(uint8_t cap)
+{
+	for (int16_t id = 0; log_source_name_get(0, id) != NULL; id++) {
+		uint8_t current = (uint8_t)log_filter_get(NULL, 0, id, true);
+		uint8_t wanted = current;
+		uint8_t next;
+
+		if ((id < LOG_SOURCES_MAX) && log_lowered[id] && (current == log_lowered[id])) {
+			wanted = log_saved[id];
+		}
+
+		next = MIN(wanted, cap);
+		if (next != current) {
+			log_filter_set(NULL, 0, id, next);
+		}
+
+		if (id < LOG_SOURCES_MAX) {
+			log_saved[id] = wanted;
+			log_lowered[id] = (next < wanted) ? next : 0;
+		}
+	}
+}
+
+static void tier_apply(enum power_tier next)
+{
+	enum power_tier prev = tier;
+
+	/* Logged above the tier's log level so the change is always seen */
+	LOG_WRN("Power tier %s -> %s at %d%% battery, sampling every %u x LOOP_DELAY_S",
+		tiers[prev].name, tiers[next].name, level, tiers[next].period_factor);
+
+	tier = next;
+
+	log_level_cap(tiers[next].log_level);
+
+#ifdef CONFIG_APP_SENSOR_SPS30
+	if ((next >= CONFIG_APP_POWER_SPS30_OFF_TIER) && (prev < CONFIG_APP_POWER_SPS30_OFF_TIER)) {
+		sps30_sensor_suspend();
+	}
+#endif
+
+	app_schedule_period_changed();
+}
+
+void power_policy_update(const struct battery_data *data)
+{
+	enum power_tier next;
+	int32_t runtime;
+	bool changed;
+
+	changed = (data->battery_level_percent != level);
+	level = data->battery_level_percent;
+
+	changed |= drain_update(k_uptime_get());
+
+	level_tier = tier_for_level(level_tier);
+
+	runtime = runtime_h();
+	if ((runtime >= 0) && (runtime < CONFIG_APP_POWER_MIN_RUNTIME_H)) {
+		runtime_short = true;
+	} else if ((runtime < 0) || (runtime >= MIN_RUNTIME_CLEAR_H)) {
+		runtime_short = false;
+	}
+
+	next = level_tier;
+	if (runtime_short && (next < POWER_TIER_CRITICAL)) {
+		next++;
+	}
+
+	if (next != tier) {
+		tier_apply(next);
+		changed = true;
+	}
+
+	if (changed) {
+		state_update(runtime);
+	}
+}
+
+void power_policy_set_client(struct golioth_client *policy_client)
+{
+	client = policy_client;
+}
+
+enum power_tier power_policy_tier(void)
+{
+	return tier;
+}
+
+uint32_t power_policy_period_factor(void)
+{
+	return tiers[tier].period_factor;
+}
+
+uint32_t power_policy_channels(void)
+{
+	if (tier >= CONFIG_APP_POWER_SPS30_OFF_TIER) {
+		return SENSOR_RECORD_CHANNELS_ALL & ~SENSOR_RECORD_CHANNELS_SPS30;
+	}
+
+	return SENSOR_RECORD_CHANNELS_ALL;
+}
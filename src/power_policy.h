@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Battery-aware power policy.
+ *
+ * Every cycle the battery level picks one of four tiers. Each tier below
+ * normal stretches the sampling period (and with it the uploads) by its
+ * factor and caps the runtime log level, which a higher tier restores unless
+ * it was changed in the meantime; from APP_POWER_SPS30_OFF_TIER the
+ * SPS30 is put to sleep and no longer read. A tier is entered when the level
+ * falls to its threshold and left only once the level is
+ * APP_POWER_HYSTERESIS_PCT above it, so a level hovering at a threshold does
+ * not flap.
+ *
+ * The drain rate is estimated over windows of APP_POWER_DRAIN_WINDOW_MIN. If
+ * the runtime projected from it falls below APP_POWER_MIN_RUNTIME_H, the
+ * policy goes one tier further than the level alone calls for.
+ *
+ * The tier, level and projected runtime are mirrored to the "power" LightDB
+ * State endpoint whenever they change.
+ */
+
+#ifndef __POWER_POLICY_H__
+#define __POWER_POLICY_H__
+
+#include <stdint.h>
+#include <golioth/client.h>
+
+#define POWER_POLICY_STATE_ENDP "power"
+
+struct battery_data;
+
+enum power_tier {
+	POWER_TIER_NORMAL,
+	POWER_TIER_SAVER,
+	POWER_TIER_LOW,
+	POWER_TIER_CRITICAL,
+	POWER_TIER_COUNT,
+};
+
+void power_policy_set_client(struct golioth_client *policy_client);
+
+/* Apply the tier a battery reading calls for. Only called by the sampling thread. */
+void power_policy_update(const struct battery_data *data);
+
+enum power_tier power_policy_tier(void);
+
+/* Factor applied to LOOP_DELAY_S in the current tier */
+uint32_t power_policy_period_factor(void);
+
+/* Record channels of the sensors that may be read in the current tier */
+uint32_t power_policy_channels(void);
+
+#endif /* __POWER_POLICY_H__ */
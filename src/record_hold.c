@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(record_hold, LOG_LEVEL_DBG);
+
+#include <zephyr/kernel.h>
+
+#include "record_hold.h"
+
+#define HOLD_LEN CONFIG_APP_DFU_HOLD_RECORDS
+
+/* Only touched by the processing stage */
+static struct sensor_record ring[HOLD_LEN];
+static size_t head;
+static size_t count;
+static uint32_t dropped;
+
+void record_hold_put(const struct sensor_record *record)
+{
+	if (count == HOLD_LEN) {
+		LOG_WRN("Hold full, dropping record sampled %lld ms ago",
+			k_uptime_get() - ring[head].sample_ms);
+		head = (head + 1) % HOLD_LEN;
+		count--;
+		dropped++;
+	}
+
+	ring[(head + count) % HOLD_LEN] = *record;
+	count++;
+}
+
+bool record_hold_get(struct sensor_record *record)
+{
+	if (count == 0) {
+		return false;
+	}
+
+	*record = ring[head];
+	head = (head + 1) % HOLD_LEN;
+	count--;
+
+	return true;
+}
+
+const struct sensor_record *record_hold_peek(void)
+{
+	return (count > 0) ? &ring[head] : NULL;
+}
+
+size_t record_hold_count(void)
+{
+	return count;
+}
+
+uint32_t record_hold_dropped(void)
+{
+	return dropped;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Records held back from the uplink while a firmware download has priority.
+ *
+ * The processing stage keeps records in this ring of APP_DFU_HOLD_RECORDS
+ * instead of encoding them, as the payload pool is far too small to hold a
+ * download's worth of payloads. When the ring is full the oldest record is
+ * dropped. After the download the records are taken out oldest first and
+ * streamed with their original timestamps.
+ *
+ * Only used by the processing stage of the sampling pipeline.
+ */
+
+#ifndef __RECORD_HOLD_H__
+#define __RECORD_HOLD_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sensor_record.h"
+
+void record_hold_put(const struct sensor_record *record);
+
+/**
+ * Take the oldest held record.
+ *
+ * @return false if no record is held
+ */
+bool record_hold_get(struct sensor_record *record);
+
+/* The oldest held record, left in the ring, or NULL if no record is held */
+const struct sensor_record *record_hold_peek(void);
+
+size_t record_hold_count(void);
+
+/* Records dropped because the ring was full */
+uint32_t record_hold_dropped(void);
+
+#endif /* __RECORD_HOLD_H__ */
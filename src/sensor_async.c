@@ -0,0 +1,482 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(sensor_async, LOG_LEVEL_DBG);
+
+#include <string.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/kernel.h>
+#include <zephyr/rtio/rtio.h>
+#include <drivers/sensor/sps30.h>
+
+#include "app_trace.h"
+#include "sensor_async.h"
+#include "sensor_recovery.h"
+#include "sensor_scd4x.h"
+#include "sensor_sps30.h"
+
+#define BME280_NODE DT_NODELABEL(bme280)
+#define SCD4X_NODE  DT_INST(0, sensirion_scd4x)
+#define SPS30_NODE  DT_INST(0, sensirion_sps30)
+
+/* The SPS30 reading, the largest, takes three blocks */
+#define SENSOR_ASYNC_BLOCK_SIZE	 32
+#define SENSOR_ASYNC_BLOCK_COUNT 8
+#define SENSOR_ASYNC_QUEUE_SIZE	 3
+
+/* Completions are polled so that each read can have its own deadline */
+#define SENSOR_ASYNC_POLL_INTERVAL K_MSEC(20)
+
+/* Uptime, sensor and up to ten values */
+#define SENSOR_ASYNC_CAPTURE_LINE_LEN 192
+
+RTIO_DEFINE_WITH_MEMPOOL(sensor_rtio, SENSOR_ASYNC_QUEUE_SIZE, SENSOR_ASYNC_QUEUE_SIZE,
+			 SENSOR_ASYNC_BLOCK_COUNT, SENSOR_ASYNC_BLOCK_SIZE, sizeof(void *));
+
+typedef void (*sensor_async_decode_fn)(const struct sensor_decoder_api *decoder,
+				       const uint8_t *buf, struct sensor_readings *readings);
+
+struct sensor_async_source {
+	const char *name;
+	const struct device *dev;
+	struct rtio_iodev *iodev;
+	/* Record channels provided by the sensor */
+	uint32_t channels;
+	/* Optional hooks run on the calling thread around the read. `begin` may return
+	 * -EAGAIN to skip the sensor in a fast read.
+	 */
+	int (*begin)(bool fast);
+	void (*end)(void);
+	/* Longest the read may take from `begin`, or NULL for a quick read */
+	uint32_t (*duration_ms)(bool fast);
+	sensor_async_decode_fn decode;
+	struct sensor_recovery_target *recovery;
+};
+
+enum read_outcome {
+	READ_SKIPPED,
+	READ_PENDING,
+	READ_DONE,
+	READ_MISSED,
+};
+
+struct read_status {
+	enum read_outcome outcome;
+	int64_t deadline_ms;
+	/* No reading came out of the sensor, including reads that were never started */
+	bool lost;
+};
+
+#define SENSOR_ASYNC_CHAN_SPEC(id, sensor, key, label, unit, exponent, hist_exp, slide, chan,      \
+			       field)                                                              \
+	{chan, 0},
+
+#define SENSOR_ASYNC_DECODE(id, sensor, key, label, unit, exponent, hist_exp, slide, chan, field)  \
+	decode_channel(decoder, buf, (enum sensor_channel)(chan), &readings->field, &timestamp_ns);
+
+#define SENSOR_ASYNC_CAPTURE(id, sensor, key, label, unit, exponent, hist_exp, slide, chan, field) \
+	if (strcmp(sensor, src->name) == 0) {                                                      \
+		len += capture_value(&line[len], sizeof(line) - len, &readings->field);            \
+	}
+
+/* Decode the single reading of a channel, returning its timestamp */
+static int decode_channel(const struct sensor_decoder_api *decoder, const uint8_t *buf,
+			  enum sensor_channel chan, struct sensor_value *val,
+			  uint64_t *timestamp_ns)
+{
+	struct sensor_q31_data data = {0};
+	struct sensor_chan_spec chan_spec = {chan, 0};
+	uint32_t fit = 0;
+	int64_t micro;
+	int ret;
+
+	ret = decoder->decode(buf, chan_spec, &fit, 1, &data);
+	if (ret <= 0) {
+		LOG_ERR("Failed to decode sensor channel %d: %d", chan, ret);
+		return (ret < 0) ? ret : -ENODATA;
+	}
+
+	micro = (int64_t)data.readings[0].value * 1000000;
+	if (data.shift < 31) {
+		micro >>= 31 - data.shift;
+	} else {
+		micro <<= data.shift - 31;
+	}
+
+	*timestamp_ns = data.header.base_timestamp_ns;
+
+	return sensor_value_from_micro(val, micro);
+}
+
+#ifdef CONFIG_APP_SENSOR_CAPTURE
+static size_t capture_value(char *buf, size_t len, const struct sensor_value *val)
+{
+	int64_t micro = sensor_value_to_micro(val);
+	uint64_t magnitude = (micro < 0) ? -micro : micro;
+	int ret;
+
+	ret = snprintk(buf, len, ",%s%u.%06u", (micro < 0) ? "-" : "",
+		       (uint32_t)(magnitude / 1000000), (uint32_t)(magnitude % 1000000));
+
+	return CLAMP(ret, 0, (int)len - 1);
+}
+
+/* Print a reading as a line of a replay trace (see drivers/sensor/replay/sensor_replay.h) */
+static void capture(const struct sensor_async_source *src, const struct sensor_readings *readings)
+{
+	char line[SENSOR_ASYNC_CAPTURE_LINE_LEN];
+	size_t len;
+
+	len = snprintk(line, sizeof(line), "%u,%s", (uint32_t)k_uptime_get(), src->name);
+
+	SENSOR_CHANNELS(SENSOR_ASYNC_CAPTURE)
+
+	printk("%s\n", line);
+}
+#endif /* CONFIG_APP_SENSOR_CAPTURE */
+
+#ifdef CONFIG_APP_SENSOR_BME280
+static struct sensor_recovery_target bme280_recovery = {
+	.name = "BME280",
+	.bus = DEVICE_DT_GET(DT_BUS(BME280_NODE)),
+	.reinit = NULL,
+};
+
+SENSOR_DT_READ_IODEV(bme280_iodev, BME280_NODE, SENSOR_CHANNELS_BME280(SENSOR_ASYNC_CHAN_SPEC));
+
+static void bme280_decode(const struct sensor_decoder_api *decoder, const uint8_t *buf,
+			  struct sensor_readings *readings)
+{
+	uint64_t timestamp_ns;
+
+	SENSOR_CHANNELS_BME280(SENSOR_ASYNC_DECODE)
+}
+#endif /* CONFIG_APP_SENSOR_BME280 */
+
+#ifdef CONFIG_APP_SENSOR_SCD4X
+static struct sensor_recovery_target scd4x_recovery = {
+	.name = "SCD4x",
+	.bus = DEVICE_DT_GET(DT_BUS(SCD4X_NODE)),
+	.reinit = scd4x_sensor_reinit,
+};
+
+SENSOR_DT_READ_IODEV(scd4x_iodev, SCD4X_NODE, SENSOR_CHANNELS_SCD4X(SENSOR_ASYNC_CHAN_SPEC));
+
+static void scd4x_decode(const struct sensor_decoder_api *decoder, const uint8_t *buf,
+			 struct sensor_readings *readings)
+{
+	uint64_t timestamp_ns;
+
+	SENSOR_CHANNELS_SCD4X(SENSOR_ASYNC_DECODE)
+}
+#endif /* CONFIG_APP_SENSOR_SCD4X */
+
+#ifdef CONFIG_APP_SENSOR_SPS30
+static struct sensor_recovery_target sps30_recovery = {
+	.name = "SPS30",
+	.bus = DEVICE_DT_GET(DT_BUS(SPS30_NODE)),
+	.reinit = sps30_sensor_reset,
+};
+
+SENSOR_DT_READ_IODEV(sps30_iodev, SPS30_NODE, SENSOR_CHANNELS_SPS30(SENSOR_ASYNC_CHAN_SPEC));
+
+static void sps30_decode(const struct sensor_decoder_api *decoder, const uint8_t *buf,
+			 struct sensor_readings *readings)
+{
+	uint64_t timestamp_ns = 0;
+
+	SENSOR_CHANNELS_SPS30(SENSOR_ASYNC_DECODE)
+
+	/* Readings are timestamped at the end of the averaging window */
+	readings->sps30.window_start_ms = sps30_encoded_window_start_ns(buf) / NSEC_PER_MSEC;
+	readings->sps30.window_end_ms = timestamp_ns / NSEC_PER_MSEC;
+}
+#endif /* CONFIG_APP_SENSOR_SPS30 */
+
+/* The SPS30 goes first so that its warm-up wait is over before the other sensors are sampled */
+static const struct sensor_async_source sources[] = {
+#ifdef CONFIG_APP_SENSOR_SPS30
+	{
+		.name = "SPS30",
+		.dev = DEVICE_DT_GET(SPS30_NODE),
+		.iodev = &sps30_iodev,
+		.channels = SENSOR_RECORD_CHANNELS_SPS30,
+		.begin = sps30_sensor_read_begin,
+		.end = sps30_sensor_read_end,
+		.duration_ms = sps30_sensor_read_duration_ms,
+		.decode = sps30_decode,
+		.recovery = &sps30_recovery,
+	},
+#endif
+#ifdef CONFIG_APP_SENSOR_SCD4X
+	{
+		.name = "SCD4x",
+		.dev = DEVICE_DT_GET(SCD4X_NODE),
+		.iodev = &scd4x_iodev,
+		.channels = SENSOR_RECORD_CHANNELS_SCD4X,
+		.begin = scd4x_sensor_read_begin,
+		.end = scd4x_sensor_read_end,
+		.duration_ms = scd4x_sensor_read_duration_ms,
+		.decode = scd4x_decode,
+		.recovery = &scd4x_recovery,
+	},
+#endif
+#ifdef CONFIG_APP_SENSOR_BME280
+	{
+		.name = "BME280",
+		.dev = DEVICE_DT_GET(BME280_NODE),
+		.iodev = &bme280_iodev,
+		.channels = SENSOR_RECORD_CHANNELS_BME280,
+		.decode = bme280_decode,
+		.recovery = &bme280_recovery,
+	},
+#endif
+};
+
+/* Set from submission until the completion arrives, which may be after the deadline */
+static bool in_flight[ARRAY_SIZE(sources)];
+
+BUILD_ASSERT(ARRAY_SIZE(sources) <= SENSOR_ASYNC_QUEUE_SIZE, "RTIO queue too small");
+
+static int decode_source(const struct sensor_async_source *src, const uint8_t *buf,
+			 struct sensor_readings *readings)
+{
+	const struct sensor_decoder_api *decoder;
+	int err;
+
+	err = sensor_get_decoder(src->dev, &decoder);
+	if (err) {
+		LOG_ERR("Failed to get %s decoder: %d", src->name, err);
+		return err;
+	}
+
+	src->decode(decoder, buf, readings);
+
+	IF_ENABLED(CONFIG_APP_SENSOR_CAPTURE, (capture(src, readings);))
+
+	return 0;
+}
+
+/* Handle a completion, returning false if it belongs to a read that is no longer pending */
+static bool complete(struct rtio_cqe *cqe, struct read_status *status,
+		     struct sensor_readings *readings, int *ret)
+{
+	const struct sensor_async_source *src = cqe->userdata;
+	size_t i = src - sources;
+	int result = cqe->result;
+	uint8_t *buf = NULL;
+	uint32_t buf_len = 0;
+	int err;
+
+	err = rtio_cqe_get_mempool_buffer(&sensor_rtio, cqe, &buf, &buf_len);
+	rtio_cqe_release(&sensor_rtio, cqe);
+
+	in_flight[i] = false;
+
+	if (status[i].outcome != READ_PENDING) {
+		LOG_WRN("Dropping late %s reading (result: %d)", src->name, result);
+		if (buf) {
+			rtio_release_buffer(&sensor_rtio, buf, buf_len);
+		}
+		return false;
+	}
+
+	app_trace_end(src->name, result);
+
+	/* The driver gave up waiting for the sensor itself */
+	status[i].outcome = (result == -ETIMEDOUT) ? READ_MISSED : READ_DONE;
+
+	if (result < 0) {
+		LOG_ERR("Failed to read from %s: %d", src->name, result);
+		*ret = result;
+	} else if (err) {
+		LOG_ERR("Failed to get %s reading buffer: %d", src->name, err);
+		*ret = err;
+	} else {
+		err = decode_source(src, buf, readings);
+		if (err) {
+			*ret = err;
+		}
+	}
+
+	status[i].lost = (result < 0) || err;
+
+	if (buf) {
+		rtio_release_buffer(&sensor_rtio, buf, buf_len);
+	}
+
+	if (src->end) {
+		src->end();
+	}
+
+	return true;
+}
+
+/* Abandon the pending reads past their deadline, returning how many */
+static int expire(struct read_status *status, int *ret)
+{
+	int64_t now = k_uptime_get();
+	int expired = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(sources); i++) {
+		const struct sensor_async_source *src = &sources[i];
+
+		if ((status[i].outcome != READ_PENDING) || (now < status[i].deadline_ms)) {
+			continue;
+		}
+
+		LOG_ERR("%s read missed its deadline", src->name);
+		app_trace_end(src->name, -ETIMEDOUT);
+		status[i].outcome = READ_MISSED;
+		status[i].lost = true;
+		*ret = -ETIMEDOUT;
+		expired++;
+
+		if (src->end) {
+			src->end();
+		}
+	}
+
+	return expired;
+}
+
+void sensor_async_init(void)
+{
+	sensor_recovery_init();
+
+	for (size_t i = 0; i < ARRAY_SIZE(sources); i++) {
+		sensor_recovery_add(sources[i].recovery);
+	}
+}
+
+/*
+ * Sensors that are not requested, or that recovery gave up on, are skipped like
+ * sensors skipped in a fast read
+ */
+static bool requested(const struct sensor_async_source *src, uint32_t channels)
+{
+	return ((src->channels & channels) != 0) && !sensor_recovery_failed(src->recovery);
+}
+
+int sensor_async_read(struct sensor_readings *readings, bool fast, uint32_t *channels)
+{
+	struct read_status status[ARRAY_SIZE(sources)] = {0};
+	uint32_t durations_ms[ARRAY_SIZE(sources)];
+	uint32_t budget_ms = CONFIG_APP_SENSOR_READ_MARGIN_MS;
+	struct rtio_cqe *cqe;
+	int pending = 0;
+	int ret = 0;
+	int err;
+
+	/* Drop the completions of reads abandoned in an earlier call */
+	while ((cqe = rtio_cqe_consume(&sensor_rtio)) != NULL) {
+		complete(cqe, status, readings, &ret);
+	}
+
+	/* Sensors are prepared one after the other, so the watchdog allows for all of them */
+	for (size_t i = 0; i < ARRAY_SIZE(sources); i++) {
+		const struct sensor_async_source *src = &sources[i];
+
+		if (!requested(src, *channels)) {
+			durations_ms[i] = 0;
+			continue;
+		}
+
+		durations_ms[i] = src->duration_ms ? src->duration_ms(fast) : 0;
+		budget_ms += durations_ms[i];
+	}
+
+	sensor_recovery_watch(budget_ms);
+
+	for (size_t i = 0; i < ARRAY_SIZE(sources); i++) {
+		const struct sensor_async_source *src = &sources[i];
+		int64_t start_ms = k_uptime_get();
+
+		if (!requested(src, *channels)) {
+			continue;
+		}
+
+		if (in_flight[i]) {
+			LOG_ERR("%s is still busy with an abandoned read", src->name);
+			status[i].outcome = READ_MISSED;
+			status[i].lost = true;
+			ret = -EBUSY;
+			continue;
+		}
+
+		if (src->begin) {
+			err = src->begin(fast);
+			if (fast && (err == -EAGAIN)) {
+				LOG_DBG("Skipping %s in fast read", src->name);
+				continue;
+			} else if (err) {
+				LOG_ERR("Failed to prepare %s: %d", src->name, err);
+				status[i].lost = true;
+				ret = err;
+				continue;
+			}
+		}
+
+		app_trace_begin(src->name, 0);
+
+		err = sensor_read_async_mempool(src->iodev, &sensor_rtio, (void *)src);
+		if (err) {
+			app_trace_end(src->name, err);
+			LOG_ERR("Failed to submit %s read: %d", src->name, err);
+			status[i].lost = true;
+			ret = err;
+			if (src->end) {
+				src->end();
+			}
+			continue;
+		}
+
+		in_flight[i] = true;
+		status[i].outcome = READ_PENDING;
+		status[i].deadline_ms =
+			start_ms + durations_ms[i] + CONFIG_APP_SENSOR_READ_MARGIN_MS;
+		pending++;
+	}
+
+	/* Completions arrive in whatever order the sensors finish */
+	while (pending > 0) {
+		cqe = rtio_cqe_consume(&sensor_rtio);
+		if (cqe) {
+			if (complete(cqe, status, readings, &ret)) {
+				pending--;
+			}
+			continue;
+		}
+
+		pending -= expire(status, &ret);
+		if (pending > 0) {
+			k_sleep(SENSOR_ASYNC_POLL_INTERVAL);
+		}
+	}
+
+	sensor_recovery_unwatch();
+
+	*channels = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(sources); i++) {
+		if ((status[i].outcome == READ_DONE) && !status[i].lost) {
+			*channels |= sources[i].channels;
+		}
+
+		if (status[i].outcome != READ_SKIPPED) {
+			sensor_recovery_report(sources[i].recovery,
+					       status[i].outcome == READ_MISSED);
+		}
+
+		/* A skipped sensor has not lost a reading */
+		if ((status[i].outcome != READ_SKIPPED) || status[i].lost) {
+			sensor_recovery_track(sources[i].recovery, status[i].lost);
+		}
+	}
+
+	return ret;
+}
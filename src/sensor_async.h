@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Read every enabled sensor through one RTIO context.
+ *
+ * All sensors are submitted at once with sensor_read_async() and their
+ * completions are decoded as they arrive, so the slow SCD4x and SPS30
+ * measurements overlap instead of running back to back. The channels requested
+ * from each sensor are generated from sensor_channels.h.
+ *
+ * Each read must complete within the time the sensor is expected to take plus
+ * APP_SENSOR_READ_MARGIN_MS. A read that misses its deadline is abandoned, its
+ * late completion dropped, and the sensor handed to sensor_recovery.h.
+ */
+
+#ifndef __SENSOR_ASYNC_H__
+#define __SENSOR_ASYNC_H__
+
+#include <stdbool.h>
+
+#include "sensor_record.h"
+
+/* Start the task watchdog and register the sensors for recovery */
+void sensor_async_init(void);
+
+/**
+ * Read the sensors providing any of the record channels in `channels`, and
+ * replace `channels` with the channels of the sensors that were read. Channels
+ * of a sensor that failed or was skipped keep their previous value.
+ *
+ * A fast read takes a single SPS30 reading instead of averaging a window, and
+ * skips the SPS30 if it is not already running and warmed up.
+ *
+ * @return 0 if every requested sensor was read, otherwise the last error
+ */
+int sensor_async_read(struct sensor_readings *readings, bool fast, uint32_t *channels);
+
+#endif /* __SENSOR_ASYNC_H__ */
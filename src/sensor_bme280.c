@@ -30,30 +30,3 @@ int bme280_sensor_init(void)
 
 	return 0;
 }
-
-int bme280_sensor_read(struct bme280_sensor_measurement *measurement)
-{
-	int err;
-
-	LOG_DBG("Reading BME280 weather sensor");
-
-	err = sensor_sample_fetch(bme280_dev);
-	if (err) {
-		LOG_ERR("Error fetching weather sensor sample: %d", err);
-		return err;
-	}
-
-	sensor_channel_get(bme280_dev, SENSOR_CHAN_AMBIENT_TEMP, &measurement->temperature);
-	sensor_channel_get(bme280_dev, SENSOR_CHAN_PRESS, &measurement->pressure);
-	sensor_channel_get(bme280_dev, SENSOR_CHAN_HUMIDITY, &measurement->humidity);
-
-	return err;
-}
-
-void bme280_log_measurements(struct bme280_sensor_measurement *measurement)
-{
-	LOG_DBG("BME280: Temperature=%.2f °C, Pressure=%.2f kPa, Humidity=%.2f %%RH",
-		sensor_value_to_double(&measurement->temperature),
-		sensor_value_to_double(&measurement->pressure),
-		sensor_value_to_double(&measurement->humidity));
-}
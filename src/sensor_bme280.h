@@ -16,7 +16,5 @@ struct bme280_sensor_measurement {
 };
 
 int bme280_sensor_init(void);
-int bme280_sensor_read(struct bme280_sensor_measurement *measurement);
-void bme280_log_measurements(struct bme280_sensor_measurement *measurement);
 
 #endif
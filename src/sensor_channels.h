@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Compile-time schema of every measurement channel reported by this
+ * application.
+ *
+ * The channel enum, the channel table, record aggregation, the JSON and batch
+ * encoders, measurement logging and the Ostentus slides are all generated from
+ * this list. To add a channel, add one line to the list of the sensor that
+ * provides it. The RTIO read of each sensor requests exactly these channels.
+ * Channels of a sensor that is disabled in Kconfig are compiled
+ * out along with the sensor driver.
+ *
+ * Each entry is X(id, sensor, key, label, unit, exponent, hist_exp, slide, chan, field):
+ *   id       - suffix of the SENSOR_CH_<id> enum value
+ *   sensor   - sensor name used when logging
+ *   key      - key used in stream payloads
+ *   label    - human readable name used in logs and on slides
+ *   unit     - unit of the value
+ *   exponent - decimal exponent of the fixed-point value (value = int * 10^exponent)
+ *   hist_exp - decimal exponent of the 16-bit value kept in on-device history
+ *   slide    - show the channel on an Ostentus slide
+ *   chan     - Zephyr sensor channel read from the driver
+ *   field    - member of struct sensor_readings holding the struct sensor_value
+ */
+
+#ifndef __SENSOR_CHANNELS_H__
+#define __SENSOR_CHANNELS_H__
+
+#include <zephyr/drivers/sensor.h>
+#include <drivers/sensor/sps30.h>
+
+/* clang-format off */
+#ifdef CONFIG_APP_SENSOR_BME280
+#define SENSOR_CHANNELS_BME280(X) \
+	X(TEM, "BME280", "tem", "Temperature", "°C", -2, -2, true, SENSOR_CHAN_AMBIENT_TEMP, \
+	  bme280.temperature) \
+	X(PRE, "BME280", "pre", "Pressure", "kPa", -3, -2, true, SENSOR_CHAN_PRESS, \
+	  bme280.pressure) \
+	X(HUM, "BME280", "hum", "Humidity", "%RH", -2, -2, true, SENSOR_CHAN_HUMIDITY, \
+	  bme280.humidity)
+#else
+#define SENSOR_CHANNELS_BME280(X)
+#endif
+
+#ifdef CONFIG_APP_SENSOR_SCD4X
+#define SENSOR_CHANNELS_SCD4X(X) \
+	X(CO2, "SCD4x", "co2", "CO2", "ppm", 0, 0, true, SENSOR_CHAN_CO2, scd4x.co2)
+#else
+#define SENSOR_CHANNELS_SCD4X(X)
+#endif
+
+#ifdef CONFIG_APP_SENSOR_SPS30
+#define SENSOR_CHANNELS_SPS30(X) \
+	X(MC_1P0, "SPS30", "mc_1p0", "PM1.0", "ug/m^3", -1, -1, false, SENSOR_CHAN_PM_1_0, \
+	  sps30.mc_1p0) \
+	X(MC_2P5, "SPS30", "mc_2p5", "PM2.5", "ug/m^3", -1, -1, true, SENSOR_CHAN_PM_2_5, \
+	  sps30.mc_2p5) \
+	X(MC_4P0, "SPS30", "mc_4p0", "PM4.0", "ug/m^3", -1, -1, false, SENSOR_CHAN_SPS30_MC_4P0, \
+	  sps30.mc_4p0) \
+	X(MC_10P0, "SPS30", "mc_10p0", "PM10.0", "ug/m^3", -1, -1, true, SENSOR_CHAN_PM_10, \
+	  sps30.mc_10p0) \
+	X(NC_0P5, "SPS30", "nc_0p5", "NC0.5", "#/cm^3", -1, -1, false, SENSOR_CHAN_SPS30_NC_0P5, \
+	  sps30.nc_0p5) \
+	X(NC_1P0, "SPS30", "nc_1p0", "NC1.0", "#/cm^3", -1, -1, false, SENSOR_CHAN_SPS30_NC_1P0, \
+	  sps30.nc_1p0) \
+	X(NC_2P5, "SPS30", "nc_2p5", "NC2.5", "#/cm^3", -1, -1, false, SENSOR_CHAN_SPS30_NC_2P5, \
+	  sps30.nc_2p5) \
+	X(NC_4P0, "SPS30", "nc_4p0", "NC4.0", "#/cm^3", -1, -1, false, SENSOR_CHAN_SPS30_NC_4P0, \
+	  sps30.nc_4p0) \
+	X(NC_10P0, "SPS30", "nc_10p0", "NC10.0", "#/cm^3", -1, -1, false, \
+	  SENSOR_CHAN_SPS30_NC_10P0, sps30.nc_10p0) \
+	X(TPS, "SPS30", "tps", "Typical Particle Size", "um", -3, -3, false, \
+	  SENSOR_CHAN_SPS30_TYPICAL_PARTICLE_SIZE, sps30.typical_particle_size)
+#else
+#define SENSOR_CHANNELS_SPS30(X)
+#endif
+
+#define SENSOR_CHANNELS(X) \
+	SENSOR_CHANNELS_BME280(X) \
+	SENSOR_CHANNELS_SCD4X(X) \
+	SENSOR_CHANNELS_SPS30(X)
+/* clang-format on */
+
+#endif /* __SENSOR_CHANNELS_H__ */
@@ -0,0 +1,392 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include "app_time.h"
+#include "sensor_history.h"
+
+struct history_ring {
+	struct sensor_history_entry *entries;
+	uint16_t size;
+	/* Next slot to write */
+	uint16_t head;
+	uint16_t count;
+	/* Entries ever pushed, which is the sequence number of the next one */
+	uint32_t pushed;
+};
+
+/* Running sums of the bucket a rollup is collecting */
+struct history_rollup {
+	uint32_t bucket;
+	uint32_t samples;
+	int32_t sums[SENSOR_CH_COUNT];
+	uint32_t counts[SENSOR_CH_COUNT];
+};
+
+static struct sensor_history_entry raw_entries[CONFIG_APP_HISTORY_RAW_COUNT];
+static struct sensor_history_entry minute_entries[CONFIG_APP_HISTORY_MINUTE_COUNT];
+static struct sensor_history_entry hour_entries[CONFIG_APP_HISTORY_HOUR_COUNT];
+
+static struct history_ring rings[SENSOR_HISTORY_RES_COUNT] = {
+	[SENSOR_HISTORY_RAW] = {raw_entries, ARRAY_SIZE(raw_entries)},
+	[SENSOR_HISTORY_MINUTE] = {minute_entries, ARRAY_SIZE(minute_entries)},
+	[SENSOR_HISTORY_HOUR] = {hour_entries, ARRAY_SIZE(hour_entries)},
+};
+
+/* Rollups feeding the minute and hour rings; the raw ring has none */
+static struct history_rollup rollups[SENSOR_HISTORY_RES_COUNT];
+
+static const uint32_t periods_s[SENSOR_HISTORY_RES_COUNT] = {
+	[SENSOR_HISTORY_RAW] = 0,
+	[SENSOR_HISTORY_MINUTE] = 60,
+	[SENSOR_HISTORY_HOUR] = 3600,
+};
+
+static const char *const res_names[SENSOR_HISTORY_RES_COUNT] = {
+	[SENSOR_HISTORY_RAW] = "raw",
+	[SENSOR_HISTORY_MINUTE] = "1m",
+	[SENSOR_HISTORY_HOUR] = "1h",
+};
+
+/* Set once the entries are keyed on Unix time rather than uptime */
+static bool wall_clock;
+
+K_MUTEX_DEFINE(history_mutex);
+
+/* History values may only be coarser than the stream values */
+#define HISTORY_EXPONENT_CHECK(id, sensor, key, label, unit, exponent, hist_exp, ...)             \
+	BUILD_ASSERT((hist_exp) >= (exponent), "History exponent of " key " is too fine");
+SENSOR_CHANNELS(HISTORY_EXPONENT_CHECK)
+
+BUILD_ASSERT(SENSOR_CH_COUNT <= 16, "History entry channel mask is too narrow");
+
+static int32_t decimal_scale(int digits)
+{
+	int32_t scale = 1;
+
+	while (digits-- > 0) {
+		scale *= 10;
+	}
+
+	return scale;
+}
+
+static int16_t pack_value(int32_t value, int8_t exponent, int8_t history_exponent)
+{
+	int32_t scale = decimal_scale(history_exponent - exponent);
+
+	/* Round half away from zero */
+	value = (value >= 0) ? (value + scale / 2) / scale : (value - scale / 2) / scale;
+
+	return CLAMP(value, INT16_MIN, INT16_MAX);
+}
+
+/* Slot of entry `i` of a ring, counting from the oldest */
+static size_t ring_slot(const struct history_ring *ring, size_t i)
+{
+	return (ring->head + ring->size - ring->count + i) % ring->size;
+}
+
+/* Entry `i` of a ring, counting from the oldest */
+static const struct sensor_history_entry *ring_at(const struct history_ring *ring, size_t i)
+{
+	return &ring->entries[ring_slot(ring, i)];
+}
+
+/* Sequence number of the oldest entry of a ring */
+static uint32_t ring_first_seq(const struct history_ring *ring)
+{
+	return ring->pushed - ring->count;
+}
+
+static void ring_push(struct history_ring *ring, const struct sensor_history_entry *entry)
+{
+	struct sensor_history_entry *slot = &ring->entries[ring->head];
+
+	*slot = *entry;
+
+	/* A time resync may step the clock back, but ring_find() needs the entries in time order */
+	if (ring->count > 0) {
+		slot->time_s = MAX(slot->time_s, ring_at(ring, ring->count - 1)->time_s);
+	}
+
+	ring->head = (ring->head + 1) % ring->size;
+	ring->count = MIN(ring->count + 1, ring->size);
+	ring->pushed++;
+}
+
+/* Index of the oldest entry with time_s >= from_s, or ring->count if there is none */
+static size_t ring_find(const struct history_ring *ring, uint32_t from_s)
+{
+	size_t lo = 0;
+	size_t hi = ring->count;
+
+	/* Entries are in time order */
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+
+		if (ring_at(ring, mid)->time_s < from_s) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+
+	return lo;
+}
+
+static void rollup_add(enum sensor_history_res res, const struct sensor_history_entry *entry);
+static void rollup_flush(enum sensor_history_res res);
+
+/*
+ * Move the entries taken before the first time sync from uptime to Unix time.
+ * Rollups in progress are closed first, so buckets from then on fall on
+ * wall-clock minutes and hours. Called with history_mutex held.
+ */
+static void wall_clock_rekey(void)
+{
+	int64_t offset_ms;
+
+	/* Unix time at uptime 0 */
+	if (wall_clock || app_time_uptime_to_unix_ms(0, &offset_ms)) {
+		return;
+	}
+
+	for (int res = SENSOR_HISTORY_MINUTE; res < SENSOR_HISTORY_RES_COUNT; res++) {
+		rollup_flush(res);
+	}
+
+	for (int res = 0; res < SENSOR_HISTORY_RES_COUNT; res++) {
+		struct history_ring *ring = &rings[res];
+
+		for (size_t i = 0; i < ring->count; i++) {
+			struct sensor_history_entry *entry = &ring->entries[ring_slot(ring, i)];
+
+			entry->time_s = ((int64_t)entry->time_s * MSEC_PER_SEC + offset_ms) /
+					MSEC_PER_SEC;
+		}
+	}
+
+	wall_clock = true;
+}
+
+/* Write the average of the finished bucket to its ring and feed it to the next coarser rollup */
+static void rollup_flush(enum sensor_history_res res)
+{
+	struct history_rollup *rollup = &rollups[res];
+	struct sensor_history_entry entry;
+
+	if (rollup->samples == 0) {
+		return;
+	}
+
+	entry.time_s = rollup->bucket * periods_s[res];
+	entry.channels = 0;
+
+	for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+		int32_t sum = rollup->sums[i];
+		int32_t n = rollup->counts[i];
+
+		entry.values[i] = 0;
+		if (n > 0) {
+			entry.values[i] = (sum >= 0) ? (sum + n / 2) / n : (sum - n / 2) / n;
+			entry.channels |= BIT(i);
+		}
+		rollup->sums[i] = 0;
+		rollup->counts[i] = 0;
+	}
+
+	rollup->samples = 0;
+
+	ring_push(&rings[res], &entry);
+
+	if (res + 1 < SENSOR_HISTORY_RES_COUNT) {
+		rollup_add(res + 1, &entry);
+	}
+}
+
+static void rollup_add(enum sensor_history_res res, const struct sensor_history_entry *entry)
+{
+	struct history_rollup *rollup = &rollups[res];
+	uint32_t bucket = entry->time_s / periods_s[res];
+
+	if ((rollup->samples > 0) && (bucket != rollup->bucket)) {
+		rollup_flush(res);
+	}
+
+	rollup->bucket = bucket;
+	rollup->samples++;
+
+	for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+		if (entry->channels & BIT(i)) {
+			rollup->sums[i] += entry->values[i];
+			rollup->counts[i]++;
+		}
+	}
+}
+
+void sensor_history_add(const struct sensor_record *record)
+{
+	struct sensor_history_entry entry;
+	int64_t time_ms;
+
+	/* Channels not read for this record repeat an older sample */
+	entry.channels = record->channels & SENSOR_RECORD_CHANNELS_ALL;
+	if (entry.channels == 0) {
+		return;
+	}
+
+	for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+		const struct sensor_record_channel_info *ch = &sensor_record_channels[i];
+
+		entry.values[i] = 0;
+		if (entry.channels & BIT(i)) {
+			entry.values[i] = pack_value(record->values[i], ch->exponent,
+						     ch->history_exponent);
+		}
+	}
+
+	k_mutex_lock(&history_mutex, K_FOREVER);
+
+	wall_clock_rekey();
+
+	if (!wall_clock || app_time_uptime_to_unix_ms(record->sample_ms, &time_ms)) {
+		time_ms = record->sample_ms;
+	}
+
+	entry.time_s = (uint32_t)(time_ms / MSEC_PER_SEC);
+
+	ring_push(&rings[SENSOR_HISTORY_RAW], &entry);
+	rollup_add(SENSOR_HISTORY_MINUTE, &entry);
+
+	k_mutex_unlock(&history_mutex);
+}
+
+uint32_t sensor_history_period_s(enum sensor_history_res res)
+{
+	return periods_s[res];
+}
+
+const char *sensor_history_res_name(enum sensor_history_res res)
+{
+	return res_names[res];
+}
+
+bool sensor_history_wall_clock(void)
+{
+	bool synced;
+
+	k_mutex_lock(&history_mutex, K_FOREVER);
+	wall_clock_rekey();
+	synced = wall_clock;
+	k_mutex_unlock(&history_mutex);
+
+	return synced;
+}
+
+bool sensor_history_oldest(enum sensor_history_res res, uint32_t *time_s)
+{
+	const struct history_ring *ring = &rings[res];
+	bool found = false;
+
+	k_mutex_lock(&history_mutex, K_FOREVER);
+
+	wall_clock_rekey();
+
+	if (ring->count > 0) {
+		*time_s = ring_at(ring, 0)->time_s;
+		found = true;
+	}
+
+	k_mutex_unlock(&history_mutex);
+
+	return found;
+}
+
+size_t sensor_history_query(enum sensor_history_res res, uint32_t from_s, uint32_t to_s,
+			    uint32_t *seq, struct sensor_history_entry *entries, size_t max)
+{
+	const struct history_ring *ring = &rings[res];
+	size_t copied = 0;
+	size_t start;
+
+	k_mutex_lock(&history_mutex, K_FOREVER);
+
+	wall_clock_rekey();
+
+	start = ring_find(ring, from_s);
+
+	/* Entries overwritten since the last query are gone; carry on from the oldest */
+	if ((int32_t)(*seq - ring_first_seq(ring)) > 0) {
+		start = MAX(start, *seq - ring_first_seq(ring));
+	}
+
+	*seq = ring_first_seq(ring) + start;
+
+	for (size_t i = start; (i < ring->count) && (copied < max); i++) {
+		const struct sensor_history_entry *entry = ring_at(ring, i);
+
+		if (entry->time_s > to_s) {
+			break;
+		}
+
+		entries[copied++] = *entry;
+	}
+
+	k_mutex_unlock(&history_mutex);
+
+	return copied;
+}
+
+size_t sensor_history_count(enum sensor_history_res res, uint32_t from_s, uint32_t to_s)
+{
+	const struct history_ring *ring = &rings[res];
+	size_t count = 0;
+
+	k_mutex_lock(&history_mutex, K_FOREVER);
+
+	wall_clock_rekey();
+
+	for (size_t i = ring_find(ring, from_s); i < ring->count; i++) {
+		if (ring_at(ring, i)->time_s > to_s) {
+			break;
+		}
+
+		count++;
+	}
+
+	k_mutex_unlock(&history_mutex);
+
+	return count;
+}
+
+int sensor_history_unpack(enum sensor_history_res res, const struct sensor_history_entry *entry,
+			  struct sensor_record *record)
+{
+	int64_t start_ms;
+	int err;
+
+	/* Records carry uptime, which the encoders convert back to Unix time */
+	err = app_time_unix_to_uptime_ms((int64_t)entry->time_s * MSEC_PER_SEC, &start_ms);
+	if (err) {
+		return err;
+	}
+
+	record->sample_ms = start_ms;
+	record->win_start_ms = start_ms;
+	record->win_end_ms = start_ms + (int64_t)periods_s[res] * MSEC_PER_SEC;
+	record->channels = entry->channels;
+
+	for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+		const struct sensor_record_channel_info *ch = &sensor_record_channels[i];
+
+		record->values[i] =
+			entry->values[i] * decimal_scale(ch->history_exponent - ch->exponent);
+	}
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * On-device sensor history at several resolutions.
+ *
+ * Every record is kept in a ring of raw samples and averaged into 1-minute
+ * and 1-hour rollups, each with its own fixed-size ring. Only the channels a
+ * record read are kept, and each rollup channel averages its own samples. Entries are packed
+ * as 16-bit fixed-point values at the history exponent of each channel (see
+ * sensor_channels.h) and timestamped in Unix seconds, so rollup buckets fall
+ * on wall-clock minutes and hours. Values outside the 16-bit range are
+ * saturated.
+ *
+ * Until wall-clock time is first known (see app_time.h), entries are
+ * timestamped in seconds of uptime. They are moved to Unix time at the first
+ * call after the time sync, closing the rollups in progress.
+ *
+ * A rollup entry is written once its minute or hour has passed, so the
+ * bucket in progress is not visible to queries.
+ */
+
+#ifndef __SENSOR_HISTORY_H__
+#define __SENSOR_HISTORY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sensor_record.h"
+
+enum sensor_history_res {
+	SENSOR_HISTORY_RAW,
+	SENSOR_HISTORY_MINUTE,
+	SENSOR_HISTORY_HOUR,
+	SENSOR_HISTORY_RES_COUNT
+};
+
+struct sensor_history_entry {
+	/* Unix time of the sample, or of the start of the rollup bucket */
+	uint32_t time_s;
+	int16_t values[SENSOR_CH_COUNT];
+	/* Channels with a value: read for the sample, or at least once in the bucket */
+	uint16_t channels;
+};
+
+void sensor_history_add(const struct sensor_record *record);
+
+/* Length of the bucket of a rollup entry, 0 for raw samples */
+uint32_t sensor_history_period_s(enum sensor_history_res res);
+
+/* Short name of a resolution ("raw", "1m", "1h") */
+const char *sensor_history_res_name(enum sensor_history_res res);
+
+/* Whether the entries are timestamped in Unix time yet */
+bool sensor_history_wall_clock(void);
+
+/**
+ * Get the time of the oldest entry of a resolution.
+ *
+ * @return false if the ring is empty
+ */
+bool sensor_history_oldest(enum sensor_history_res res, uint32_t *time_s);
+
+/**
+ * Copy the entries with from_s <= time_s <= to_s, oldest first, up to `max`
+ * entries, skipping those with a sequence number before `*seq`. On return,
+ * `*seq` is the sequence number of the first entry copied. The entries copied
+ * have consecutive sequence numbers, so a query from `*seq` plus the number
+ * of entries used continues after them, even within the same second. Start
+ * with `*seq` set to 0.
+ *
+ * @return Number of entries copied
+ */
+size_t sensor_history_query(enum sensor_history_res res, uint32_t from_s, uint32_t to_s,
+			    uint32_t *seq, struct sensor_history_entry *entries, size_t max);
+
+/* Count the entries with from_s <= time_s <= to_s */
+size_t sensor_history_count(enum sensor_history_res res, uint32_t from_s, uint32_t to_s);
+
+/**
+ * Expand an entry back into a record at the stream exponents, with its times
+ * converted to uptime.
+ *
+ * @return 0 on success, or the error of app_time_unix_to_uptime_ms()
+ */
+int sensor_history_unpack(enum sensor_history_res res, const struct sensor_history_entry *entry,
+			  struct sensor_record *record);
+
+#endif /* __SENSOR_HISTORY_H__ */
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(sensor_record, LOG_LEVEL_DBG);
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+
+#include "sensor_record.h"
+
+BUILD_ASSERT(SENSOR_CH_COUNT > 0, "At least one sensor must be enabled");
+BUILD_ASSERT(SENSOR_CH_COUNT <= 32, "Channel masks are 32 bits wide");
+
+#define SENSOR_CHANNEL_INFO(id, sensor, key, label, unit, exponent, hist_exp, slide, chan, field)  \
+	[SENSOR_CH_##id] = {key, label, unit, sensor, exponent, hist_exp, slide},
+
+/* Quantization is chosen so that typical sample-to-sample changes fit in one varint byte */
+const struct sensor_record_channel_info sensor_record_channels[SENSOR_CH_COUNT] = {
+	SENSOR_CHANNELS(SENSOR_CHANNEL_INFO)
+};
+
+/* Length written by snprintk, limited to what fits in a buffer of `avail` bytes */
+static size_t written_len(int ret, size_t avail)
+{
+	if ((ret < 0) || (avail == 0)) {
+		return 0;
+	}
+
+	return MIN((size_t)ret, avail - 1);
+}
+
+static uint32_t decimal_scale(int digits)
+{
+	uint32_t scale = 1;
+
+	while (digits-- > 0) {
+		scale *= 10;
+	}
+
+	return scale;
+}
+
+int32_t sensor_record_quantize(const struct sensor_value *val, int8_t exponent)
+{
+	int64_t micro = (int64_t)val->val1 * 1000000 + val->val2;
+	int64_t quantum = 1;
+
+	for (int i = 0; i < 6 + exponent; i++) {
+		quantum *= 10;
+	}
+
+	/* Round half away from zero */
+	if (micro >= 0) {
+		return (int32_t)((micro + quantum / 2) / quantum);
+	}
+
+	return (int32_t)((micro - quantum / 2) / quantum);
+}
+
+#define SENSOR_CHANNEL_FILL(id, sensor, key, label, unit, exponent, hist_exp, slide, chan, field)  \
+	record->values[SENSOR_CH_##id] = sensor_record_quantize(&readings->field, exponent);
+
+void sensor_record_fill(struct sensor_record *record, int64_t sample_ms,
+			const struct sensor_readings *readings)
+{
+	record->sample_ms = sample_ms;
+
+#ifdef CONFIG_APP_SENSOR_SPS30
+	record->win_start_ms = readings->sps30.window_start_ms;
+	record->win_end_ms = readings->sps30.window_end_ms;
+#else
+	/* Without the PM sensor every reading is instantaneous */
+	record->win_start_ms = sample_ms;
+	record->win_end_ms = sample_ms;
+#endif
+
+	SENSOR_CHANNELS(SENSOR_CHANNEL_FILL)
+}
+
+size_t sensor_record_format_value(char *buf, size_t len, int32_t value, int8_t exponent)
+{
+	uint32_t scale;
+	uint32_t magnitude;
+	int ret;
+
+	if (exponent >= 0) {
+		ret = snprintk(buf, len, "%lld", (long long)value * decimal_scale(exponent));
+		return written_len(ret, len);
+	}
+
+	scale = decimal_scale(-exponent);
+	magnitude = (value < 0) ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+
+	ret = snprintk(buf, len, "%s%u.%0*u", (value < 0) ? "-" : "", magnitude / scale, -exponent,
+		       magnitude % scale);
+
+	return written_len(ret, len);
+}
+
+int sensor_record_json_encode(const struct sensor_record *record, const char *prefix,
+			      uint32_t channels, char *buf, size_t len)
+{
+	bool first = true;
+	size_t pos;
+	int ret;
+
+	ret = snprintk(buf, len, "{%s", prefix);
+	if ((ret < 0) || ((size_t)ret >= len)) {
+		return -ENOMEM;
+	}
+	pos = ret;
+
+	for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+		const struct sensor_record_channel_info *ch = &sensor_record_channels[i];
+
+		if (!(channels & BIT(i))) {
+			continue;
+		}
+
+		ret = snprintk(&buf[pos], len - pos, "%s\"%s\":", first ? "" : ",", ch->name);
+		if ((ret < 0) || ((size_t)ret >= len - pos)) {
+			return -ENOMEM;
+		}
+		pos += ret;
+		first = false;
+
+		pos += sensor_record_format_value(&buf[pos], len - pos, record->values[i],
+						  ch->exponent);
+	}
+
+	/* Drop the comma after the prefix if no channel follows it */
+	if (first && (buf[pos - 1] == ',')) {
+		pos--;
+	}
+
+	/* Closing brace and NUL terminator */
+	if (pos + 2 > len) {
+		return -ENOMEM;
+	}
+
+	buf[pos++] = '}';
+	buf[pos] = '\0';
+
+	return 0;
+}
+
+void sensor_record_log(const struct sensor_record *record)
+{
+	for (int i = 0; i < SENSOR_CH_COUNT; i++) {
+		const struct sensor_record_channel_info *ch = &sensor_record_channels[i];
+		int32_t value = record->values[i];
+		uint32_t magnitude = (value < 0) ? (uint32_t)0 - (uint32_t)value : (uint32_t)value;
+		uint32_t scale;
+
+		if (ch->exponent >= 0) {
+			LOG_DBG("%s: %s=%s%u %s", ch->sensor, ch->label, (value < 0) ? "-" : "",
+				magnitude * decimal_scale(ch->exponent), ch->unit);
+			continue;
+		}
+
+		scale = decimal_scale(-ch->exponent);
+
+		LOG_DBG("%s: %s=%s%u.%0*u %s", ch->sensor, ch->label, (value < 0) ? "-" : "",
+			magnitude / scale, -ch->exponent, magnitude % scale, ch->unit);
+	}
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Fixed-point representation of one complete set of sensor readings.
+ *
+ * Each channel is stored as an integer with a fixed decimal exponent
+ * (value = integer * 10^exponent), which is what the encoders and other
+ * compact consumers work with. The channels are defined in sensor_channels.h.
+ */
+
+#ifndef __SENSOR_RECORD_H__
+#define __SENSOR_RECORD_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/drivers/sensor.h>
+#include <zephyr/sys/util.h>
+
+#include "sensor_bme280.h"
+#include "sensor_channels.h"
+#include "sensor_scd4x.h"
+#include "sensor_sps30.h"
+
+#define SENSOR_CHANNEL_ENUM(id, ...) SENSOR_CH_##id,
+enum sensor_record_channel {
+	SENSOR_CHANNELS(SENSOR_CHANNEL_ENUM)
+	SENSOR_CH_COUNT
+};
+#undef SENSOR_CHANNEL_ENUM
+
+/* Channel masks for sensor_record_json_encode() */
+#define SENSOR_CHANNEL_BIT(id, ...) BIT(SENSOR_CH_##id) |
+#define SENSOR_RECORD_CHANNELS_ALL    BIT_MASK(SENSOR_CH_COUNT)
+#define SENSOR_RECORD_CHANNELS_BME280 (SENSOR_CHANNELS_BME280(SENSOR_CHANNEL_BIT) 0)
+#define SENSOR_RECORD_CHANNELS_SCD4X  (SENSOR_CHANNELS_SCD4X(SENSOR_CHANNEL_BIT) 0)
+#define SENSOR_RECORD_CHANNELS_SPS30  (SENSOR_CHANNELS_SPS30(SENSOR_CHANNEL_BIT) 0)
+
+struct sensor_record_channel_info {
+	/* Key used in stream payloads */
+	const char *name;
+	const char *label;
+	const char *unit;
+	const char *sensor;
+	/* Decimal exponent of the fixed-point value */
+	int8_t exponent;
+	/* Decimal exponent of the 16-bit value kept in on-device history */
+	int8_t history_exponent;
+	bool slide;
+};
+
+extern const struct sensor_record_channel_info sensor_record_channels[SENSOR_CH_COUNT];
+
+/* Raw readings of all enabled sensors */
+struct sensor_readings {
+#ifdef CONFIG_APP_SENSOR_BME280
+	struct bme280_sensor_measurement bme280;
+#endif
+#ifdef CONFIG_APP_SENSOR_SCD4X
+	struct scd4x_sensor_measurement scd4x;
+#endif
+#ifdef CONFIG_APP_SENSOR_SPS30
+	struct sps30_sensor_measurement sps30;
+#endif
+};
+
+struct sensor_record {
+	/* Uptime at acquisition and of the PM averaging window */
+	int64_t sample_ms;
+	int64_t win_start_ms;
+	int64_t win_end_ms;
+	int32_t values[SENSOR_CH_COUNT];
+	/* Channels read for this record; the others repeat their previous value */
+	uint32_t channels;
+};
+
+int32_t sensor_record_quantize(const struct sensor_value *val, int8_t exponent);
+void sensor_record_fill(struct sensor_record *record, int64_t sample_ms,
+			const struct sensor_readings *readings);
+
+/**
+ * Format a fixed-point value as a decimal string with as many fractional
+ * digits as the exponent implies.
+ *
+ * @return Number of characters written, excluding the NUL terminator
+ */
+size_t sensor_record_format_value(char *buf, size_t len, int32_t value, int8_t exponent);
+
+/**
+ * Encode a record as a JSON object with one key per channel in the `channels`
+ * mask. `prefix` is inserted verbatim after the opening brace and must end
+ * with a comma if it is not empty.
+ *
+ * @return 0 on success, -ENOMEM if the buffer is too small
+ */
+int sensor_record_json_encode(const struct sensor_record *record, const char *prefix,
+			      uint32_t channels, char *buf, size_t len);
+
+/* Log the channels of a record at debug level, one line per channel */
+void sensor_record_log(const struct sensor_record *record);
+
+#endif /* __SENSOR_RECORD_H__ */
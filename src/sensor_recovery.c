@@ -0,0 +1,368 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(sensor_recovery, LOG_LEVEL_DBG);
+
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/reboot.h>
+#include <zephyr/task_wdt/task_wdt.h>
+
+#include "sensor_recovery.h"
+
+#define RECOVERY_WORKQ_STACK_SIZE 1536
+#define RECOVERY_WORKQ_PRIORITY	  5
+
+/* Marks the retained counters as initialized */
+#define RETAINED_MAGIC 0x52435659
+
+#define HEALTHY_S (CONFIG_APP_SENSOR_RECOVERY_HEALTHY_H * SEC_PER_HOUR)
+
+/* Kept across the reboot of the last recovery stage */
+static __noinit struct {
+	uint32_t magic;
+	uint32_t reboots;
+} retained;
+
+static const char *const stage_names[SENSOR_RECOVERY_STAGE_COUNT] = {
+	[SENSOR_RECOVERY_BUS] = "bus recovery",
+	[SENSOR_RECOVERY_REINIT] = "sensor re-init",
+	[SENSOR_RECOVERY_REBOOT] = "reboot",
+};
+
+static sys_slist_t targets = SYS_SLIST_STATIC_INIT(&targets);
+
+/* Recovery times, protected by stats_mutex. Reboots are counted in `retained`. */
+static struct sensor_recovery_stats stats;
+K_MUTEX_DEFINE(stats_mutex);
+
+static bool wdt_ready;
+static int wdt_channel = -1;
+/* Next stage to run on a watchdog expiry */
+static atomic_t wdt_stage;
+/* Set while the watchdog recovery work is running */
+static atomic_t wdt_busy;
+static atomic_t wdt_expiries;
+static atomic_t failed_count;
+/* Uptime in seconds of the last missed deadline or watchdog expiry, 0 for none */
+static atomic_t last_fault_s;
+
+K_THREAD_STACK_DEFINE(recovery_stack, RECOVERY_WORKQ_STACK_SIZE);
+static struct k_work_q recovery_work_q;
+
+static void recovery_work_handler(struct k_work *work);
+K_WORK_DEFINE(recovery_work, recovery_work_handler);
+
+static atomic_val_t uptime_s(void)
+{
+	return (atomic_val_t)(k_uptime_get() / MSEC_PER_SEC);
+}
+
+/* May be called from the watchdog ISR */
+static void reboot(const char *name)
+{
+	retained.reboots++;
+
+	LOG_ERR("Rebooting to recover %s", name);
+	LOG_PANIC();
+
+	sys_reboot(SYS_REBOOT_COLD);
+}
+
+/* May be called from the watchdog ISR */
+static void give_up(struct sensor_recovery_target *target)
+{
+	if (atomic_set(&target->failed, 1) == 0) {
+		atomic_inc(&failed_count);
+		LOG_ERR("Giving up on %s after %u recovery reboot(s)", target->name,
+			retained.reboots);
+	}
+}
+
+/* Run the last stage: reboot, or give up once the reboots are used up */
+static void reboot_or_give_up(struct sensor_recovery_target *target)
+{
+	if (retained.reboots < CONFIG_APP_SENSOR_RECOVERY_MAX_REBOOTS) {
+		reboot(target->name);
+	} else {
+		give_up(target);
+	}
+}
+
+static void record_stage(enum sensor_recovery_stage stage, int64_t start_ms)
+{
+	uint32_t elapsed_ms = (uint32_t)(k_uptime_get() - start_ms);
+
+	k_mutex_lock(&stats_mutex, K_FOREVER);
+
+	stats.count[stage]++;
+	stats.total_ms[stage] += elapsed_ms;
+	stats.max_ms[stage] = MAX(stats.max_ms[stage], elapsed_ms);
+
+	k_mutex_unlock(&stats_mutex);
+
+	LOG_INF("%s took %u ms", stage_names[stage], elapsed_ms);
+}
+
+static void run_bus_recovery(const struct device *bus)
+{
+	int64_t start_ms = k_uptime_get();
+	int err;
+
+	LOG_WRN("Recovering I2C bus %s", bus->name);
+
+	err = i2c_recover_bus(bus);
+	if (err) {
+		LOG_ERR("Failed to recover I2C bus %s: %d", bus->name, err);
+	}
+
+	record_stage(SENSOR_RECOVERY_BUS, start_ms);
+}
+
+static void run_reinit(struct sensor_recovery_target *target)
+{
+	int64_t start_ms = k_uptime_get();
+	int err;
+
+	if (!target->reinit) {
+		LOG_WRN("%s cannot be reinitialized", target->name);
+		return;
+	}
+
+	LOG_WRN("Reinitializing %s", target->name);
+
+	err = target->reinit();
+	if (err) {
+		LOG_ERR("Failed to reinitialize %s: %d", target->name, err);
+	}
+
+	record_stage(SENSOR_RECOVERY_REINIT, start_ms);
+}
+
+static void run_stage(struct sensor_recovery_target *target, enum sensor_recovery_stage stage)
+{
+	switch (stage) {
+	case SENSOR_RECOVERY_BUS:
+		run_bus_recovery(target->bus);
+		break;
+	case SENSOR_RECOVERY_REINIT:
+		run_reinit(target);
+		break;
+	default:
+		reboot_or_give_up(target);
+		break;
+	}
+}
+
+/* Whether an earlier target shares the bus of `target` */
+static bool bus_seen(struct sensor_recovery_target *target)
+{
+	struct sensor_recovery_target *other;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&targets, other, node) {
+		if (other == target) {
+			return false;
+		}
+		if (other->bus == target->bus) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* The reading thread is stuck, so every sensor is a suspect */
+static void recovery_work_handler(struct k_work *work)
+{
+	/* The expiry that submitted this work claimed the stage before wdt_stage */
+	enum sensor_recovery_stage stage = atomic_get(&wdt_stage) - 1;
+	struct sensor_recovery_target *target;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&targets, target, node) {
+		/* Sensors usually share a bus, which only needs to be recovered once */
+		if ((stage == SENSOR_RECOVERY_BUS) && bus_seen(target)) {
+			continue;
+		}
+
+		run_stage(target, stage);
+	}
+
+	atomic_clear(&wdt_busy);
+}
+
+/* Called from the system clock ISR */
+static void watchdog_expired(int channel_id, void *user_data)
+{
+	atomic_val_t stage = atomic_inc(&wdt_stage);
+	struct sensor_recovery_target *target;
+
+	atomic_inc(&wdt_expiries);
+	atomic_set(&last_fault_s, uptime_s());
+
+	LOG_ERR("Sensor acquisition missed its watchdog deadline");
+
+	/* Give up if the previous stage is itself stuck */
+	if ((stage >= SENSOR_RECOVERY_REBOOT) || !atomic_cas(&wdt_busy, 0, 1)) {
+		if (retained.reboots < CONFIG_APP_SENSOR_RECOVERY_MAX_REBOOTS) {
+			reboot("sensor acquisition");
+			return;
+		}
+
+		/* Any of them may be holding the reading thread */
+		SYS_SLIST_FOR_EACH_CONTAINER(&targets, target, node) {
+			give_up(target);
+		}
+		return;
+	}
+
+	/* Re-arm the channel for the next stage */
+	task_wdt_feed(channel_id);
+
+	k_work_submit_to_queue(&recovery_work_q, &recovery_work);
+}
+
+int sensor_recovery_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "sensor_recovery",
+	};
+	const struct device *hw_wdt = DEVICE_DT_GET_OR_NULL(DT_ALIAS(watchdog0));
+	int err;
+
+	if (retained.magic != RETAINED_MAGIC) {
+		retained.magic = RETAINED_MAGIC;
+		retained.reboots = 0;
+	} else if (retained.reboots > 0) {
+		LOG_WRN("Sensor recovery rebooted the device %u time(s)", retained.reboots);
+	}
+
+	k_work_queue_start(&recovery_work_q, recovery_stack,
+			   K_THREAD_STACK_SIZEOF(recovery_stack), RECOVERY_WORKQ_PRIORITY, &cfg);
+
+	if (!IS_ENABLED(CONFIG_TASK_WDT_HW_FALLBACK) || (hw_wdt && !device_is_ready(hw_wdt))) {
+		hw_wdt = NULL;
+	}
+
+	err = task_wdt_init(hw_wdt);
+	if (err) {
+		LOG_ERR("Failed to initialize task watchdog: %d", err);
+		return err;
+	}
+
+	wdt_ready = true;
+
+	return 0;
+}
+
+void sensor_recovery_add(struct sensor_recovery_target *target)
+{
+	sys_slist_append(&targets, &target->node);
+}
+
+void sensor_recovery_watch(uint32_t timeout_ms)
+{
+	if (!wdt_ready) {
+		return;
+	}
+
+	atomic_set(&wdt_stage, SENSOR_RECOVERY_BUS);
+
+	wdt_channel = task_wdt_add(timeout_ms + CONFIG_APP_SENSOR_WATCHDOG_GRACE_MS,
+				   watchdog_expired, NULL);
+	if (wdt_channel < 0) {
+		LOG_ERR("Failed to add task watchdog channel: %d", wdt_channel);
+	}
+}
+
+void sensor_recovery_unwatch(void)
+{
+	if (wdt_channel >= 0) {
+		task_wdt_delete(wdt_channel);
+		wdt_channel = -1;
+	}
+}
+
+void sensor_recovery_report(struct sensor_recovery_target *target, bool missed)
+{
+	enum sensor_recovery_stage stage;
+
+	if (!missed) {
+		if (target->misses > 0) {
+			LOG_INF("%s is reading again after %u missed deadline(s)", target->name,
+				target->misses);
+		}
+		target->misses = 0;
+
+		/* Faults this far apart are unrelated, so they get a fresh set of reboots */
+		if ((retained.reboots > 0) &&
+		    ((uptime_s() - atomic_get(&last_fault_s)) >= HEALTHY_S)) {
+			LOG_INF("No missed deadline for %u h, resetting %u recovery reboot(s)",
+				CONFIG_APP_SENSOR_RECOVERY_HEALTHY_H, retained.reboots);
+			retained.reboots = 0;
+		}
+		return;
+	}
+
+	atomic_set(&last_fault_s, uptime_s());
+
+	stage = MIN(target->misses, SENSOR_RECOVERY_REBOOT);
+	target->misses = MIN(target->misses + 1, UINT8_MAX);
+
+	LOG_WRN("%s missed %u read deadline(s) in a row, trying %s", target->name,
+		target->misses, stage_names[stage]);
+
+	run_stage(target, stage);
+}
+
+bool sensor_recovery_failed(struct sensor_recovery_target *target)
+{
+	return atomic_get(&target->failed) != 0;
+}
+
+void sensor_recovery_track(struct sensor_recovery_target *target, bool lost)
+{
+	uint32_t elapsed_ms;
+
+	if (lost) {
+		if (target->lost++ == 0) {
+			target->outage_start_ms = k_uptime_get();
+		}
+		return;
+	}
+
+	if (target->lost == 0) {
+		return;
+	}
+
+	elapsed_ms = (uint32_t)(k_uptime_get() - target->outage_start_ms);
+
+	LOG_INF("%s recovered after %u lost reading(s) over %u ms", target->name, target->lost,
+		elapsed_ms);
+
+	k_mutex_lock(&stats_mutex, K_FOREVER);
+
+	stats.outages++;
+	stats.lost += target->lost;
+	stats.outage_total_ms += elapsed_ms;
+	stats.outage_max_ms = MAX(stats.outage_max_ms, elapsed_ms);
+
+	k_mutex_unlock(&stats_mutex);
+
+	target->lost = 0;
+}
+
+void sensor_recovery_stats_get(struct sensor_recovery_stats *out)
+{
+	k_mutex_lock(&stats_mutex, K_FOREVER);
+	*out = stats;
+	k_mutex_unlock(&stats_mutex);
+
+	out->count[SENSOR_RECOVERY_REBOOT] = retained.reboots;
+	out->watchdog = atomic_get(&wdt_expiries);
+	out->failed = atomic_get(&failed_count);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Staged recovery of sensors that stop responding.
+ *
+ * Every sensor read has a deadline (see sensor_async.c). Each consecutive
+ * missed deadline of a sensor escalates its recovery by one stage: recover
+ * the I2C bus, then reinitialize the sensor, then reboot. A read that
+ * completes in time resets the escalation.
+ *
+ * The whole acquisition is also watched with the Zephyr task watchdog, for
+ * the case where the reading thread itself hangs (e.g. on a driver lock held
+ * by a stuck bus transfer). Each expiry runs the next stage for every sensor
+ * from a dedicated work queue, and an expiry while that recovery is still
+ * running reboots the device.
+ *
+ * Reboots are capped at APP_SENSOR_RECOVERY_MAX_REBOOTS until the device is
+ * power cycled, or until no deadline has been missed for
+ * APP_SENSOR_RECOVERY_HEALTHY_H hours of successful reads. Past the cap, a
+ * sensor that reaches the reboot stage is marked failed instead and left out
+ * of acquisition until the next reboot; a watchdog expiry marks every sensor
+ * failed, as the one holding the thread is unknown.
+ *
+ * The number of recoveries and the time spent in each stage are counted;
+ * the reboot count survives the reboot it causes. So are outages: runs of
+ * lost readings of a sensor, whether the reads failed or missed their
+ * deadline, from the first lost reading to the next good one.
+ */
+
+#ifndef __SENSOR_RECOVERY_H__
+#define __SENSOR_RECOVERY_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/slist.h>
+
+enum sensor_recovery_stage {
+	SENSOR_RECOVERY_BUS,
+	SENSOR_RECOVERY_REINIT,
+	SENSOR_RECOVERY_REBOOT,
+	SENSOR_RECOVERY_STAGE_COUNT
+};
+
+struct sensor_recovery_target {
+	const char *name;
+	/* I2C bus of the sensor */
+	const struct device *bus;
+	/* Return the sensor to its default state, or NULL if it has no such command */
+	int (*reinit)(void);
+	/* Consecutive missed deadlines */
+	uint8_t misses;
+	/* Set once recovery has given up on the sensor */
+	atomic_t failed;
+	/* Readings lost in the current outage, and the uptime of the first */
+	uint32_t lost;
+	int64_t outage_start_ms;
+	sys_snode_t node;
+};
+
+struct sensor_recovery_stats {
+	uint32_t count[SENSOR_RECOVERY_STAGE_COUNT];
+	/* Time spent recovering, 0 for reboots */
+	uint32_t total_ms[SENSOR_RECOVERY_STAGE_COUNT];
+	uint32_t max_ms[SENSOR_RECOVERY_STAGE_COUNT];
+	/* Task watchdog expiries */
+	uint32_t watchdog;
+	/* Sensors given up on once the reboots were used up */
+	uint32_t failed;
+	/* Outages that ended with a good reading, and the readings they lost */
+	uint32_t outages;
+	uint32_t lost;
+	uint32_t outage_total_ms;
+	uint32_t outage_max_ms;
+};
+
+/* Start the task watchdog */
+int sensor_recovery_init(void);
+
+/* Make a sensor known to recoveries triggered by the task watchdog */
+void sensor_recovery_add(struct sensor_recovery_target *target);
+
+/**
+ * Arm the task watchdog for an acquisition expected to take up to
+ * `timeout_ms`, plus the grace period of APP_SENSOR_WATCHDOG_GRACE_MS.
+ */
+void sensor_recovery_watch(uint32_t timeout_ms);
+void sensor_recovery_unwatch(void);
+
+/* Report whether a read met its deadline, running the next recovery stage on a miss */
+void sensor_recovery_report(struct sensor_recovery_target *target, bool missed);
+
+/* Whether recovery has given up on the sensor, which should no longer be read */
+bool sensor_recovery_failed(struct sensor_recovery_target *target);
+
+/* Count a reading of the sensor, or its loss, towards the outage statistics */
+void sensor_recovery_track(struct sensor_recovery_target *target, bool lost);
+
+void sensor_recovery_stats_get(struct sensor_recovery_stats *stats);
+
+#endif /* __SENSOR_RECOVERY_H__ */
@@ -8,208 +8,187 @@
 LOG_MODULE_REGISTER(sensor_scd4x, LOG_LEVEL_DBG);
 
 #include <zephyr/drivers/sensor.h>
+#include <drivers/sensor/scd4x.h>
 
+#include "app_trace.h"
 #include "sensor_scd4x.h"
-#include "app_settings.h"
-#include "sensirion_common.h"
-#include "sensirion_i2c_hal.h"
-#include "scd4x_i2c.h"
 
 #define SCD4X_MUTEX_TIMEOUT 6000
 
 K_MUTEX_DEFINE(scd4x_mutex);
 
-int scd4x_sensor_init(void)
+static const struct device *scd4x_dev = DEVICE_DT_GET_ONE(sensirion_scd4x);
+
+/* Settings applied so far, indexed from SENSOR_ATTR_SCD4X_TEMPERATURE_OFFSET. A re-init resets
+ * the sensor to its defaults, so they are applied again afterwards. Protected by scd4x_mutex.
+ */
+#define SCD4X_SETTING_COUNT (SENSOR_ATTR_SCD4X_REINIT - SENSOR_ATTR_SCD4X_TEMPERATURE_OFFSET)
+static struct sensor_value scd4x_settings[SCD4X_SETTING_COUNT];
+static uint8_t scd4x_settings_applied;
+
+static int scd4x_lock(void)
 {
 	int err;
-	uint16_t serial_0, serial_1, serial_2;
-	struct scd4x_sensor_measurement measurement;
-
-	LOG_DBG("Initializing SCD4x CO₂ sensor");
 
+	app_trace_begin("scd4x_mutex_wait", 0);
 	err = k_mutex_lock(&scd4x_mutex, K_MSEC(SCD4X_MUTEX_TIMEOUT));
+	app_trace_end("scd4x_mutex_wait", err);
+
 	if (err) {
 		LOG_ERR("Error locking SCD4x mutex (lock count: %u): %d", scd4x_mutex.lock_count,
 			err);
-		return err;
 	}
 
-	/* After VDD reaches 2.25V, SCD4x needs 1000 ms to enter idle state */
-	/* Sleep the full 1000 ms here just to be safe */
-	sensirion_i2c_hal_sleep_usec(SCD4X_POWER_UP_DELAY_USEC);
+	return err;
+}
 
-	/* Wake up and reinitialize SCD4x to the default state */
-	err = scd4x_wake_up();
-	if (err) {
-		LOG_ERR("Error %d: SCD4x wakeup failed", err);
-		k_mutex_unlock(&scd4x_mutex);
-		return err;
-	}
+int scd4x_sensor_init(void)
+{
+	int err;
 
-	err = scd4x_stop_periodic_measurement();
-	if (err) {
-		LOG_ERR("Error %d: SCD4x stop periodic measurement failed", err);
-		k_mutex_unlock(&scd4x_mutex);
-		return err;
+	LOG_DBG("Initializing SCD4x CO₂ sensor");
+
+	if (!device_is_ready(scd4x_dev)) {
+		LOG_ERR("Device \"%s\" is not ready", scd4x_dev->name);
+		return -ENODEV;
 	}
 
-	err = scd4x_reinit();
+	/* According to the datasheet, the first reading obtained after waking
+	 * up the sensor must be discarded, so do a throw-away measurement now
+	 */
+	err = sensor_sample_fetch(scd4x_dev);
 	if (err) {
-		LOG_ERR("Error %d: SCD4x reinit failed", err);
-		k_mutex_unlock(&scd4x_mutex);
-		return err;
+		LOG_ERR("Error fetching SCD4x sample: %d", err);
 	}
 
-	/* Since SCD4x doesn't ack wake_up, read SCD4x serial number instead */
-	err = scd4x_get_serial_number(&serial_0, &serial_1, &serial_2);
+	return err;
+}
+
+int scd4x_sensor_read_begin(bool fast)
+{
+	/* Single-shot measurements take the same time either way */
+	ARG_UNUSED(fast);
+
+	LOG_DBG("Reading SCD4x CO₂ sensor (~5 seconds)");
+
+	return scd4x_lock();
+}
+
+void scd4x_sensor_read_end(void)
+{
+	k_mutex_unlock(&scd4x_mutex);
+}
+
+static int scd4x_sensor_attr_set(enum sensor_attribute attr, const struct sensor_value *val)
+{
+	int err;
+
+	err = scd4x_lock();
 	if (err) {
-		LOG_ERR("Cannot read SCD4x serial number (error: %d)", err);
-		k_mutex_unlock(&scd4x_mutex);
 		return err;
 	}
 
-	LOG_DBG("SCD4x serial number: 0x%04x%04x%04x", serial_0, serial_1, serial_2);
+	err = sensor_attr_set(scd4x_dev, SENSOR_CHAN_ALL, attr, val);
+	if (!err) {
+		int index = (int)attr - SENSOR_ATTR_SCD4X_TEMPERATURE_OFFSET;
 
-	/* According to the datasheet, the first reading obtained after waking
-	 * up the sensor must be discarded, so do a throw-away measurement now
-	 */
-	err = scd4x_sensor_read(&measurement);
+		scd4x_settings[index] = *val;
+		scd4x_settings_applied |= BIT(index);
+	}
 
 	k_mutex_unlock(&scd4x_mutex);
 
 	return err;
 }
 
-int scd4x_sensor_read(struct scd4x_sensor_measurement *measurement)
+int scd4x_sensor_reinit(void)
 {
 	int err;
-	bool data_ready_flag = false;
-	uint16_t co2_ppm;
-	int32_t temperature_m_deg_c, humidity_m_percent_rh;
-	float temperature_deg_c, humidity_percent_rh;
 
-	LOG_DBG("Reading SCD4x CO₂ sensor (~%d seconds)",
-		(SCD4X_MEASUREMENT_DURATION_USEC / 1000000));
+	LOG_INF("Reinitializing SCD4x CO₂ sensor");
 
-	err = k_mutex_lock(&scd4x_mutex, K_MSEC(SCD4X_MUTEX_TIMEOUT));
+	err = scd4x_lock();
 	if (err) {
-		LOG_ERR("Error locking SCD4x mutex (lock count: %u): %d", scd4x_mutex.lock_count,
-			err);
 		return err;
 	}
 
-	/* Request a single-shot measurement */
-	err = scd4x_measure_single_shot();
+	err = sensor_attr_set(scd4x_dev, SENSOR_CHAN_ALL,
+			      (enum sensor_attribute)SENSOR_ATTR_SCD4X_REINIT, NULL);
 	if (err) {
-		LOG_ERR("Error entering SCD4x single-shot measurement mode (error: %d)", err);
+		LOG_ERR("SCD4x reinitialization failed (error: %d)", err);
 		k_mutex_unlock(&scd4x_mutex);
 		return err;
 	}
 
-	/* Sleep while measurement is being taken */
-	sensirion_i2c_hal_sleep_usec(SCD4X_MEASUREMENT_DURATION_USEC);
+	for (int i = 0; i < SCD4X_SETTING_COUNT; i++) {
+		int attr = SENSOR_ATTR_SCD4X_TEMPERATURE_OFFSET + i;
+		int ret;
 
-	/* Poll the sensor every 0.1s waiting for the data ready status */
-	while (!data_ready_flag) {
-		err = scd4x_get_data_ready_flag(&data_ready_flag);
-		if (err) {
-			LOG_ERR("Error reading SCD4x data ready status flag: %d", err);
-			k_mutex_unlock(&scd4x_mutex);
-			return err;
+		if (!(scd4x_settings_applied & BIT(i))) {
+			continue;
 		}
 
-		sensirion_i2c_hal_sleep_usec(100000);
-	}
-
-	/* Read the single-shot measurement */
-	err = scd4x_read_measurement(&co2_ppm, &temperature_m_deg_c, &humidity_m_percent_rh);
-	if (err) {
-		LOG_ERR("Error reading SCD4x measurement: %d", err);
-		k_mutex_unlock(&scd4x_mutex);
-		return err;
-	} else if (co2_ppm == 0) {
-		LOG_ERR("Invalid SCD4x measurement sample");
-		k_mutex_unlock(&scd4x_mutex);
-		return err;
+		ret = sensor_attr_set(scd4x_dev, SENSOR_CHAN_ALL, (enum sensor_attribute)attr,
+				      &scd4x_settings[i]);
+		if (ret) {
+			LOG_ERR("Error restoring SCD4x setting %d (error: %d)", i, ret);
+			err = ret;
+		}
 	}
 
-	temperature_deg_c = temperature_m_deg_c / 1000.0;
-	humidity_percent_rh = humidity_m_percent_rh / 1000.0;
-
-	measurement->co2 = co2_ppm;
-	sensor_value_from_double(&measurement->temperature, temperature_deg_c);
-	sensor_value_from_double(&measurement->humidity, humidity_percent_rh);
-
 	k_mutex_unlock(&scd4x_mutex);
 
 	return err;
 }
 
-void scd4x_log_measurements(struct scd4x_sensor_measurement *measurement)
+uint32_t scd4x_sensor_read_duration_ms(bool fast)
 {
-	LOG_DBG("scd4x: CO₂=%u ppm, Temperature=%.2lf °C, Humidity=%.2lf %%RH", measurement->co2,
-		sensor_value_to_double(&measurement->temperature),
-		sensor_value_to_double(&measurement->humidity));
+	/* Single-shot measurements take the same time either way */
+	ARG_UNUSED(fast);
+
+	return SCD4X_MEASURE_MAX_MS;
 }
 
 int scd4x_sensor_set_temperature_offset(int32_t t_offset_m_deg_c)
 {
+	struct sensor_value val;
 	int err;
 
-	err = k_mutex_lock(&scd4x_mutex, K_MSEC(SCD4X_MUTEX_TIMEOUT));
-	if (err) {
-		LOG_ERR("Error locking SCD4x mutex (lock count: %u): %d", scd4x_mutex.lock_count,
-			err);
-		return err;
-	}
+	sensor_value_from_milli(&val, t_offset_m_deg_c);
 
-	err = scd4x_set_temperature_offset(t_offset_m_deg_c);
+	err = scd4x_sensor_attr_set((enum sensor_attribute)SENSOR_ATTR_SCD4X_TEMPERATURE_OFFSET,
+				    &val);
 	if (err) {
 		LOG_ERR("Error setting SCD4x temperature offset (error: %d)", err);
 	} else {
 		LOG_INF("Set SCD4x temperature offset setting to %d m°C", t_offset_m_deg_c);
 	}
 
-	k_mutex_unlock(&scd4x_mutex);
-
 	return err;
 }
 
 int scd4x_sensor_set_sensor_altitude(int16_t sensor_altitude)
 {
+	struct sensor_value val = {.val1 = sensor_altitude};
 	int err;
 
-	err = k_mutex_lock(&scd4x_mutex, K_MSEC(SCD4X_MUTEX_TIMEOUT));
-	if (err) {
-		LOG_ERR("Error locking SCD4x mutex (lock count: %u): %d", scd4x_mutex.lock_count,
-			err);
-		return err;
-	}
-
-	err = scd4x_set_sensor_altitude(sensor_altitude);
+	err = scd4x_sensor_attr_set((enum sensor_attribute)SENSOR_ATTR_SCD4X_ALTITUDE, &val);
 	if (err) {
 		LOG_ERR("Error setting SCD4x altitude (error: %d)", err);
 	} else {
 		LOG_INF("Set SCD4x altitude setting to %d meters", sensor_altitude);
 	}
 
-	k_mutex_unlock(&scd4x_mutex);
-
 	return err;
 }
 
 int scd4x_sensor_set_automatic_self_calibration(bool asc_enabled)
 {
+	struct sensor_value val = {.val1 = asc_enabled};
 	int err;
 
-	err = k_mutex_lock(&scd4x_mutex, K_MSEC(SCD4X_MUTEX_TIMEOUT));
-	if (err) {
-		LOG_ERR("Error locking SCD4x mutex (lock count: %u): %d", scd4x_mutex.lock_count,
-			err);
-		return err;
-	}
-
-	err = scd4x_set_automatic_self_calibration(asc_enabled);
+	err = scd4x_sensor_attr_set(
+		(enum sensor_attribute)SENSOR_ATTR_SCD4X_AUTOMATIC_SELF_CALIBRATION, &val);
 	if (err) {
 		LOG_ERR("Error setting SCD4x automatic self-calibration (error: %d)", err);
 	} else {
@@ -220,7 +199,5 @@ int scd4x_sensor_set_automatic_self_calibration(bool asc_enabled)
 		}
 	}
 
-	k_mutex_unlock(&scd4x_mutex);
-
 	return err;
 }
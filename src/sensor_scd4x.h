@@ -7,17 +7,25 @@
 #ifndef __SENSOR_SCD4X_H__
 #define __SENSOR_SCD4X_H__
 
+#include <stdbool.h>
 #include <zephyr/drivers/sensor.h>
 
 struct scd4x_sensor_measurement {
-	uint16_t co2;
-	struct sensor_value temperature;
-	struct sensor_value humidity;
+	struct sensor_value co2;
 };
 
 int scd4x_sensor_init(void);
-int scd4x_sensor_read(struct scd4x_sensor_measurement *measurement);
-void scd4x_log_measurements(struct scd4x_sensor_measurement *measurement);
+
+/* Hold off setting changes while a measurement is in progress */
+int scd4x_sensor_read_begin(bool fast);
+void scd4x_sensor_read_end(void);
+
+/* Longest a read may take from scd4x_sensor_read_begin() */
+uint32_t scd4x_sensor_read_duration_ms(bool fast);
+
+/* Abort a read in progress and return the sensor to its default state, keeping the settings */
+int scd4x_sensor_reinit(void);
+
 int scd4x_sensor_set_temperature_offset(int32_t t_offset_m_deg_c);
 int scd4x_sensor_set_sensor_altitude(int16_t sensor_altitude);
 int scd4x_sensor_set_automatic_self_calibration(bool asc_enabled);
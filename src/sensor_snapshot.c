@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+#include "sensor_snapshot.h"
+
+/*
+ * The sequence counter selects the copy readers use: while it is odd the
+ * writer is updating copy 0 and readers use copy 1, and while it is even the
+ * writer is updating copy 1 (or idle) and readers use copy 0. Atomic
+ * operations are full barriers, which orders the copies against the counter.
+ */
+static atomic_t seq;
+static struct sensor_snapshot copies[2];
+static atomic_t published;
+
+/* Only touched by the writer */
+static struct sensor_snapshot latest;
+
+void sensor_snapshot_publish(const struct sensor_record *record)
+{
+	uint32_t channels = latest.record.channels;
+
+	if (!atomic_get(&published)) {
+		for (size_t i = 0; i < SENSOR_CH_COUNT; i++) {
+			latest.read_ms[i] = -1;
+		}
+		channels = 0;
+	}
+
+	for (size_t i = 0; i < SENSOR_CH_COUNT; i++) {
+		if (record->channels & BIT(i)) {
+			latest.read_ms[i] = record->sample_ms;
+		}
+	}
+
+	latest.record = *record;
+	latest.record.channels = channels | record->channels;
+
+	atomic_inc(&seq);
+	copies[0] = latest;
+	atomic_inc(&seq);
+	copies[1] = latest;
+
+	atomic_set(&published, 1);
+}
+
+bool sensor_snapshot_read(struct sensor_snapshot *snapshot)
+{
+	atomic_val_t start;
+
+	if (!atomic_get(&published)) {
+		return false;
+	}
+
+	do {
+		start = atomic_get(&seq);
+		memcpy(snapshot, &copies[start & 1], sizeof(*snapshot));
+	} while (atomic_get(&seq) != start);
+
+	return true;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Latest complete sensor record, shared between the sampling thread and any
+ * number of readers (RPCs, display, alerts), with the time each channel was
+ * last read. Sensors have their own cadences, so a channel may be older than
+ * the record.
+ *
+ * The record is double-buffered behind a sequence counter: the writer updates
+ * one copy while readers use the other, so a reader never waits for the
+ * writer and the writer never waits for readers. A reader retries only if the
+ * writer preempted it mid-copy.
+ */
+
+#ifndef __SENSOR_SNAPSHOT_H__
+#define __SENSOR_SNAPSHOT_H__
+
+#include <stdbool.h>
+
+#include <stdint.h>
+
+#include "sensor_record.h"
+
+struct sensor_snapshot {
+	/* Latest record; `channels` holds the channels that were ever read */
+	struct sensor_record record;
+	/* Uptime at which each channel was last read, or -1 if it never was */
+	int64_t read_ms[SENSOR_CH_COUNT];
+};
+
+/* Publish a new record. Only one thread may publish at a time. */
+void sensor_snapshot_publish(const struct sensor_record *record);
+
+/**
+ * Copy the latest snapshot.
+ *
+ * @return false if no record has been published yet
+ */
+bool sensor_snapshot_read(struct sensor_snapshot *snapshot);
+
+#endif /* __SENSOR_SNAPSHOT_H__ */
@@ -8,224 +8,411 @@
 LOG_MODULE_REGISTER(sensor_sps30, LOG_LEVEL_DBG);
 
 #include <zephyr/drivers/sensor.h>
+#include <drivers/sensor/sps30.h>
 
 #include "sensor_sps30.h"
+#include "app_schedule.h"
 #include "app_settings.h"
-#include "sensirion_common.h"
-#include "sensirion_i2c_hal.h"
-#include "sps30.h"
+#include "app_trace.h"
+#include "sensor_record.h"
 
 #define SPS30_MUTEX_TIMEOUT 60000
+/* Reads only wait out short commands; the mutex is not held during a fan cleaning */
+#define SPS30_READ_MUTEX_TIMEOUT 12000
+#define SPS30_FAN_CLEAN_MS	 (10 * MSEC_PER_SEC)
 
 K_MUTEX_DEFINE(sps30_mutex);
 
-int sps30_sensor_init(void)
+static const struct device *sps30_dev = DEVICE_DT_GET_ONE(sensirion_sps30);
+
+/* Fan/measurement state, protected by sps30_mutex */
+static bool sps30_running;
+static int64_t sps30_started_ms;
+static int64_t sps30_fan_on_ms;
+/* Uptime at which a manual fan cleaning ends */
+static int64_t sps30_clean_end_ms;
+
+/* How to restore the sensor after a command that needs it awake */
+struct sps30_command_state {
+	bool was_asleep;
+	bool wake_pending;
+};
+
+static void sps30_wake_work_handler(struct k_work *work);
+K_WORK_DELAYABLE_DEFINE(sps30_wake_work, sps30_wake_work_handler);
+
+static int sps30_lock(k_timeout_t timeout)
 {
 	int err;
-	uint8_t fw_major;
-	uint8_t fw_minor;
-	char serial_number[SPS30_MAX_SERIAL_LEN];
 
-	LOG_DBG("Initializing SPS30 PM sensor (~30 seconds)");
+	app_trace_begin("sps30_mutex_wait", 0);
+	err = k_mutex_lock(&sps30_mutex, timeout);
+	app_trace_end("sps30_mutex_wait", err);
 
-	err = k_mutex_lock(&sps30_mutex, K_MSEC(SPS30_MUTEX_TIMEOUT));
 	if (err) {
 		LOG_ERR("Error locking SPS30 mutex (lock count: %u): %d", sps30_mutex.lock_count,
 			err);
+	}
+
+	return err;
+}
+
+/* Must be called with sps30_mutex held */
+static int sps30_attr_set(enum sensor_attribute_sps30 attr, int32_t value)
+{
+	struct sensor_value val = {.val1 = value};
+
+	return sensor_attr_set(sps30_dev, SENSOR_CHAN_ALL, (enum sensor_attribute)attr, &val);
+}
+
+/* Must be called with sps30_mutex held */
+static void sps30_mark_running(bool running)
+{
+	int64_t now = k_uptime_get();
+
+	if (running && !sps30_running) {
+		sps30_started_ms = now;
+	} else if (!running && sps30_running) {
+		sps30_fan_on_ms += now - sps30_started_ms;
+	}
+
+	sps30_running = running;
+}
+
+static int sps30_sensor_wake(void)
+{
+	int err;
+
+	err = sps30_lock(K_MSEC(SPS30_MUTEX_TIMEOUT));
+	if (err) {
 		return err;
 	}
 
-	err = sps30_reset();
+	if (sps30_running) {
+		k_mutex_unlock(&sps30_mutex);
+		return 0;
+	}
+
+	LOG_DBG("Waking SPS30 PM sensor");
+
+	err = sps30_attr_set(SENSOR_ATTR_SPS30_SLEEP, 0);
 	if (err) {
-		LOG_ERR("SPS30 sensor reset failed");
+		LOG_ERR("Error entering SPS30 measurement mode (error: %d)", err);
 		k_mutex_unlock(&sps30_mutex);
 		return err;
 	}
-	sensirion_i2c_hal_sleep_usec(SPS30_RESET_DELAY_USEC);
 
-	uint8_t tries = 10;
-	while (tries != 0) {
-		LOG_DBG("Probing for SPS30 sensor");
-		err = sps30_probe();
-		if (err == 0) {
-			break;
-		}
-		tries--;
-		/* Sleep 1s and try again */
-		sensirion_i2c_hal_sleep_usec(1000000);
+	sps30_mark_running(true);
+
+	k_mutex_unlock(&sps30_mutex);
+
+	return 0;
+}
+
+static int sps30_sensor_sleep(void)
+{
+	int err;
+
+	err = sps30_lock(K_MSEC(SPS30_MUTEX_TIMEOUT));
+	if (err) {
+		return err;
 	}
 
+	if (!sps30_running) {
+		k_mutex_unlock(&sps30_mutex);
+		return 0;
+	}
+
+	LOG_DBG("Putting SPS30 PM sensor to sleep");
+
+	err = sps30_attr_set(SENSOR_ATTR_SPS30_SLEEP, 1);
 	if (err) {
-		LOG_ERR("SPS30 sensor probing failed");
+		LOG_ERR("Error stopping SPS30 measurement (error: %d)", err);
 		k_mutex_unlock(&sps30_mutex);
 		return err;
 	}
 
-	err = sps30_read_firmware_version(&fw_major, &fw_minor);
+	sps30_mark_running(false);
+
+	k_mutex_unlock(&sps30_mutex);
+
+	return 0;
+}
+
+static void sps30_wake_work_handler(struct k_work *work)
+{
+	sps30_sensor_wake();
+}
+
+static int64_t sps30_warmup_ms(const struct app_settings *settings)
+{
+	return (int64_t)settings->sps30_warmup_s * MSEC_PER_SEC;
+}
+
+/* Wake the sensor early enough that it has stabilized when the next cycle starts */
+static void sps30_schedule_next_window(void)
+{
+	struct app_settings settings;
+	int64_t sleep_ms;
+
+	app_settings_get(&settings);
+	sleep_ms = app_schedule_next_read_ms(SENSOR_RECORD_CHANNELS_SPS30) -
+		   sps30_warmup_ms(&settings) - k_uptime_get();
+
+	if (sleep_ms <= 0) {
+		/* Not worth stopping the fan for such a short interval */
+		return;
+	}
+
+	if (sps30_sensor_sleep() == 0) {
+		k_work_schedule(&sps30_wake_work, K_MSEC(sleep_ms));
+	}
+}
+
+/* Block until the sensor has been running for at least `warmup_ms` */
+static int sps30_wait_until_stable(int64_t warmup_ms)
+{
+	int err;
+	int64_t running_ms;
+
+	/* Wake now if the scheduled wake-up has not happened yet (e.g. loop woken early) */
+	k_work_cancel_delayable(&sps30_wake_work);
+
+	err = sps30_sensor_wake();
 	if (err) {
-		LOG_ERR("Error reading SPS30 firmware version (error: %d)", err);
-		k_mutex_unlock(&sps30_mutex);
 		return err;
-	} else {
-		LOG_DBG("SPS30 firmware version: %u.%u", fw_major, fw_minor);
 	}
 
-	err = sps30_get_serial(serial_number);
+	sps30_lock(K_FOREVER);
+	running_ms = k_uptime_get() - sps30_started_ms;
+	k_mutex_unlock(&sps30_mutex);
+
+	if (running_ms < warmup_ms) {
+		LOG_DBG("Waiting %lld ms for SPS30 measurements to stabilize",
+			warmup_ms - running_ms);
+		k_sleep(K_MSEC(warmup_ms - running_ms));
+	}
+
+	return 0;
+}
+
+uint32_t sps30_sensor_fan_on_s_per_hour(void)
+{
+	int64_t now = k_uptime_get();
+	int64_t fan_on_ms;
+
+	sps30_lock(K_FOREVER);
+	fan_on_ms = sps30_fan_on_ms + (sps30_running ? now - sps30_started_ms : 0);
+	k_mutex_unlock(&sps30_mutex);
+
+	if (now <= 0) {
+		return 0;
+	}
+
+	return (uint32_t)((fan_on_ms * SEC_PER_HOUR) / now);
+}
+
+int sps30_sensor_suspend(void)
+{
+	k_work_cancel_delayable(&sps30_wake_work);
+
+	return sps30_sensor_sleep();
+}
+
+int sps30_sensor_init(void)
+{
+	LOG_DBG("Initializing SPS30 PM sensor");
+
+	if (!device_is_ready(sps30_dev)) {
+		LOG_ERR("Device \"%s\" is not ready", sps30_dev->name);
+		return -ENODEV;
+	}
+
+	/* The driver resets the sensor, leaving it idle with the fan off. Start
+	 * measuring now so the first window does not wait for the full warm-up.
+	 */
+	return sps30_sensor_wake();
+}
+
+int sps30_sensor_reset(void)
+{
+	int err;
+
+	LOG_INF("Resetting SPS30 PM sensor");
+
+	k_work_cancel_delayable(&sps30_wake_work);
+
+	err = sps30_lock(K_MSEC(SPS30_MUTEX_TIMEOUT));
 	if (err) {
-		LOG_ERR("Error reading SPS30 serial number (error: %d)", err);
-		k_mutex_unlock(&sps30_mutex);
 		return err;
-	} else {
-		LOG_DBG("SPS30 serial number: %s", serial_number);
 	}
 
-	err = sps30_start_measurement();
+	err = sps30_attr_set(SENSOR_ATTR_SPS30_RESET, 1);
 	if (err) {
-		LOG_ERR("Error entering SPS30 measurement mode (error: %d)", err);
+		LOG_ERR("SPS30 sensor reset failed (error: %d)", err);
 		k_mutex_unlock(&sps30_mutex);
 		return err;
 	}
 
-	/* Sleep 30s for the measurements to stabilize */
-	sensirion_i2c_hal_sleep_usec(30000000);
+	/* A reset leaves the sensor idle with the fan off */
+	sps30_mark_running(false);
 
 	k_mutex_unlock(&sps30_mutex);
 
-	return err;
+	return sps30_sensor_wake();
+}
+
+/* Must be called with sps30_mutex held */
+static int64_t sps30_clean_remaining_ms(void)
+{
+	return MAX(sps30_clean_end_ms - k_uptime_get(), 0);
 }
 
-int sps30_sensor_read(struct sps30_sensor_measurement *measurement)
+/* Must be called with sps30_mutex held */
+static bool sps30_is_stable(int64_t warmup_ms)
 {
+	return sps30_running && ((k_uptime_get() - sps30_started_ms) >= warmup_ms);
+}
+
+int sps30_sensor_read_begin(bool fast)
+{
+	struct app_settings settings;
+	uint32_t samples;
 	int err;
-	struct sps30_measurement sps30_meas;
-	struct sps30_measurement sps30_meas_avg = {0};
 
 	/* Get the number of samples to average from Golioth settings */
-	uint32_t samples = get_sps30_samples_per_measurement_s();
+	app_settings_get(&settings);
+	samples = fast ? 1 : settings.sps30_samples_per_measurement;
 
-	LOG_DBG("Reading SPS30 PM sensor (averaging %u samples over ~%u seconds)", samples,
-		samples);
-
-	int count = 0;
-	while (count < samples) {
-		err = k_mutex_lock(&sps30_mutex, K_MSEC(SPS30_MUTEX_TIMEOUT));
+	if (!fast) {
+		err = sps30_wait_until_stable(sps30_warmup_ms(&settings));
 		if (err) {
-			LOG_ERR("Error locking SPS30 mutex (lock count: %u): %d",
-				sps30_mutex.lock_count, err);
 			return err;
 		}
+	}
 
-		/* Poll the sensor every 0.1s waiting for the data ready status */
-		/* Data should be ready every 1s */
-		int16_t data_ready_flag = 0;
-		int tries = 100;
-
-		while (tries > 0) {
-			err = sps30_read_data_ready(&data_ready_flag);
-			if (err) {
-				LOG_ERR("Error reading SPS30 data ready status flag: %d", err);
-				k_mutex_unlock(&sps30_mutex);
-				return err;
-			}
-
-			if (data_ready_flag)
-				break;
-
-			/* Sleep 0.1s and try again */
-			sensirion_i2c_hal_sleep_usec(100000);
-			tries--;
-		}
+	err = sps30_lock(K_MSEC(SPS30_READ_MUTEX_TIMEOUT));
+	if (err) {
+		return err;
+	}
 
-		if (tries == 0) {
-			LOG_ERR("SPS30 data ready flag was never asserted");
-			k_mutex_unlock(&sps30_mutex);
-			return -1;
-		}
+	if (fast &&
+	    ((sps30_clean_remaining_ms() > 0) || !sps30_is_stable(sps30_warmup_ms(&settings)))) {
+		k_mutex_unlock(&sps30_mutex);
+		return -EAGAIN;
+	}
+
+	/* Measurements are not updated while the fan is being cleaned */
+	for (int64_t clean_ms = sps30_clean_remaining_ms(); clean_ms > 0;
+	     clean_ms = sps30_clean_remaining_ms()) {
+		k_mutex_unlock(&sps30_mutex);
+		LOG_DBG("Waiting %lld ms for the SPS30 fan cleaning to finish", clean_ms);
+		k_sleep(K_MSEC(clean_ms));
 
-		err = sps30_read_measurement(&sps30_meas);
+		err = sps30_lock(K_MSEC(SPS30_READ_MUTEX_TIMEOUT));
 		if (err) {
-			LOG_ERR("Error reading SPS30 measurement: %d", err);
-			k_mutex_unlock(&sps30_mutex);
 			return err;
 		}
+	}
 
+	err = sps30_attr_set(SENSOR_ATTR_SPS30_SAMPLES, samples);
+	if (err) {
+		LOG_ERR("Error setting SPS30 samples per measurement (error: %d)", err);
 		k_mutex_unlock(&sps30_mutex);
+		return err;
+	}
 
-		sps30_meas_avg.mc_1p0 += sps30_meas.mc_1p0;
-		sps30_meas_avg.mc_2p5 += sps30_meas.mc_2p5;
-		sps30_meas_avg.mc_4p0 += sps30_meas.mc_4p0;
-		sps30_meas_avg.mc_10p0 += sps30_meas.mc_10p0;
-		sps30_meas_avg.nc_0p5 += sps30_meas.nc_0p5;
-		sps30_meas_avg.nc_1p0 += sps30_meas.nc_1p0;
-		sps30_meas_avg.nc_2p5 += sps30_meas.nc_2p5;
-		sps30_meas_avg.nc_4p0 += sps30_meas.nc_4p0;
-		sps30_meas_avg.nc_10p0 += sps30_meas.nc_10p0;
-		sps30_meas_avg.typical_particle_size += sps30_meas.typical_particle_size;
-
-		/* Wait for a new sample to be ready */
-		sensirion_i2c_hal_sleep_usec(SPS30_MEASUREMENT_DURATION_USEC);
-
-		count++;
-	}
-
-	sps30_meas_avg.mc_1p0 = sps30_meas_avg.mc_1p0 / samples;
-	sps30_meas_avg.mc_2p5 = sps30_meas_avg.mc_2p5 / samples;
-	sps30_meas_avg.mc_4p0 = sps30_meas_avg.mc_4p0 / samples;
-	sps30_meas_avg.mc_10p0 = sps30_meas_avg.mc_10p0 / samples;
-	sps30_meas_avg.nc_0p5 = sps30_meas_avg.nc_0p5 / samples;
-	sps30_meas_avg.nc_1p0 = sps30_meas_avg.nc_1p0 / samples;
-	sps30_meas_avg.nc_2p5 = sps30_meas_avg.nc_2p5 / samples;
-	sps30_meas_avg.nc_4p0 = sps30_meas_avg.nc_4p0 / samples;
-	sps30_meas_avg.nc_10p0 = sps30_meas_avg.nc_10p0 / samples;
-	sps30_meas_avg.typical_particle_size = sps30_meas_avg.typical_particle_size / samples;
-
-	sensor_value_from_double(&measurement->mc_1p0, sps30_meas_avg.mc_1p0);
-	sensor_value_from_double(&measurement->mc_2p5, sps30_meas_avg.mc_2p5);
-	sensor_value_from_double(&measurement->mc_4p0, sps30_meas_avg.mc_4p0);
-	sensor_value_from_double(&measurement->mc_10p0, sps30_meas_avg.mc_10p0);
-	sensor_value_from_double(&measurement->nc_0p5, sps30_meas_avg.nc_0p5);
-	sensor_value_from_double(&measurement->nc_1p0, sps30_meas_avg.nc_1p0);
-	sensor_value_from_double(&measurement->nc_2p5, sps30_meas_avg.nc_2p5);
-	sensor_value_from_double(&measurement->nc_4p0, sps30_meas_avg.nc_4p0);
-	sensor_value_from_double(&measurement->nc_10p0, sps30_meas_avg.nc_10p0);
-	sensor_value_from_double(&measurement->typical_particle_size,
-				 sps30_meas_avg.typical_particle_size);
+	LOG_DBG("Reading SPS30 PM sensor (averaging %u samples over ~%u seconds)", samples,
+		samples);
 
-	return err;
+	return 0;
+}
+
+uint32_t sps30_sensor_read_duration_ms(bool fast)
+{
+	struct app_settings settings;
+	uint32_t samples;
+	int64_t warmup_ms = 0;
+	int64_t clean_ms = SPS30_FAN_CLEAN_MS;
+
+	app_settings_get(&settings);
+	samples = fast ? 1 : settings.sps30_samples_per_measurement;
+
+	if (!fast) {
+		warmup_ms = sps30_warmup_ms(&settings);
+	}
+
+	/* Assume the full warm-up and a fan cleaning if the state cannot be checked */
+	if (sps30_lock(K_MSEC(SPS30_READ_MUTEX_TIMEOUT)) == 0) {
+		if (sps30_running) {
+			warmup_ms = MAX(warmup_ms - (k_uptime_get() - sps30_started_ms), 0);
+		}
+		clean_ms = sps30_clean_remaining_ms();
+		k_mutex_unlock(&sps30_mutex);
+	}
+
+	/* A new reading is available every second */
+	return (uint32_t)(MAX(warmup_ms, clean_ms)) + samples * MSEC_PER_SEC;
 }
 
-void sps30_log_measurements(struct sps30_sensor_measurement *measurement)
+void sps30_sensor_read_end(void)
 {
-	LOG_DBG("sps30: "
-		"PM1.0=%f μg/m³, PM2.5=%f μg/m³, "
-		"PM4.0=%f μg/m³, PM10.0=%f μg/m³, "
-		"NC0.5=%f #/cm³, NC1.0=%f #/cm³, "
-		"NC2.5=%f #/cm³, NC4.0=%f #/cm³, "
-		"NC10.0=%f #/cm³, Typical Particle Size=%f μm",
-		sensor_value_to_double(&measurement->mc_1p0),
-		sensor_value_to_double(&measurement->mc_2p5),
-		sensor_value_to_double(&measurement->mc_4p0),
-		sensor_value_to_double(&measurement->mc_10p0),
-		sensor_value_to_double(&measurement->nc_0p5),
-		sensor_value_to_double(&measurement->nc_1p0),
-		sensor_value_to_double(&measurement->nc_2p5),
-		sensor_value_to_double(&measurement->nc_4p0),
-		sensor_value_to_double(&measurement->nc_10p0),
-		sensor_value_to_double(&measurement->typical_particle_size));
+	k_mutex_unlock(&sps30_mutex);
+
+	if (IS_ENABLED(CONFIG_APP_SPS30_DUTY_CYCLE)) {
+		sps30_schedule_next_window();
+	}
+}
+
+/* The sensor does not accept commands other than wake-up while sleeping */
+static int sps30_command_wake(struct sps30_command_state *state)
+{
+	int err;
+
+	state->wake_pending = k_work_delayable_is_pending(&sps30_wake_work);
+
+	err = sps30_lock(K_MSEC(SPS30_MUTEX_TIMEOUT));
+	if (err) {
+		return err;
+	}
+
+	state->was_asleep = !sps30_running;
+	k_mutex_unlock(&sps30_mutex);
+
+	return state->was_asleep ? sps30_sensor_wake() : 0;
+}
+
+/* Put the sensor back to sleep, unless its next window started during the command */
+static void sps30_command_restore(const struct sps30_command_state *state)
+{
+	if (!state->was_asleep) {
+		return;
+	}
+
+	if (state->wake_pending && !k_work_delayable_is_pending(&sps30_wake_work)) {
+		return;
+	}
+
+	sps30_sensor_sleep();
 }
 
 int sps30_sensor_set_fan_auto_cleaning_interval(uint32_t interval_seconds)
 {
+	struct sps30_command_state state;
 	int err;
 
-	err = k_mutex_lock(&sps30_mutex, K_MSEC(SPS30_MUTEX_TIMEOUT));
+	err = sps30_command_wake(&state);
 	if (err) {
-		LOG_ERR("Error locking SPS30 mutex (lock count: %u): %d", sps30_mutex.lock_count,
-			err);
 		return err;
 	}
 
-	err = sps30_set_fan_auto_cleaning_interval(interval_seconds);
+	err = sps30_lock(K_MSEC(SPS30_MUTEX_TIMEOUT));
+	if (err) {
+		sps30_command_restore(&state);
+		return err;
+	}
+
+	err = sps30_attr_set(SENSOR_ATTR_SPS30_AUTO_CLEANING_INTERVAL, interval_seconds);
 	if (err) {
 		LOG_ERR("Error setting SPS30 automatic fan cleaning interval (error: %d)", err);
 	} else {
@@ -235,33 +422,45 @@ int sps30_sensor_set_fan_auto_cleaning_interval(uint32_t interval_seconds)
 
 	k_mutex_unlock(&sps30_mutex);
 
+	sps30_command_restore(&state);
+
 	return err;
 }
 
 int sps30_sensor_clean_fan(void)
 {
+	struct sps30_command_state state;
 	int err;
 
 	LOG_INF("Cleaning SPS30 PM sensor fan (~10 seconds)");
 
-	err = k_mutex_lock(&sps30_mutex, K_MSEC(SPS30_MUTEX_TIMEOUT));
+	/* Fan cleaning is only possible in measurement mode */
+	err = sps30_command_wake(&state);
 	if (err) {
-		LOG_ERR("Error locking SPS30 mutex (lock count: %u): %d", sps30_mutex.lock_count,
-			err);
 		return err;
 	}
 
-	err = sps30_start_manual_fan_cleaning();
+	err = sps30_lock(K_MSEC(SPS30_MUTEX_TIMEOUT));
 	if (err) {
-		LOG_ERR("Error starting SPS30 manual fan clearing: %d", err);
-		k_mutex_unlock(&sps30_mutex);
+		sps30_command_restore(&state);
 		return err;
 	}
 
-	/* Sleep 10s for the fan cleaning to finish */
-	sensirion_i2c_hal_sleep_usec(10000000);
+	err = sps30_attr_set(SENSOR_ATTR_SPS30_FAN_CLEAN, 1);
+	if (err) {
+		LOG_ERR("Error starting SPS30 manual fan clearing: %d", err);
+	} else {
+		sps30_clean_end_ms = k_uptime_get() + SPS30_FAN_CLEAN_MS;
+	}
 
 	k_mutex_unlock(&sps30_mutex);
 
+	if (!err) {
+		/* Reads wait for the cleaning to finish without holding the mutex */
+		k_sleep(K_MSEC(SPS30_FAN_CLEAN_MS));
+	}
+
+	sps30_command_restore(&state);
+
 	return err;
 }
@@ -20,12 +20,36 @@ struct sps30_sensor_measurement {
 	struct sensor_value nc_4p0;
 	struct sensor_value nc_10p0;
 	struct sensor_value typical_particle_size;
+	/* Uptime at the start and end of the averaging window */
+	int64_t window_start_ms;
+	int64_t window_end_ms;
 };
 
 int sps30_sensor_init(void);
-int sps30_sensor_read(struct sps30_sensor_measurement *measurement);
-void sps30_log_measurements(struct sps30_sensor_measurement *measurement);
+int sps30_sensor_reset(void);
+
+/**
+ * Prepare an averaging window: wait until the sensor has warmed up and apply
+ * the samples-per-measurement setting. On success, commands from settings and
+ * RPCs are held off until sps30_sensor_read_end().
+ *
+ * A fast read takes a single sample and does not wait. It returns -EAGAIN if
+ * the sensor is not running and warmed up, or its fan is being cleaned.
+ */
+int sps30_sensor_read_begin(bool fast);
+void sps30_sensor_read_end(void);
+
+/* Longest a read may take from sps30_sensor_read_begin(), including the remaining warm-up */
+uint32_t sps30_sensor_read_duration_ms(bool fast);
+
+/* Commands wake a sleeping sensor and put it back to sleep when done */
 int sps30_sensor_set_fan_auto_cleaning_interval(uint32_t interval_seconds);
 int sps30_sensor_clean_fan(void);
 
+/* Average fan-on time since boot, in seconds per hour */
+uint32_t sps30_sensor_fan_on_s_per_hour(void);
+
+/* Stop the fan and cancel any scheduled wake-up; the next read wakes the sensor again */
+int sps30_sensor_suspend(void);
+
 #endif
@@ -0,0 +1,371 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(stream_queue, LOG_LEVEL_DBG);
+
+#include <golioth/client.h>
+#include <golioth/stream.h>
+#include <zephyr/kernel.h>
+
+#include "app_trace.h"
+#include "stream_queue.h"
+
+#define RETRY_QUEUE_LEN CONFIG_APP_STREAM_RETRY_QUEUE_LEN
+
+/* Four buckets per power of two, up to about 35 minutes */
+#define ACK_HIST_SUB_BUCKETS 4
+#define ACK_HIST_BUCKETS     (ACK_HIST_SUB_BUCKETS * 20)
+
+static struct golioth_client *client;
+
+/* Payloads waiting to be resent, oldest sample first */
+static struct payload_buf *retry_queue[RETRY_QUEUE_LEN];
+static size_t retry_count;
+static uint32_t backoff_exp;
+static atomic_t paused;
+K_MUTEX_DEFINE(queue_mutex);
+
+static struct {
+	uint32_t sent;
+	uint32_t retries;
+	uint32_t dropped;
+	uint64_t latency_sum_ms;
+	uint32_t latency_max_ms;
+	uint64_t bytes_sent;
+	uint32_t queue_full;
+	uint32_t ack_hist[ACK_HIST_BUCKETS];
+} stats;
+
+static void retry_work_handler(struct k_work *work);
+K_WORK_DELAYABLE_DEFINE(retry_work, retry_work_handler);
+
+/* Values below 4 ms have a bucket each; above, the two bits after the MSB pick the bucket */
+static size_t ack_bucket(uint32_t ms)
+{
+	int msb;
+
+	if (ms < ACK_HIST_SUB_BUCKETS) {
+		return ms;
+	}
+
+	msb = find_msb_set(ms) - 1;
+
+	return MIN((msb - 1) * ACK_HIST_SUB_BUCKETS + ((ms >> (msb - 2)) & 0x3),
+		   ACK_HIST_BUCKETS - 1);
+}
+
+/* Largest latency counted in a bucket */
+static uint32_t ack_bucket_max_ms(size_t bucket)
+{
+	size_t msb = bucket / ACK_HIST_SUB_BUCKETS + 1;
+	size_t sub = bucket % ACK_HIST_SUB_BUCKETS;
+
+	if (bucket < ACK_HIST_SUB_BUCKETS) {
+		return bucket;
+	}
+
+	return ((ACK_HIST_SUB_BUCKETS + sub + 1) << (msb - 2)) - 1;
+}
+
+/* Must be called with queue_mutex held */
+static uint32_t ack_percentile_ms(uint32_t percent)
+{
+	uint64_t rank = DIV_ROUND_UP((uint64_t)stats.sent * percent, 100);
+	uint64_t count = 0;
+
+	if (stats.sent == 0) {
+		return 0;
+	}
+
+	for (size_t i = 0; i < ACK_HIST_BUCKETS; i++) {
+		count += stats.ack_hist[i];
+		if (count >= rank) {
+			return ack_bucket_max_ms(i);
+		}
+	}
+
+	return ack_bucket_max_ms(ACK_HIST_BUCKETS - 1);
+}
+
+static k_timeout_t backoff_delay(void)
+{
+	uint32_t delay_s = CONFIG_APP_STREAM_RETRY_BASE_S << MIN(backoff_exp, 16);
+
+	return K_SECONDS(MIN(delay_s, CONFIG_APP_STREAM_RETRY_MAX_S));
+}
+
+/* Must be called with queue_mutex held */
+static void drop_payload(struct payload_buf *buf)
+{
+	stats.dropped++;
+	LOG_WRN("Dropping stream payload sampled %lld ms ago after %u attempt(s)",
+		k_uptime_get() - buf->sample_ms, buf->attempts);
+	payload_pool_free(buf);
+}
+
+/* Must be called with queue_mutex held */
+static struct payload_buf *queue_remove(size_t i)
+{
+	struct payload_buf *buf = retry_queue[i];
+
+	retry_count--;
+	memmove(&retry_queue[i], &retry_queue[i + 1], (retry_count - i) * sizeof(retry_queue[0]));
+
+	return buf;
+}
+
+/* Index of the oldest payload that is not urgent, or retry_count if there is none.
+ * Must be called with queue_mutex held.
+ */
+static size_t queue_oldest_normal(void)
+{
+	size_t i = 0;
+
+	while ((i < retry_count) && retry_queue[i]->urgent) {
+		i++;
+	}
+
+	return i;
+}
+
+/* Must be called with queue_mutex held */
+static struct payload_buf *queue_pop_oldest(void)
+{
+	if (retry_count == 0) {
+		return NULL;
+	}
+
+	return queue_remove(0);
+}
+
+/* Urgent payloads go before all others; each group is ordered by sample time */
+static bool queue_before(const struct payload_buf *a, const struct payload_buf *b)
+{
+	if (a->urgent != b->urgent) {
+		return a->urgent;
+	}
+
+	return a->sample_ms < b->sample_ms;
+}
+
+/* Must be called with queue_mutex held */
+static void queue_insert(struct payload_buf *buf)
+{
+	size_t victim;
+	size_t i;
+
+	if (buf->attempts >= CONFIG_APP_STREAM_RETRY_MAX_ATTEMPTS) {
+		drop_payload(buf);
+		return;
+	}
+
+	if (retry_count == RETRY_QUEUE_LEN) {
+		/* Drop the oldest normal payload, or the oldest urgent one if all are urgent */
+		victim = queue_oldest_normal();
+		if (victim == retry_count) {
+			victim = 0;
+		}
+
+		if ((buf->urgent < retry_queue[victim]->urgent) ||
+		    ((buf->urgent == retry_queue[victim]->urgent) &&
+		     (buf->sample_ms < retry_queue[victim]->sample_ms))) {
+			/* This payload is the one to drop */
+			drop_payload(buf);
+			return;
+		}
+
+		drop_payload(queue_remove(victim));
+	}
+
+	for (i = retry_count; (i > 0) && queue_before(buf, retry_queue[i - 1]); i--) {
+		retry_queue[i] = retry_queue[i - 1];
+	}
+
+	retry_queue[i] = buf;
+	retry_count++;
+}
+
+static void queue_for_retry(struct payload_buf *buf)
+{
+	k_mutex_lock(&queue_mutex, K_FOREVER);
+	queue_insert(buf);
+	backoff_exp++;
+	k_mutex_unlock(&queue_mutex);
+
+	k_work_schedule(&retry_work, backoff_delay());
+}
+
+static void on_send_complete(struct golioth_client *client, enum golioth_status status,
+			     const struct golioth_coap_rsp_code *coap_rsp_code, const char *path,
+			     void *arg)
+{
+	struct payload_buf *buf = (struct payload_buf *)arg;
+	uint32_t latency_ms;
+	uint32_t ack_ms;
+	bool pending;
+
+	if (status != GOLIOTH_OK) {
+		LOG_WRN("Stream send to \"%s\" failed (attempt %u): %d", path, buf->attempts,
+			status);
+		queue_for_retry(buf);
+		return;
+	}
+
+	latency_ms = (uint32_t)(k_uptime_get() - buf->sample_ms);
+	ack_ms = (uint32_t)(k_uptime_get() - buf->enqueue_ms);
+
+	k_mutex_lock(&queue_mutex, K_FOREVER);
+	stats.sent++;
+	stats.latency_sum_ms += latency_ms;
+	stats.latency_max_ms = MAX(stats.latency_max_ms, latency_ms);
+	stats.bytes_sent += buf->len;
+	stats.ack_hist[ack_bucket(ack_ms)]++;
+	backoff_exp = 0;
+	pending = (retry_count > 0);
+	k_mutex_unlock(&queue_mutex);
+
+	if (buf->attempts > 1) {
+		LOG_INF("Stream payload delivered after %u attempts (%u ms)", buf->attempts,
+			latency_ms);
+	}
+
+	payload_pool_free(buf);
+
+	/* The link is working again, so drain the queue */
+	if (pending) {
+		k_work_reschedule(&retry_work, K_NO_WAIT);
+	}
+}
+
+static int send_payload(struct payload_buf *buf)
+{
+	int err;
+
+	if (!client || !golioth_client_is_connected(client)) {
+		return -ENOTCONN;
+	}
+
+	buf->attempts++;
+	/* Set before the request is queued, as it may complete before the call returns */
+	buf->enqueue_ms = k_uptime_get();
+
+	app_trace_begin("stream_set_async", buf->len);
+	err = golioth_stream_set_async(client,
+				       buf->path,
+				       buf->content_type,
+				       buf->data,
+				       buf->len,
+				       on_send_complete,
+				       buf);
+	app_trace_end("stream_set_async", err);
+
+	if (err == GOLIOTH_ERR_QUEUE_FULL) {
+		k_mutex_lock(&queue_mutex, K_FOREVER);
+		stats.queue_full++;
+		k_mutex_unlock(&queue_mutex);
+	}
+
+	return err;
+}
+
+static void retry_work_handler(struct k_work *work)
+{
+	struct payload_buf *buf;
+	int err;
+
+	k_mutex_lock(&queue_mutex, K_FOREVER);
+	/* Urgent payloads come first, and are the only ones sent while paused */
+	if (!atomic_get(&paused) || ((retry_count > 0) && retry_queue[0]->urgent)) {
+		buf = queue_pop_oldest();
+	} else {
+		buf = NULL;
+	}
+	if (buf) {
+		stats.retries++;
+	}
+	k_mutex_unlock(&queue_mutex);
+
+	if (!buf) {
+		return;
+	}
+
+	LOG_DBG("Retrying stream payload sampled %lld ms ago", k_uptime_get() - buf->sample_ms);
+
+	err = send_payload(buf);
+	if (err) {
+		queue_for_retry(buf);
+	}
+}
+
+void stream_queue_set_client(struct golioth_client *stream_client)
+{
+	client = stream_client;
+}
+
+void stream_queue_send(struct payload_buf *buf)
+{
+	int err;
+
+	if (atomic_get(&paused) && !buf->urgent) {
+		k_mutex_lock(&queue_mutex, K_FOREVER);
+		queue_insert(buf);
+		k_mutex_unlock(&queue_mutex);
+		return;
+	}
+
+	err = send_payload(buf);
+
+	if (err) {
+		LOG_WRN("Failed to enqueue stream payload (%d), queued for retry", err);
+		queue_for_retry(buf);
+	}
+}
+
+void stream_queue_pause(bool pause)
+{
+	atomic_set(&paused, pause);
+
+	if (!pause) {
+		k_work_reschedule(&retry_work, K_NO_WAIT);
+	}
+}
+
+struct payload_buf *stream_queue_reclaim_oldest(void)
+{
+	struct payload_buf *buf;
+	size_t i;
+
+	k_mutex_lock(&queue_mutex, K_FOREVER);
+	i = queue_oldest_normal();
+	buf = (i < retry_count) ? queue_remove(i) : NULL;
+	if (buf) {
+		stats.dropped++;
+		LOG_WRN("Reclaiming queued stream payload sampled %lld ms ago",
+			k_uptime_get() - buf->sample_ms);
+		payload_buf_reset(buf);
+	}
+	k_mutex_unlock(&queue_mutex);
+
+	return buf;
+}
+
+void stream_queue_stats_get(struct stream_queue_stats *out)
+{
+	k_mutex_lock(&queue_mutex, K_FOREVER);
+	out->queued = retry_count;
+	out->sent = stats.sent;
+	out->retries = stats.retries;
+	out->dropped = stats.dropped;
+	out->latency_avg_ms = stats.sent ? (uint32_t)(stats.latency_sum_ms / stats.sent) : 0;
+	out->latency_max_ms = stats.latency_max_ms;
+	out->bytes_sent = stats.bytes_sent;
+	out->queue_full = stats.queue_full;
+	out->ack_p50_ms = ack_percentile_ms(50);
+	out->ack_p90_ms = ack_percentile_ms(90);
+	out->ack_p99_ms = ack_percentile_ms(99);
+	k_mutex_unlock(&queue_mutex);
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Send payloads to LightDB Stream and keep the ones that fail in a small,
+ * bounded RAM queue ordered by sample time.
+ *
+ * Failed payloads (enqueue errors and negative responses such as CoAP
+ * timeouts) are retried oldest first with exponential backoff. When the queue
+ * is full, the oldest payload is dropped to make room for the newest one.
+ * Urgent payloads (alerts) are retried first and only dropped when the queue
+ * holds nothing else. While the queue is paused, other payloads are kept in
+ * the queue and only urgent ones are sent and retried.
+ *
+ * The time from handing a payload to the Golioth client to its acknowledgment
+ * is kept in a histogram with four buckets per power of two, so percentiles
+ * are reported to within about 20%.
+ */
+
+#ifndef __STREAM_QUEUE_H__
+#define __STREAM_QUEUE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <golioth/client.h>
+
+#include "payload_pool.h"
+
+struct stream_queue_stats {
+	uint32_t queued;
+	uint32_t sent;
+	uint32_t retries;
+	uint32_t dropped;
+	/* End-to-end latency from acquisition to acknowledgment */
+	uint32_t latency_avg_ms;
+	uint32_t latency_max_ms;
+	/* Payload bytes acknowledged */
+	uint64_t bytes_sent;
+	/* Sends refused because the Golioth request queue was full */
+	uint32_t queue_full;
+	/* Latency from enqueue to acknowledgment, upper bound of the percentile's bucket */
+	uint32_t ack_p50_ms;
+	uint32_t ack_p90_ms;
+	uint32_t ack_p99_ms;
+};
+
+void stream_queue_set_client(struct golioth_client *stream_client);
+void stream_queue_send(struct payload_buf *buf);
+void stream_queue_pause(bool pause);
+struct payload_buf *stream_queue_reclaim_oldest(void);
+void stream_queue_stats_get(struct stream_queue_stats *stats);
+
+#endif /* __STREAM_QUEUE_H__ */
@@ -0,0 +1,58 @@
+# Copyright (c) 2025 Golioth, Inc.
+# SPDX-License-Identifier: Apache-2.0
+
+"""Decode the batches printed by the firmware encoder with decode_batch.py."""
+
+import json
+import re
+import sys
+from pathlib import Path
+
+import pytest
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[3] / "scripts"))
+
+import decode_batch  # noqa: E402
+
+LINE = re.compile(r"^(\w+) (batch|record): (.*)$")
+
+
+def _printed(dut):
+    lines = dut.readlines_until(regex="PROJECT EXECUTION SUCCESSFUL", timeout=30)
+    batches = {}
+    records = {}
+
+    for line in lines:
+        match = LINE.match(line.strip())
+        if not match:
+            continue
+        name, kind, value = match.groups()
+        if kind == "batch":
+            batches[name] = bytes.fromhex(value)
+        else:
+            records.setdefault(name, []).append(json.loads(value))
+
+    return batches, records
+
+
+def test_round_trip(dut):
+    batches, printed = _printed(dut)
+
+    assert set(batches) == {"synced", "unsynced"}
+
+    for name, payload in batches.items():
+        decoded = decode_batch.decode(payload)
+        expected = printed[name]
+
+        assert len(decoded) == len(expected)
+
+        for got, want in zip(decoded, expected):
+            if "time" in want:
+                want["time"] = decode_batch._rfc3339(want["time"])
+
+            assert got.keys() == want.keys()
+            for key, value in want.items():
+                if isinstance(value, str):
+                    assert got[key] == value, f"{name} {key}"
+                else:
+                    assert got[key] == pytest.approx(value), f"{name} {key}"
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Encode batches with the firmware encoder and print them next to the records
+ * they hold. pytest/test_round_trip.py decodes each batch with
+ * scripts/decode_batch.py and compares the result with the printed records.
+ */
+
+#include <errno.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/ztest.h>
+
+#include "app_time.h"
+#include "batch_encoder.h"
+#include "sensor_record.h"
+
+/* 2025-01-01T00:00:00Z */
+#define TEST_UNIX_OFFSET_MS 1735689600000LL
+
+#define TEST_RECORD_COUNT BATCH_ENCODER_MAX_RECORDS
+
+/* Larger than a payload buffer, as the test deltas are larger than real ones */
+#define TEST_BATCH_LEN 2048
+
+/* Times and all channels of one record */
+#define TEST_JSON_LEN 512
+
+/* The last channel is never read, and every other channel is missing from some records */
+#define TEST_CHANNELS	     (SENSOR_RECORD_CHANNELS_ALL & ~BIT(SENSOR_CH_COUNT - 1))
+#define TEST_CHANNELS_SPARSE (TEST_CHANNELS & 0x55555555)
+
+static bool time_synced;
+
+static struct sensor_record records[TEST_RECORD_COUNT];
+static uint8_t batch[TEST_BATCH_LEN];
+static char json[TEST_JSON_LEN];
+
+/* Stands in for app_time.c, which needs network time */
+int app_time_uptime_to_unix_ms(int64_t uptime_ms, int64_t *unix_ms)
+{
+	if (!time_synced) {
+		return -ENODATA;
+	}
+
+	*unix_ms = uptime_ms + TEST_UNIX_OFFSET_MS;
+
+	return 0;
+}
+
+/* Values of both signs, deltas of every size, the full int32 range and channels not read */
+static void records_fill(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(records); i++) {
+		struct sensor_record *record = &records[i];
+
+		record->sample_ms = 60000 * i + 7 * i * i;
+		record->win_start_ms = record->sample_ms - 10000;
+		record->win_end_ms = record->sample_ms - i;
+
+		for (size_t ch = 0; ch < SENSOR_CH_COUNT; ch++) {
+			int32_t base = (int32_t)(ch + 1) * ((ch % 2) ? 1000 : -1000);
+			int32_t step = (int32_t)(i << ch);
+
+			record->values[ch] = (i % 2) ? base - step : base + step;
+		}
+
+		record->channels = (i % 4 == 1) ? TEST_CHANNELS_SPARSE : TEST_CHANNELS;
+	}
+
+	records[ARRAY_SIZE(records) - 2].values[0] = INT32_MAX;
+	records[ARRAY_SIZE(records) - 1].values[0] = INT32_MIN;
+}
+
+/* Print "<name> batch: <hex>" followed by "<name> record: <json>" for each record */
+static void batch_print(const char *name, size_t len)
+{
+	char prefix[80];
+
+	printk("%s batch: ", name);
+	for (size_t i = 0; i < len; i++) {
+		printk("%02x", batch[i]);
+	}
+	printk("\n");
+
+	for (size_t i = 0; i < ARRAY_SIZE(records); i++) {
+		const struct sensor_record *record = &records[i];
+
+		prefix[0] = '\0';
+		if (time_synced) {
+			snprintk(prefix, sizeof(prefix),
+				 "\"time\":%lld,\"win_start\":%lld,\"win_end\":%lld,",
+				 record->sample_ms + TEST_UNIX_OFFSET_MS,
+				 record->win_start_ms + TEST_UNIX_OFFSET_MS,
+				 record->win_end_ms + TEST_UNIX_OFFSET_MS);
+		}
+
+		zassert_ok(sensor_record_json_encode(record, prefix, record->channels, json,
+						     sizeof(json)));
+		printk("%s record: %s\n", name, json);
+	}
+}
+
+static void *batch_encoder_setup(void)
+{
+	records_fill();
+
+	return NULL;
+}
+
+ZTEST(batch_encoder, test_synced)
+{
+	size_t len;
+
+	time_synced = true;
+
+	zassert_ok(batch_encoder_encode(records, ARRAY_SIZE(records), batch, sizeof(batch), &len));
+	batch_print("synced", len);
+}
+
+ZTEST(batch_encoder, test_unsynced)
+{
+	size_t len;
+
+	time_synced = false;
+
+	zassert_ok(batch_encoder_encode(records, ARRAY_SIZE(records), batch, sizeof(batch), &len));
+	batch_print("unsynced", len);
+}
+
+ZTEST(batch_encoder, test_limits)
+{
+	size_t len;
+
+	time_synced = true;
+
+	zassert_equal(batch_encoder_encode(records, 0, batch, sizeof(batch), &len), -EINVAL);
+	zassert_equal(batch_encoder_encode(records, BATCH_ENCODER_MAX_RECORDS + 1, batch,
+					   sizeof(batch), &len),
+		      -EINVAL);
+	zassert_equal(batch_encoder_encode(records, ARRAY_SIZE(records), batch, 16, &len),
+		      -ENOMEM);
+}
+
+ZTEST_SUITE(batch_encoder, NULL, batch_encoder_setup, NULL, NULL, NULL);
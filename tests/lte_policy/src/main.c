@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Check the 3GPP encodings of the PSM timers and eDRX cycles, and the timers
+ * requested for upload intervals, against mock modem operations that record
+ * what the policy passes to the modem. The expected values assume the Kconfig
+ * defaults set in prj.conf.
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#include "lte_policy.h"
+
+/* What the policy passed to the modem since the last mock_reset() */
+struct mock_modem {
+	uint32_t calls;
+	uint32_t psm_sets;
+	char tau[LTE_POLICY_TIMER_STR_LEN];
+	char active_time[LTE_POLICY_TIMER_STR_LEN];
+	/* 1 or 0 for the last enable or disable, -1 if not called */
+	int psm_enabled;
+	uint32_t edrx_sets;
+	char edrx[2][LTE_POLICY_EDRX_STR_LEN];
+	int edrx_enabled;
+	/* Returned by the next psm_enable() call */
+	int psm_enable_err;
+};
+
+static struct mock_modem modem;
+
+static void mock_reset(void)
+{
+	memset(&modem, 0, sizeof(modem));
+	modem.psm_enabled = -1;
+	modem.edrx_enabled = -1;
+}
+
+static int mock_psm_set(const char *tau, const char *active_time)
+{
+	modem.calls++;
+	modem.psm_sets++;
+	strcpy(modem.tau, tau);
+	strcpy(modem.active_time, active_time);
+
+	return 0;
+}
+
+static int mock_psm_enable(bool enable)
+{
+	int err = modem.psm_enable_err;
+
+	modem.calls++;
+	modem.psm_enable_err = 0;
+	if (!err) {
+		modem.psm_enabled = enable;
+	}
+
+	return err;
+}
+
+static int mock_edrx_set(enum lte_policy_rat rat, const char *edrx)
+{
+	modem.calls++;
+	modem.edrx_sets++;
+	strcpy(modem.edrx[rat], edrx);
+
+	return 0;
+}
+
+static int mock_edrx_enable(bool enable)
+{
+	modem.calls++;
+	modem.edrx_enabled = enable;
+
+	return 0;
+}
+
+static const struct lte_policy_ops mock_ops = {
+	.psm_set = mock_psm_set,
+	.psm_enable = mock_psm_enable,
+	.edrx_set = mock_edrx_set,
+	.edrx_enable = mock_edrx_enable,
+};
+
+struct timer_case {
+	uint32_t seconds;
+	const char *bits;
+	uint32_t encoded;
+};
+
+struct edrx_case {
+	enum lte_policy_rat rat;
+	uint32_t ms;
+	const char *bits;
+	uint32_t encoded;
+};
+
+static void lte_policy_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	mock_reset();
+	lte_policy_init(&mock_ops);
+}
+
+ZTEST(lte_policy, test_tau)
+{
+	static const struct timer_case cases[] = {
+		/* 2 s units, exact and rounded up */
+		{60, "01111110", 60},
+		{61, "01111111", 62},
+		/* 30 s units once 2 s units overflow */
+		{63, "10000011", 90},
+		{450, "10001111", 450},
+		/* 10 minute units */
+		{5400, "00001001", 5400},
+		/* Longer than the longest timer */
+		{40000000, "11011111", 35712000},
+	};
+	char buf[LTE_POLICY_TIMER_STR_LEN];
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		zassert_equal(lte_policy_encode_tau(cases[i].seconds, buf), cases[i].encoded,
+			      "TAU of %u s", cases[i].seconds);
+		zassert_str_equal(buf, cases[i].bits, "TAU of %u s encoded as %s",
+				  cases[i].seconds, buf);
+	}
+}
+
+ZTEST(lte_policy, test_active_time)
+{
+	static const struct timer_case cases[] = {
+		{20, "00001010", 20},
+		{62, "00011111", 62},
+		/* Minute units once 2 s units overflow */
+		{75, "00100010", 120},
+		/* Longer than the longest timer */
+		{20000, "01011111", 11160},
+	};
+	char buf[LTE_POLICY_TIMER_STR_LEN];
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		zassert_equal(lte_policy_encode_active_time(cases[i].seconds, buf),
+			      cases[i].encoded, "Active time of %u s", cases[i].seconds);
+		zassert_str_equal(buf, cases[i].bits, "Active time of %u s encoded as %s",
+				  cases[i].seconds, buf);
+	}
+}
+
+ZTEST(lte_policy, test_edrx)
+{
+	static const struct edrx_case cases[] = {
+		/* Below the shortest cycle */
+		{LTE_POLICY_RAT_LTEM, 1000, "0000", 5120},
+		{LTE_POLICY_RAT_LTEM, 5120, "0000", 5120},
+		{LTE_POLICY_RAT_LTEM, 82000, "0101", 81920},
+		{LTE_POLICY_RAT_LTEM, 150000, "1000", 143360},
+		/* Above the longest cycle */
+		{LTE_POLICY_RAT_LTEM, 20000000, "1111", 10485760},
+		/* NB-IoT skips the values it does not accept */
+		{LTE_POLICY_RAT_NBIOT, 1000, "0010", 20480},
+		{LTE_POLICY_RAT_NBIOT, 61440, "0011", 40960},
+		{LTE_POLICY_RAT_NBIOT, 82000, "0101", 81920},
+		{LTE_POLICY_RAT_NBIOT, 150000, "0101", 81920},
+		{LTE_POLICY_RAT_NBIOT, 20000000, "1111", 10485760},
+	};
+	char buf[LTE_POLICY_EDRX_STR_LEN];
+
+	for (size_t i = 0; i < ARRAY_SIZE(cases); i++) {
+		zassert_equal(lte_policy_encode_edrx(cases[i].rat, cases[i].ms, buf),
+			      cases[i].encoded, "eDRX of %u ms for RAT %d", cases[i].ms,
+			      cases[i].rat);
+		zassert_str_equal(buf, cases[i].bits, "eDRX of %u ms for RAT %d encoded as %s",
+				  cases[i].ms, cases[i].rat, buf);
+	}
+}
+
+ZTEST(lte_policy, test_psm_interval)
+{
+	/* TAU at one and a half intervals, active time capped by Kconfig */
+	lte_policy_update(3600);
+	zassert_equal(modem.psm_sets, 1);
+	zassert_str_equal(modem.tau, "00001001");
+	zassert_str_equal(modem.active_time, "00001010");
+	zassert_equal(modem.psm_enabled, 1);
+	zassert_equal(modem.edrx_sets, 0);
+	zassert_equal(modem.edrx_enabled, 0);
+
+	/* The shortest interval using PSM */
+	lte_policy_update(300);
+	zassert_equal(modem.psm_sets, 2);
+	zassert_str_equal(modem.tau, "10001111");
+	zassert_str_equal(modem.active_time, "00001010");
+}
+
+ZTEST(lte_policy, test_edrx_interval)
+{
+	/* Half the interval */
+	lte_policy_update(40);
+	zassert_equal(modem.psm_sets, 0);
+	zassert_equal(modem.psm_enabled, 0);
+	zassert_equal(modem.edrx_sets, 2);
+	zassert_str_equal(modem.edrx[LTE_POLICY_RAT_LTEM], "0001");
+	zassert_str_equal(modem.edrx[LTE_POLICY_RAT_NBIOT], "0010");
+	zassert_equal(modem.edrx_enabled, 1);
+
+	/* Capped by Kconfig */
+	lte_policy_update(299);
+	zassert_equal(modem.edrx_sets, 4);
+	zassert_str_equal(modem.edrx[LTE_POLICY_RAT_LTEM], "0101");
+	zassert_str_equal(modem.edrx[LTE_POLICY_RAT_NBIOT], "0101");
+}
+
+ZTEST(lte_policy, test_short_interval)
+{
+	/* Half the interval is shorter than the shortest eDRX cycle */
+	lte_policy_update(10);
+	zassert_equal(modem.psm_sets, 0);
+	zassert_equal(modem.edrx_sets, 0);
+	zassert_equal(modem.psm_enabled, 0);
+	zassert_equal(modem.edrx_enabled, 0);
+}
+
+ZTEST(lte_policy, test_changes_only)
+{
+	lte_policy_update(3600);
+	zassert_true(modem.calls > 0);
+
+	/* Same timers, from the same interval and from another one */
+	mock_reset();
+	lte_policy_update(3600);
+	lte_policy_update(3599);
+	zassert_equal(modem.calls, 0, "%u call(s) for unchanged timers", modem.calls);
+
+	mock_reset();
+	lte_policy_update(60);
+	zassert_equal(modem.psm_enabled, 0);
+	zassert_equal(modem.edrx_enabled, 1);
+}
+
+ZTEST(lte_policy, test_retry)
+{
+	modem.psm_enable_err = -EIO;
+	lte_policy_update(3600);
+	zassert_equal(modem.psm_enabled, -1);
+	zassert_equal(modem.edrx_enabled, -1, "eDRX changed after a failure");
+
+	/* Retried with the same interval */
+	lte_policy_update(3600);
+	zassert_equal(modem.psm_sets, 2);
+	zassert_equal(modem.psm_enabled, 1);
+	zassert_equal(modem.edrx_enabled, 0);
+
+	mock_reset();
+	lte_policy_update(3600);
+	zassert_equal(modem.calls, 0, "%u call(s) after a successful retry", modem.calls);
+}
+
+ZTEST_SUITE(lte_policy, NULL, NULL, lte_policy_before, NULL, NULL);
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2025 Golioth, Inc.
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Replay traces/faults.csv through the sensor emulators and the acquisition
+ * path of the application, reading every sensor once a minute, and check how
+ * soon each injected fault is detected, how soon the sensor reads again once
+ * the fault is cleared, and how many readings are lost on the way.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "app_schedule.h"
+#include "app_settings.h"
+#include "sensor_async.h"
+#include "sensor_record.h"
+#include "sensor_recovery.h"
+
+#define CYCLE_MS 60000
+
+/* Reads fall half-way between the fault lines of the trace, which are on whole minutes */
+#define CYCLE_OFFSET_MS 30000
+
+/* Past the end of the last fault and the reads that recover from it */
+#define CYCLE_COUNT 35
+
+/* A hard fault is caught by the first read during the fault */
+#define DETECT_MAX_MS CYCLE_MS
+
+/* At most one read is lost after a fault is cleared */
+#define RECOVER_MAX_MS (CYCLE_OFFSET_MS + CYCLE_MS)
+
+struct fault {
+	const char *name;
+	uint32_t channels;
+	/* Trace times of the fault line and of the line clearing it */
+	int64_t start_ms;
+	int64_t end_ms;
+	/* Every read fails while the fault lasts, rather than some or none */
+	bool hard;
+};
+
+/* The faults of traces/faults.csv */
+static const struct fault faults[] = {
+	{"SCD4x NACKs", SENSOR_RECORD_CHANNELS_SCD4X, 300000, 600000, false},
+	{"SCD4x CRC errors", SENSOR_RECORD_CHANNELS_SCD4X, 720000, 840000, true},
+	{"SPS30 stuck data ready", SENSOR_RECORD_CHANNELS_SPS30, 960000, 1080000, true},
+	{"SCD4x clock stretching", SENSOR_RECORD_CHANNELS_SCD4X, 1200000, 1380000, false},
+	{"SPS30 bus lockup", SENSOR_RECORD_CHANNELS_SPS30, 1500000, 1620000, true},
+	{"SCD4x bus lockup", SENSOR_RECORD_CHANNELS_SCD4X, 1800000, 1860000, true},
+};
+
+static const uint32_t sensors[] = {
+	SENSOR_RECORD_CHANNELS_BME280,
+	SENSOR_RECORD_CHANNELS_SCD4X,
+	SENSOR_RECORD_CHANNELS_SPS30,
+};
+
+struct cycle {
+	/* Start of the read in trace time */
+	int64_t t_ms;
+	/* Channels of the sensors that were read */
+	uint32_t channels;
+};
+
+struct fault_result {
+	/* From the start of the fault to the first lost reading, or -1 */
+	int64_t detect_ms;
+	/* From the end of the fault to the next good reading, or -1 */
+	int64_t recover_ms;
+	uint32_t lost;
+	/* Reads taken while the fault lasted */
+	uint32_t reads;
+};
+
+static struct cycle cycles[CYCLE_COUNT];
+
+/* Stand in for the settings and the sampling schedule, which need the Golioth client */
+void app_settings_get(struct app_settings *settings)
+{
+	*settings = (struct app_settings){
+		.sps30_samples_per_measurement = 10,
+		.sps30_warmup_s = 0,
+	};
+}
+
+int64_t app_schedule_next_read_ms(uint32_t channels)
+{
+	ARG_UNUSED(channels);
+
+	return k_uptime_get() + CYCLE_MS;
+}
+
+static bool lost(const struct cycle *cycle, uint32_t channels)
+{
+	return (cycle->channels & channels) != channels;
+}
+
+static void fault_measure(const struct fault *fault, struct fault_result *res)
+{
+	*res = (struct fault_result){.detect_ms = -1, .recover_ms = -1};
+
+	for (size_t i = 0; i < ARRAY_SIZE(cycles); i++) {
+		const struct cycle *cycle = &cycles[i];
+
+		if (cycle->t_ms < fault->start_ms) {
+			continue;
+		}
+
+		if (cycle->t_ms < fault->end_ms) {
+			res->reads++;
+		}
+
+		if (!lost(cycle, fault->channels)) {
+			if (cycle->t_ms >= fault->end_ms) {
+				res->recover_ms = cycle->t_ms - fault->end_ms;
+				break;
+			}
+			continue;
+		}
+
+		if (res->detect_ms < 0) {
+			res->detect_ms = cycle->t_ms - fault->start_ms;
+		}
+		res->lost++;
+	}
+
+	TC_PRINT("%s: detected after %lld ms, recovered %lld ms after clearing, "
+		 "%u of %u reading(s) lost\n",
+		 fault->name, res->detect_ms, res->recover_ms, res->lost, res->reads);
+}
+
+/* Whether a lost reading of a sensor is explained by one of its faults */
+static bool fault_explains(const struct cycle *cycle, uint32_t channels)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(faults); i++) {
+		const struct fault *fault = &faults[i];
+
+		if ((fault->channels == channels) && (cycle->t_ms >= fault->start_ms) &&
+		    (cycle->t_ms < fault->end_ms + RECOVER_MAX_MS)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void *sensor_faults_setup(void)
+{
+	struct sensor_readings readings;
+	int64_t start_ms = k_uptime_get();
+
+	/* The trace starts with the first read of any sensor, which is the SCD4x one here */
+	zassert_ok(scd4x_sensor_init());
+	zassert_ok(sps30_sensor_init());
+	sensor_async_init();
+
+	for (size_t i = 0; i < ARRAY_SIZE(cycles); i++) {
+		struct cycle *cycle = &cycles[i];
+
+		k_sleep(K_TIMEOUT_ABS_MS(start_ms + i * CYCLE_MS + CYCLE_OFFSET_MS));
+
+		cycle->t_ms = k_uptime_get() - start_ms;
+		cycle->channels = SENSOR_RECORD_CHANNELS_ALL;
+		sensor_async_read(&readings, false, &cycle->channels);
+	}
+
+	return NULL;
+}
+
+ZTEST(sensor_faults, test_detection)
+{
+	struct fault_result res;
+
+	for (size_t i = 0; i < ARRAY_SIZE(faults); i++) {
+		if (!faults[i].hard) {
+			continue;
+		}
+
+		fault_measure(&faults[i], &res);
+		zassert_true(res.detect_ms >= 0, "%s not detected", faults[i].name);
+		zassert_true(res.detect_ms <= DETECT_MAX_MS, "%s detected after %lld ms",
+			     faults[i].name, res.detect_ms);
+	}
+}
+
+ZTEST(sensor_faults, test_recovery)
+{
+	struct fault_result res;
+
+	for (size_t i = 0; i < ARRAY_SIZE(faults); i++) {
+		fault_measure(&faults[i], &res);
+		zassert_true(res.recover_ms >= 0, "%s never recovered", faults[i].name);
+		zassert_true(res.recover_ms <= RECOVER_MAX_MS, "%s recovered after %lld ms",
+			     faults[i].name, res.recover_ms);
+	}
+}
+
+ZTEST(sensor_faults, test_lost)
+{
+	struct sensor_recovery_stats stats;
+	struct fault_result res;
+	uint32_t total = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(faults); i++) {
+		fault_measure(&faults[i], &res);
+		zassert_true(res.lost <= res.reads + 1, "%s lost %u of %u reading(s)",
+			     faults[i].name, res.lost, res.reads);
+		if (faults[i].hard) {
+			zassert_true(res.lost >= res.reads, "%s lost only %u of %u reading(s)",
+				     faults[i].name, res.lost, res.reads);
+		}
+		total += res.lost;
+	}
+
+	/* Every outage ended with a good reading and was counted */
+	sensor_recovery_stats_get(&stats);
+	zassert_equal(stats.lost, total, "%u reading(s) lost in outages, %u in faults", stats.lost,
+		      total);
+}
+
+ZTEST(sensor_faults, test_unaffected)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(cycles); i++) {
+		for (size_t s = 0; s < ARRAY_SIZE(sensors); s++) {
+			zassert_true(!lost(&cycles[i], sensors[s]) ||
+					     fault_explains(&cycles[i], sensors[s]),
+				     "Reading of channels 0x%x lost at %lld ms outside any fault",
+				     sensors[s], cycles[i].t_ms);
+		}
+	}
+}
+
+ZTEST(sensor_faults, test_escalation)
+{
+	struct sensor_recovery_stats stats;
+	uint32_t hard = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(faults); i++) {
+		hard += faults[i].hard ? 1 : 0;
+	}
+
+	sensor_recovery_stats_get(&stats);
+
+	/* No fault lasts long enough to reach the reboot stage */
+	zassert_equal(stats.failed, 0, "%u sensor(s) given up on", stats.failed);
+	zassert_equal(stats.watchdog, 0, "Acquisition hung %u time(s)", stats.watchdog);
+	zassert_true(stats.outages >= hard, "%u outage(s) for %u hard fault(s)", stats.outages,
+		     hard);
+}
+
+ZTEST_SUITE(sensor_faults, NULL, sensor_faults_setup, NULL, NULL, NULL);